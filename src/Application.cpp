@@ -6,6 +6,8 @@
 
 #include "SharedConfig.hpp"
 #include "ObjLoader.hpp"
+#include "Benchmark.hpp"
+#include "Render/TextureManager.hpp"
 
 #include "ImGuiFileDialog.h"
 
@@ -61,7 +63,7 @@ namespace aries {
     void Application::OnUpdate(SharedConfig& config) {
         const float deltaTime = 1.0f / config.io.Framerate;
 
-        static bool show_loader_window, show_config_window, show_scene_window;
+        static bool show_loader_window, show_config_window, show_scene_window, show_benchmark_window, show_texture_window;
         {
             static float f = 0.0f;
             static int counter = 0;
@@ -72,6 +74,8 @@ namespace aries {
             ImGui::Checkbox("Config Window", &show_config_window);
             ImGui::Checkbox("Scene Manager", &show_scene_window); // 新增场景管理窗口
             ImGui::Checkbox("Model Loader", &show_loader_window);
+            ImGui::Checkbox("Benchmark", &show_benchmark_window);
+            ImGui::Checkbox("Texture Manager", &show_texture_window);
 
             ImGui::Text("windows width: %d, height: %d", config.width, config.height);
             ImGui::Text("framebuffer width: %d, height: %d", config.framebuffer_width, config.framebuffer_height);
@@ -85,15 +89,78 @@ namespace aries {
             ImGui::Text("counter = %d", counter);
 
             ImGui::Checkbox("显示坐标系", &pipeline->showCoordinateSystem);
+            ImGui::SameLine();
+            ImGui::Checkbox("显示包围盒", &pipeline->showBounds);
+
+            const char* maskModeNames[] = {"Off", "Full", "Half + Bilateral"};
+            int maskModeIndex = static_cast<int>(pipeline->shadowMaskMode);
+            if (ImGui::Combo("屏幕空间阴影遮罩", &maskModeIndex, maskModeNames, IM_ARRAYSIZE(maskModeNames))) {
+                pipeline->shadowMaskMode = static_cast<aries::shadow::ShadowMaskMode>(maskModeIndex);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("先做预深度，再对每个可见像素计算一次阴影，片元着色器直接读取结果\n阴影开销不再随重复绘制和 PCF 核大小增长");
+            }
 
             if (scene->directionalShadow && ImGui::Button("[DEBUG] 保存深度图")) {
                 scene->directionalShadow->SaveShadowMap("shadow_map.png");
                 std::cout << "[DEBUG] 深度图已保存为 shadow_map.png" << std::endl;
             }
 
-            ImGui::Text("三角形数量: %lld", pipeline->triangleCount);
+            ImGui::Checkbox("视锥剔除", &pipeline->enableFrustumCulling);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("按形状包围体剔除视野外的形状，完全在视野内的形状跳过逐三角形的裁剪检查");
+            }
+            ImGui::Text("三角形数量: %lld，剔除形状: %d，完全可见形状: %d", pipeline->triangleCount, pipeline->culledShapeCount, pipeline->insideShapeCount);
+            const auto& bvhStats = pipeline->shapeBVH.GetStats();
+            ImGui::Text("BVH: %d 个形状，树高 %d，本帧访问 %d 个节点，重算 %d / 重插 %d", bvhStats.leafCount, bvhStats.height,
+                pipeline->bvhVisitedNodes, bvhStats.refitLeaves, bvhStats.reinsertLeaves);
+            const auto& storeStats = pipeline->shapeStore.GetStats();
+            ImGui::Text("形状存储: %d 行，本帧更新 %d 行，移除 %d 行", storeStats.rows, storeStats.updatedRows, storeStats.removedRows);
+            ImGui::Checkbox("遮挡剔除", &pipeline->enableOcclusionCulling);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("把屏幕上较大的形状（或指定的遮挡物）光栅化进低分辨率深度缓冲，\n被它们完全挡住的形状不进入顶点阶段");
+            }
+            if (pipeline->enableOcclusionCulling) {
+                ImGui::SameLine();
+                ImGui::Checkbox("重投影上一帧深度", &pipeline->occlusionSettings.reproject);
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("把上一帧已绘制的深度也当作遮挡物，室内场景剔除更多；\n物体移开后被挡住的形状会晚一帧出现");
+                }
+                ImGui::SliderFloat("遮挡物最小屏幕占比", &pipeline->occlusionSettings.minOccluderArea, 0.0f, 0.5f, "%.2f");
+                ImGui::InputInt("遮挡物数量上限", &pipeline->occlusionSettings.maxOccluders);
+                const auto& occlusionStats = pipeline->occlusionStats;
+                ImGui::Text("遮挡物: %d (%llu 三角形)，遮挡剔除: %d / %d，光栅化 %.2f ms，测试 %.2f ms",
+                    occlusionStats.occluders, (unsigned long long)occlusionStats.occluderTriangles, occlusionStats.occludedShapes,
+                    occlusionStats.testedShapes, occlusionStats.rasterMs, occlusionStats.testMs);
+            }
+            ImGui::Checkbox("LOD", &pipeline->enableLod);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("远处的形状改用导入时生成的简化网格，简化误差投影到屏幕上不超过给定像素数");
+            }
+            if (pipeline->enableLod) {
+                ImGui::SliderFloat("LOD 误差像素", &pipeline->lodErrorPixels, 0.1f, 8.0f, "%.1f");
+                ImGui::Text("简化形状: %d，少绘制三角形: %llu", pipeline->lodReducedShapes, (unsigned long long)pipeline->lodSavedTriangles);
+            }
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.f / config.io.Framerate, config.io.Framerate);
             ImGui::Text("Pipeline current render FPS %.3f ms/frame (%.1f FPS)", 1000.f * pipeline->frameTime, 1.f / pipeline->frameTime);
+            const auto& renderStats = pipeline->renderer->GetStats();
+            ImGui::Text("阴影: %.2f ms, 顶点: %.2f ms, 片元: %.2f ms", pipeline->shadowPassTime, renderStats.vertexStageMs, renderStats.fragmentStageMs);
+            ImGui::Text("绘制批次: %d，多实例绘制的形状: %d，裁剪的三角形: %d", renderStats.drawBatches, renderStats.instancedShapes, renderStats.clippedTriangles);
+            ImGui::Text("不覆盖像素中心而丢弃的小三角形: %d", renderStats.sampleCulledTriangles);
+            ImGui::Text("画线: %d 条, %.2f ms", renderStats.lineSegments, renderStats.lineMs);
+            ImGui::Checkbox("材质内由近到远", &pipeline->enableDepthSort);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("渲染队列在同一材质内按深度分段由近到远绘制，被挡住的像素在深度测试时丢弃，不再着色");
+            }
+            const auto& queueStats = pipeline->renderQueue.GetStats();
+            ImGui::Text("渲染队列: %d 个形状，%d 种状态；切换 着色器 %d/%d，材质 %d/%d，纹理 %d/%d（排序后/剔除顺序）",
+                queueStats.items, queueStats.states, queueStats.shaderChanges, queueStats.unsortedShaderChanges,
+                queueStats.materialChanges, queueStats.unsortedMaterialChanges, queueStats.textureChanges, queueStats.unsortedTextureChanges);
+            if (pipeline->shadowMaskMode != aries::shadow::ShadowMaskMode::Off) {
+                const auto& maskStats = pipeline->renderer->GetShadowMask().GetStats();
+                ImGui::Text("预深度: %.2f ms, 阴影遮罩: %.2f ms", renderStats.prepassMs, renderStats.shadowMaskMs);
+                ImGui::Text("遮罩采样: %d px, 上采样: %d px, 边缘回退: %d px", maskStats.sampledPixels, maskStats.upsampledPixels, maskStats.fallbackPixels);
+            }
 
             ImGui::End();
         }
@@ -108,6 +175,16 @@ namespace aries {
             ShowModelLoaderWindow(&show_loader_window);
         }
 
+        // 基准测试窗口
+        if (show_benchmark_window) {
+            ShowBenchmarkWindow(&show_benchmark_window);
+        }
+
+        // 纹理管理窗口
+        if (show_texture_window) {
+            ShowTextureManagerWindow(&show_texture_window);
+        }
+
         // 相机控制
         auto camera = scene->GetCamera();
         if (!config.io.WantCaptureKeyboard) {
@@ -135,7 +212,7 @@ namespace aries {
     void Application::LoadModel(const std::string& filename) {
         std::cout << "[Application] 加载obj模型文件：" << filename << std::endl;
         try {
-            auto model = ObjLoader::LoadModel(filename);
+            auto model = ObjLoader::LoadModel(filename, modelLoadOptions);
             scene->AddModel(model);
         } catch (const std::exception& e) {
             std::cerr << "[Application] 加载obj模型失败: " << e.what() << std::endl;
@@ -256,9 +333,9 @@ namespace aries {
                 }
                 if (ImGui::MenuItem("重置变换")) {
                     // 重置模型变换到默认状态
-                    model->position = Vector3f(0.0f, 0.0f, 0.0f);
-                    model->rotation = Vector3f(0.0f, 0.0f, 0.0f);
-                    model->scale = Vector3f(1.0f, 1.0f, 1.0f);
+                    model->SetPosition(Vector3f(0.0f, 0.0f, 0.0f));
+                    model->SetRotation(Vector3f(0.0f, 0.0f, 0.0f));
+                    model->SetScale(Vector3f(1.0f, 1.0f, 1.0f));
                 }
                 if (ImGui::MenuItem("复制模型")) {
                     // 复制模型
@@ -280,7 +357,7 @@ namespace aries {
                 ImGui::Text("Total Triangles: %zu", [&model]() {
                     size_t totalTriangles = 0;
                     for (const auto& shape : model->shapes) {
-                        totalTriangles += shape->mesh.size();
+                        totalTriangles += shape->GetTriangles().size();
                     }
                     return totalTriangles;
                 }());
@@ -289,21 +366,50 @@ namespace aries {
 
                 // 模型变换控制
                 if (ImGui::CollapsingHeader("Transform", ImGuiTreeNodeFlags_DefaultOpen)) {
-                    ImGui::DragFloat3("Position", model->position.data(), 0.01f);
-                    ImGui::DragFloat3("Rotation", model->rotation.data(), 0.2f, -180.0f, 180.0f);
-                    ImGui::DragFloat3("Scale", model->scale.data(), 0.01f, 0.1f, 10.0f);
+                    //? 变换只能通过 Set 修改（会使缓存的矩阵失效），这里编辑副本，有改动时写回
+                    Vector3f position = model->GetPosition();
+                    Vector3f rotation = model->GetRotation();
+                    Vector3f scale = model->GetScale();
+                    if (ImGui::DragFloat3("Position", position.data(), 0.01f)) {
+                        model->SetPosition(position);
+                    }
+                    if (ImGui::DragFloat3("Rotation", rotation.data(), 0.2f, -180.0f, 180.0f)) {
+                        model->SetRotation(rotation);
+                    }
+                    if (ImGui::DragFloat3("Scale", scale.data(), 0.01f, 0.1f, 10.0f)) {
+                        model->SetScale(scale);
+                    }
+
+                    // 父模型：变换相对父模型，父模型移动时一起移动
+                    const char* parentName = model->GetParent() ? model->GetParent()->name.c_str() : "(无)";
+                    if (ImGui::BeginCombo("Parent", parentName)) {
+                        if (ImGui::Selectable("(无)", model->GetParent() == nullptr)) {
+                            model->SetParent(nullptr);
+                        }
+                        for (auto& [otherName, other] : scene->models) {
+                            if (other == model) {
+                                continue;
+                            }
+                            if (ImGui::Selectable(otherName.c_str(), model->GetParent() == other.get())) {
+                                if (!model->SetParent(other.get())) {
+                                    std::cerr << "[Application] 不能把 " << modelName << " 挂到自己的子孙 " << otherName << " 下" << std::endl;
+                                }
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
 
                     // 快速操作按钮
                     if (ImGui::Button("Reset Position")) {
-                        model->position = Vector3f(0.0f, 0.0f, 0.0f);
+                        model->SetPosition(Vector3f(0.0f, 0.0f, 0.0f));
                     }
                     ImGui::SameLine();
                     if (ImGui::Button("Reset Rotation")) {
-                        model->rotation = Vector3f(0.0f, 0.0f, 0.0f);
+                        model->SetRotation(Vector3f(0.0f, 0.0f, 0.0f));
                     }
                     ImGui::SameLine();
                     if (ImGui::Button("Reset Scale")) {
-                        model->scale = Vector3f(1.0f, 1.0f, 1.0f);
+                        model->SetScale(Vector3f(1.0f, 1.0f, 1.0f));
                     }
                 }
 
@@ -325,7 +431,7 @@ namespace aries {
                                 // shape->visible = false;
                             }
                             if (ImGui::MenuItem("重置材质")) {
-                                ApplyDefaultMaterial(std::dynamic_pointer_cast<ShadowedBlinnPhongMaterial>(shape->material)->property);
+                                ApplyDefaultMaterial(std::dynamic_pointer_cast<ShadowedBlinnPhongMaterial>(shape->GetMaterial())->property);
                             }
                             ImGui::EndPopup();
                         }
@@ -334,7 +440,14 @@ namespace aries {
                             ImGui::PushID(shapeId.c_str());
 
                             // 显示 Shape 信息
-                            ImGui::Text("Triangles: %zu", shape->mesh.size());
+                            ImGui::Text("Triangles: %zu", shape->GetTriangles().size());
+                            if (!shape->GetLods().empty()) {
+                                ImGui::Text("LOD: %d / %zu，当前 %zu 个三角形", shape->lodIndex, shape->GetLods().size(), shape->GetRenderMesh().size());
+                            }
+                            ImGui::Checkbox("遮挡物", &shape->occluder);
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::SetTooltip("可见时总是写入遮挡深度缓冲，不受自动选择的面积与三角形数限制");
+                            }
                             
                             // 材质编辑区域
                             if (ImGui::CollapsingHeader("Material Settings", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -369,6 +482,7 @@ namespace aries {
                 // ✅ 使用 Scene::RemoveModel 方法
                 scene->RemoveModel(modelToDelete);
                 std::cout << "[Scene] 已删除模型: " << modelToDelete << std::endl;
+                TextureManager::GetInstance().Trim(); // 模型的纹理变为空闲，超出预算时可以被淘汰
                 
                 modelToDelete.clear();
                 ImGui::CloseCurrentPopup();
@@ -411,7 +525,7 @@ namespace aries {
             if (ImGui::Button("应用默认材质到所有")) {
                 for (auto& [modelName, model] : scene->models) {
                     for (auto& shape : model->shapes) {
-                        auto material = std::dynamic_pointer_cast<ShadowedBlinnPhongMaterial>(shape->material);
+                        auto material = std::dynamic_pointer_cast<ShadowedBlinnPhongMaterial>(shape->GetMaterial());
                         if (material) {
                             ApplyDefaultMaterial(material->property);
                         }
@@ -428,7 +542,7 @@ namespace aries {
 
     // 材质编辑器
     void Application::ShowMaterialEditor(sptr<Shape> shape) {
-        auto material = std::dynamic_pointer_cast<ShadowedBlinnPhongMaterial>(shape->material);
+        auto material = std::dynamic_pointer_cast<ShadowedBlinnPhongMaterial>(shape->GetMaterial());
         if (!material) {
             ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "材质类型不匹配！");
             return;
@@ -455,9 +569,23 @@ namespace aries {
             ImGui::SliderFloat("Shadow Intensity", &prop.shadowIntensity, 0.0f, 1.0f);
             ImGui::InputFloat("Shadow Bias", &prop.shadowBias, 0.0001f, 0.001f, "%.6f");
             
-            ImGui::SliderInt("PCF Samples", &prop.pcfSamples, 1, 5);
-            if (ImGui::IsItemHovered()) {
-                ImGui::SetTooltip("1 = 硬阴影\n3 = 软阴影 (3x3)\n5 = 高质量软阴影 (5x5)");
+            const char* filterNames[] = {"Hard", "PCF", "Bilinear 2x2", "Poisson"};
+            int filterIndex = static_cast<int>(prop.shadowFilter);
+            if (ImGui::Combo("Shadow Filter", &filterIndex, filterNames, IM_ARRAYSIZE(filterNames))) {
+                prop.shadowFilter = static_cast<aries::shadow::ShadowFilterMode>(filterIndex);
+            }
+
+            if (prop.shadowFilter == aries::shadow::ShadowFilterMode::PCF) {
+                ImGui::SliderInt("PCF Samples", &prop.pcfSamples, 1, 5);
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("1 = 硬阴影\n3 = 软阴影 (3x3)\n5 = 高质量软阴影 (5x5)");
+                }
+            } else if (prop.shadowFilter == aries::shadow::ShadowFilterMode::Poisson) {
+                ImGui::SliderInt("Poisson Taps", &prop.poissonTaps, 1, aries::shadow::MAX_POISSON_TAPS);
+                ImGui::SliderFloat("Poisson Radius", &prop.poissonRadius, 0.5f, 8.0f);
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("采样半径，单位为阴影贴图纹素");
+                }
             }
             
             ImGui::SliderFloat("Distance Attenuation", &prop.shadowDistanceAttenuation, 0.0f, 50.0f);
@@ -503,12 +631,250 @@ namespace aries {
         if (ImGui::CollapsingHeader("Texture Info")) {
             if (prop.texture) {
                 ImGui::Text("Texture: %dx%d", prop.texture->GetWidth(), prop.texture->GetHeight());
+                ImGui::Text("Source channels: %d", prop.texture->GetSourceChannels());
+                ImGui::Text("Mip Levels: %d (%.2f MB, %s)", prop.texture->GetMipLevelCount(), prop.texture->GetMemoryBytes() / (1024.0 * 1024.0),
+                            prop.texture->IsMapped() ? "mapped from cache" : "heap");
+
+                const char* filterNames[] = {"Nearest", "Bilinear", "Trilinear"};
+                int filterIndex = static_cast<int>(prop.texture->GetFilter());
+                if (ImGui::Combo("Texture Filter", &filterIndex, filterNames, IM_ARRAYSIZE(filterNames))) {
+                    prop.texture->SetFilter(static_cast<TextureFilter>(filterIndex));
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Nearest: 只读原图\nBilinear: 按屏幕空间导数选择 mip 级别后双线性过滤\nTrilinear: 相邻两级双线性结果再按 LOD 混合");
+                }
+
+                const char* formatNames[] = {"RGBA8", "BC1"};
+                int formatIndex = static_cast<int>(prop.texture->GetFormat());
+                if (ImGui::Combo("Texture Format", &formatIndex, formatNames, IM_ARRAYSIZE(formatNames))) {
+                    prop.texture->SetFormat(static_cast<TextureFormat>(formatIndex));
+                    TextureManager::GetInstance().RefreshMemoryUsage();
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("RGBA8: 每纹素 4 字节\nBC1: 每 4x4 块 8 字节（1/8 内存），采样时解码，有损，转回 RGBA8 不能恢复原图");
+                }
+
+                const char* layoutNames[] = {"Linear", "Tiled 4x4"};
+                int layoutIndex = static_cast<int>(prop.texture->GetLayout());
+                if (ImGui::Combo("Texture Layout", &layoutIndex, layoutNames, IM_ARRAYSIZE(layoutNames))) {
+                    prop.texture->SetLayout(static_cast<TextureLayout>(layoutIndex));
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Linear: 行主序\nTiled 4x4: 4x4 纹素一块（64 字节，一条缓存行），块内行主序");
+                }
+
+                bool isVirtual = prop.texture->IsVirtual();
+                if (ImGui::Checkbox("Virtual Texture", &isVirtual)) {
+                    prop.texture->SetVirtual(isVirtual);
+                    TextureManager::GetInstance().RefreshMemoryUsage();
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("按 128x128 分页，只解码并驻留最近几帧采样到的页，缺页时退回更粗的 mip 级别");
+                }
+                if (isVirtual) {
+                    VirtualTextureStats vs = prop.texture->GetVirtualStats();
+                    ImGui::Text("Pages: %zu / %zu resident (%.2f MB), requested %zu, missing %zu", vs.residentPages, vs.totalPages,
+                                vs.residentBytes / (1024.0 * 1024.0), vs.requestedPages, vs.missingPages);
+                }
             } else {
                 ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "No texture");
             }
         }
     }
 
+    // 基准测试窗口
+    void Application::ShowBenchmarkWindow(bool* p_open) {
+        ImGui::Begin("Benchmark", p_open, ImGuiWindowFlags_AlwaysAutoResize);
+
+        static int sampleCount = 200000;
+        static vector<bench::BenchmarkResult> shadowResults;
+        static vector<bench::BenchmarkResult> storageResults;
+        static vector<bench::BenchmarkResult> textureResults;
+        static vector<bench::FrameBenchmarkResult> textureFrameResults;
+        static int benchmarkFrames = 10;
+
+        ImGui::InputInt("Sample Points", &sampleCount, 10000, 100000);
+        sampleCount = std::clamp(sampleCount, 1000, 10000000);
+
+        if (ImGui::Button("运行阴影过滤基准测试") && scene->directionalShadow) {
+            vector<sptr<Shape>> shapes;
+            for (auto& [name, model] : scene->models) {
+                shapes.insert(shapes.end(), model->shapes.begin(), model->shapes.end());
+            }
+            auto points = bench::GenerateSurfacePoints(shapes, sampleCount);
+            shadowResults = bench::RunShadowFilterBenchmark(*scene->directionalShadow, points);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("在场景表面随机取样，单线程比较各阴影过滤模式的每像素采样次数与耗时");
+        }
+
+        auto showResultTable = [](const char* id, const vector<bench::BenchmarkResult>& results, bool showShadowed = true) {
+            if (results.empty() || !ImGui::BeginTable(id, showShadowed ? 4 : 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                return;
+            }
+            ImGui::TableSetupColumn("Mode");
+            ImGui::TableSetupColumn("Taps/px");
+            ImGui::TableSetupColumn("ns/px");
+            if (showShadowed) ImGui::TableSetupColumn("Shadowed");
+            ImGui::TableHeadersRow();
+            for (const auto& r : results) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(r.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", r.tapsPerPixel);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", r.nsPerPixel);
+                if (showShadowed) {
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f%%", r.shadowedRatio * 100.0);
+                }
+            }
+            ImGui::EndTable();
+        };
+
+        showResultTable("ShadowBench", shadowResults);
+
+        if (ImGui::Button("运行阴影深度存储基准测试") && scene->directionalShadow) {
+            vector<sptr<Shape>> shapes;
+            for (auto& [name, model] : scene->models) {
+                shapes.insert(shapes.end(), model->shapes.begin(), model->shapes.end());
+            }
+            auto points = bench::GenerateSurfacePoints(shapes, sampleCount);
+            storageResults = bench::RunShadowStorageBenchmark(*scene->directionalShadow, pipeline->shapeStore, points);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("多线程比较 Float32/Unorm16 与线性/分块布局下 PCF 3x3、5x5 的查询耗时");
+        }
+
+        showResultTable("StorageBench", storageResults);
+
+        if (ImGui::Button("运行纹理采样基准测试")) {
+            // 选已加载纹理中最大的一张，太小的纹理整个放得进缓存，看不出布局差异
+            sptr<Texture> texture;
+            for (const auto& info : TextureManager::GetInstance().GetTextureInfos()) {
+                const auto& tex = info.texture;
+                if (!texture || (size_t)tex->GetWidth() * tex->GetHeight() > (size_t)texture->GetWidth() * texture->GetHeight()) {
+                    texture = tex;
+                }
+            }
+            if (texture) {
+                textureResults = bench::RunTextureSampleBenchmark(*texture, sampleCount);
+            }
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("对已加载的最大纹理，单线程比较线性/分块布局下连续与随机 UV 流的采样耗时");
+        }
+
+        showResultTable("TextureBench", textureResults, false);
+
+        ImGui::InputInt("Frames", &benchmarkFrames, 1, 10);
+        benchmarkFrames = std::clamp(benchmarkFrames, 1, 1000);
+        if (ImGui::Button("运行纹理格式帧时间基准测试")) {
+            textureFrameResults = bench::RunTextureFormatFrameBenchmark(*pipeline, scene, benchmarkFrames);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("把所有已加载纹理分别转为 RGBA8 与 BC1，渲染当前场景比较帧时间，结束后还原");
+        }
+
+        if (!textureFrameResults.empty() && ImGui::BeginTable("TextureFrameBench", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("Format");
+            ImGui::TableSetupColumn("Frame ms");
+            ImGui::TableSetupColumn("Fragment ms");
+            ImGui::TableSetupColumn("Texture MB");
+            ImGui::TableHeadersRow();
+            for (const auto& r : textureFrameResults) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(r.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", r.frameMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", r.fragmentMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", r.textureMB);
+            }
+            ImGui::EndTable();
+        }
+
+        if (ImGui::Button("Close")) 
+            *p_open = false;
+
+        ImGui::End();
+    }
+
+    // 纹理管理窗口：内存预算与每张纹理的占用
+    void Application::ShowTextureManagerWindow(bool* p_open) {
+        ImGui::Begin("Texture Manager", p_open);
+
+        auto& manager = TextureManager::GetInstance();
+        const double MB = 1024.0 * 1024.0;
+
+        int budgetMB = (int)(manager.GetMemoryBudget() / (size_t)MB);
+        if (ImGui::InputInt("Memory Budget (MB)", &budgetMB, 64, 256)) {
+            manager.SetMemoryBudget((size_t)std::max(budgetMB, 0) * (size_t)MB);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("超出预算时按最近最少使用的顺序淘汰没有材质引用的纹理");
+        }
+
+        ImGui::Text("已用: %.2f MB / %.2f MB，累计淘汰 %zu 张", manager.GetMemoryUsage() / MB, manager.GetMemoryBudget() / MB, manager.GetEvictedCount());
+
+        const char* formatNames[] = {"RGBA8", "BC1"};
+        int formatIndex = static_cast<int>(manager.GetDefaultFormat());
+        if (ImGui::Combo("Default Format", &formatIndex, formatNames, IM_ARRAYSIZE(formatNames))) {
+            manager.SetDefaultFormat(static_cast<TextureFormat>(formatIndex));
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("之后加载的纹理使用的存储格式，BC1 在加载时编码并写入磁盘缓存");
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("转换全部")) {
+            manager.ConvertAll(manager.GetDefaultFormat());
+        }
+        int virtualThresholdMB = (int)(manager.GetVirtualThreshold() / (size_t)MB);
+        if (ImGui::InputInt("Virtual Threshold (MB)", &virtualThresholdMB, 16, 64)) {
+            manager.SetVirtualThreshold((size_t)std::max(virtualThresholdMB, 0) * (size_t)MB);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("原图解码成 RGBA8 后超过这个大小的纹理在加载时使用虚拟纹理，以磁盘缓存为后备按页调入");
+        }
+        int virtualBudgetMB = (int)(manager.GetVirtualBudget() / (size_t)MB);
+        if (ImGui::InputInt("Virtual Budget (MB)", &virtualBudgetMB, 16, 64)) {
+            manager.SetVirtualBudget((size_t)std::max(virtualBudgetMB, 0) * (size_t)MB);
+        }
+        int uploadsPerFrame = manager.GetVirtualUploadsPerFrame();
+        if (ImGui::InputInt("Pages / Frame", &uploadsPerFrame, 8, 32)) {
+            manager.SetVirtualUploadsPerFrame(std::max(uploadsPerFrame, 0));
+        }
+        VirtualTextureStats vs = manager.GetVirtualStats();
+        ImGui::Text("虚拟页: 驻留 %zu / %zu（%.2f MB），上一帧请求 %zu，缺失 %zu，载入 %zu，淘汰 %zu", vs.residentPages, vs.totalPages,
+                    vs.residentBytes / MB, vs.requestedPages, vs.missingPages, vs.loadedPages, vs.evictedPages);
+
+        if (ImGui::Button("整理")) {
+            manager.Trim();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("清除未使用的纹理")) {
+            manager.ClearUnusedTextures();
+        }
+
+        auto infos = manager.GetTextureInfos();
+        if (!infos.empty() && ImGui::BeginTable("TextureTable", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable)) {
+            ImGui::TableSetupColumn("Path");
+            ImGui::TableSetupColumn("Size");
+            ImGui::TableSetupColumn("Format");
+            ImGui::TableSetupColumn("MB");
+            ImGui::TableSetupColumn("Storage");
+            ImGui::TableSetupColumn("State");
+            ImGui::TableHeadersRow();
+            for (const auto& info : infos) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(info.path.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%dx%d", info.texture->GetWidth(), info.texture->GetHeight());
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(formatNames[static_cast<int>(info.texture->GetFormat())]);
+                ImGui::TableNextColumn(); ImGui::Text("%.2f", info.memoryBytes / MB);
+                ImGui::TableNextColumn(); ImGui::Text("%s%s", info.texture->IsMapped() ? "mapped" : "heap", info.texture->IsVirtual() ? " + virtual" : "");
+                ImGui::TableNextColumn(); ImGui::TextUnformatted(info.inUse ? "in use" : "idle");
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
     // 简化的配置窗口（主要是相机和光源）
     void Application::ShowConfigWindow(bool* p_open, sptr<Camera> camera) {
         ImGui::Begin("Camera & Light Config", p_open);
@@ -547,6 +913,32 @@ namespace aries {
                 lightFront.z() = cosf(lightPitchRad) * sinf(lightYawRad);
                 light->direction = lightFront.normalized();
                 scene->directionalShadow->SetLightDirection(light->direction);
+
+                bool autoFit = scene->directionalShadow->IsAutoFit();
+                if (ImGui::Checkbox("自动适配阴影范围", &autoFit)) {
+                    scene->directionalShadow->SetAutoFit(autoFit);
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("根据视野内的物体包围盒自动调整光源正交投影范围");
+                }
+
+                const auto* shadowRenderer = scene->directionalShadow->GetShadowRenderer();
+                const char* formatNames[] = {"Float32", "Unorm16"};
+                const char* layoutNames[] = {"Linear", "Tiled (Morton 8x8)"};
+                int formatIndex = static_cast<int>(shadowRenderer->GetDepthFormat());
+                int layoutIndex = static_cast<int>(shadowRenderer->GetDepthLayout());
+                bool formatChanged = ImGui::Combo("Shadow Depth Format", &formatIndex, formatNames, IM_ARRAYSIZE(formatNames));
+                bool layoutChanged = ImGui::Combo("Shadow Depth Layout", &layoutIndex, layoutNames, IM_ARRAYSIZE(layoutNames));
+                if (formatChanged || layoutChanged) {
+                    scene->directionalShadow->SetDepthStorage(
+                        static_cast<aries::shadow::ShadowDepthFormat>(formatIndex),
+                        static_cast<aries::shadow::ShadowDepthLayout>(layoutIndex));
+                }
+                ImGui::Text("深度缓冲占用: %.2f MB", shadowRenderer->GetDepthBufferBytes() / (1024.0 * 1024.0));
+
+                const auto& stats = shadowRenderer->GetStats();
+                ImGui::Text("阴影投射: %d 个形状 / %llu 个三角形", stats.drawnShapes, (unsigned long long)stats.drawnTriangles);
+                ImGui::Text("整体剔除: %d 个形状 / %llu 个三角形", stats.culledShapes, (unsigned long long)stats.culledTriangles);
             } else {
                 ImGui::Text("No light source");
             }
@@ -598,6 +990,18 @@ namespace aries {
         }
         
         ImGui::Separator();
+
+        ImGui::Checkbox("打包纹理图集", &modelLoadOptions.packTextureAtlas);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("把不超过 %d 像素、UV 在 [0,1] 内的小纹理打包进共享图集，重映射 UV 并合并只有纹理不同的材质", modelLoadOptions.maxPackedTextureSize);
+        }
+        if (modelLoadOptions.packTextureAtlas) {
+            ImGui::InputInt("Max Packed Size", &modelLoadOptions.maxPackedTextureSize, 64, 256);
+            ImGui::InputInt("Max Atlas Size", &modelLoadOptions.maxAtlasSize, 512, 1024);
+            ImGui::InputInt("Atlas Padding", &modelLoadOptions.atlasPadding, 1, 4);
+            modelLoadOptions.maxAtlasSize = std::max(modelLoadOptions.maxAtlasSize, 64);
+            modelLoadOptions.atlasPadding = std::clamp(modelLoadOptions.atlasPadding, 0, 64);
+        }
         
         if (ImGui::Button("Load Model")) {
             if (strlen(filePath) > 0) {
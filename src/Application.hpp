@@ -6,6 +6,7 @@
 
 #include "Pipeline.hpp"
 #include "Scene.hpp"
+#include "ObjLoader.hpp"
 #include <thread>
 #include "Render/Materials/M_ShadowedBlinnPhongMaterial.hpp"
 
@@ -28,6 +29,7 @@ namespace aries {
         float lastMouseX = 0.0f;
         float lastMouseY = 0.0f;
         float mouseSensitivity = 0.1f; // 鼠标灵敏度
+        ObjLoadOptions modelLoadOptions; // 模型导入选项
 
     private:
         // 新增的UI方法
@@ -35,6 +37,8 @@ namespace aries {
         void ShowModelLoaderWindow(bool* p_open);
         void ShowConfigWindow(bool* p_open, sptr<Camera> camera);
         void ShowMaterialEditor(sptr<Shape> shape);
+        void ShowBenchmarkWindow(bool* p_open);
+        void ShowTextureManagerWindow(bool* p_open);
         
         // 材质预设方法
         void ApplyDefaultMaterial(ShadowedBlinnPhongMaterial::property_t& prop);
@@ -0,0 +1,351 @@
+/// FileName: Benchmark.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "Benchmark.hpp"
+#include "Render/Model.hpp"
+#include "Render/TextureManager.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <omp.h>
+
+using aries::shadow::DirectionalShadow;
+using aries::shadow::ShadowSampleResult;
+using aries::shadow::ShadowDepthFormat;
+using aries::shadow::ShadowDepthLayout;
+
+namespace aries::bench {
+    vector<Vector3f> GenerateSurfacePoints(const vector<sptr<Shape>>& shapes, int count, uint32_t seed) {
+        vector<Vector3f> points;
+        size_t totalTriangles = 0;
+        for (const auto& shape : shapes) {
+            totalTriangles += shape->GetTriangles().size();
+        }
+        if (totalTriangles == 0 || count <= 0) {
+            return points;
+        }
+
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<size_t> triDist(0, totalTriangles - 1);
+        std::uniform_real_distribution<float> baryDist(0.0f, 1.0f);
+
+        points.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            // 按三角形数量均匀挑选形状和三角形
+            size_t ti = triDist(rng);
+            const Shape* shape = nullptr;
+            for (const auto& s : shapes) {
+                if (ti < s->GetTriangles().size()) {
+                    shape = s.get();
+                    break;
+                }
+                ti -= s->GetTriangles().size();
+            }
+
+            const Triangle& tri = shape->GetTriangles()[ti];
+            float a = baryDist(rng), b = baryDist(rng);
+            if (a + b > 1.0f) {
+                a = 1.0f - a;
+                b = 1.0f - b;
+            }
+            Vector3f local = tri.vertex[0] * (1.0f - a - b) + tri.vertex[1] * a + tri.vertex[2] * b;
+            Vector4f world = shape->model->GetModelMatrix() * Vector4f(local.x(), local.y(), local.z(), 1.0f);
+            points.emplace_back(world.head<3>());
+        }
+        return points;
+    }
+
+    vector<BenchmarkResult> RunShadowFilterBenchmark(const DirectionalShadow& shadow, const vector<Vector3f>& points) {
+        using Sampler = std::function<ShadowSampleResult(const Vector3f&)>;
+        constexpr float bias = 0.002f;
+
+        const std::pair<string, Sampler> cases[] = {
+            {"Hard",        [&](const Vector3f& p) { return shadow.SampleShadowWithDistance(p, bias); }},
+            {"PCF 3x3",     [&](const Vector3f& p) { return shadow.SampleShadowPCFWithDistance(p, 3, bias); }},
+            {"PCF 5x5",     [&](const Vector3f& p) { return shadow.SampleShadowPCFWithDistance(p, 5, bias); }},
+            {"Bilinear 2x2",[&](const Vector3f& p) { return shadow.SampleShadowBilinearWithDistance(p, bias); }},
+            {"Poisson 8",   [&](const Vector3f& p) { return shadow.SampleShadowPoissonWithDistance(p, 8, 2.0f, bias); }},
+            {"Poisson 12",  [&](const Vector3f& p) { return shadow.SampleShadowPoissonWithDistance(p, 12, 2.0f, bias); }},
+            {"Poisson 16",  [&](const Vector3f& p) { return shadow.SampleShadowPoissonWithDistance(p, 16, 2.0f, bias); }},
+            {"Poisson 32",  [&](const Vector3f& p) { return shadow.SampleShadowPoissonWithDistance(p, 32, 2.0f, bias); }},
+        };
+
+        vector<BenchmarkResult> results;
+        if (points.empty()) {
+            return results;
+        }
+
+        for (const auto& [name, sampler] : cases) {
+            uint64_t taps = 0;
+            size_t shadowed = 0;
+            volatile float sink = 0.0f; // 防止编译器把采样优化掉
+
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& p : points) {
+                ShadowSampleResult r = sampler(p);
+                taps += r.tapCount;
+                shadowed += r.shadowFactor > 0.0f;
+                sink = sink + r.shadowFactor + r.occluderDistance;
+            }
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+            results.push_back({
+                .name = name,
+                .tapsPerPixel = (double)taps / points.size(),
+                .nsPerPixel = elapsed.count() / points.size(),
+                .shadowedRatio = (double)shadowed / points.size(),
+            });
+        }
+
+        std::cout << "[Benchmark] 阴影过滤模式基准测试完成，样本数：" << points.size() << '\n';
+        for (const auto& r : results) {
+            std::cout << "    " << r.name << ": " << r.tapsPerPixel << " taps/px, " << r.nsPerPixel << " ns/px\n";
+        }
+        return results;
+    }
+
+    vector<BenchmarkResult> RunShadowStorageBenchmark(DirectionalShadow& shadow, const model::ShapeStore& store, const vector<Vector3f>& points) {
+        constexpr float bias = 0.002f;
+
+        struct StorageCase {
+            const char* name;
+            ShadowDepthFormat format;
+            ShadowDepthLayout layout;
+        };
+        const StorageCase storages[] = {
+            {"Float32 Linear", ShadowDepthFormat::Float32, ShadowDepthLayout::Linear},
+            {"Float32 Tiled",  ShadowDepthFormat::Float32, ShadowDepthLayout::Tiled},
+            {"Unorm16 Linear", ShadowDepthFormat::Unorm16, ShadowDepthLayout::Linear},
+            {"Unorm16 Tiled",  ShadowDepthFormat::Unorm16, ShadowDepthLayout::Tiled},
+        };
+
+        vector<BenchmarkResult> results;
+        if (points.empty()) {
+            return results;
+        }
+
+        vector<uint32_t> casters(store.Size());
+        std::iota(casters.begin(), casters.end(), 0u);
+
+        const auto* shadowRenderer = shadow.GetShadowRenderer();
+        ShadowDepthFormat oldFormat = shadowRenderer->GetDepthFormat();
+        ShadowDepthLayout oldLayout = shadowRenderer->GetDepthLayout();
+        const int n = (int)points.size();
+
+        for (const auto& storage : storages) {
+            shadow.SetDepthStorage(storage.format, storage.layout);
+            shadow.UpdateShadowMap(store, casters);
+
+            for (int pcfSize : {3, 5}) {
+                uint64_t taps = 0;
+                uint64_t shadowed = 0;
+
+                auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for schedule(static) reduction(+ : taps, shadowed)
+                for (int i = 0; i < n; ++i) {
+                    ShadowSampleResult r = shadow.SampleShadowPCFWithDistance(points[i], pcfSize, bias);
+                    taps += r.tapCount;
+                    shadowed += r.shadowFactor > 0.0f;
+                }
+                std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+                results.push_back({
+                    .name = string(storage.name) + " / PCF " + std::to_string(pcfSize),
+                    .tapsPerPixel = (double)taps / n,
+                    .nsPerPixel = elapsed.count() / n,
+                    .shadowedRatio = (double)shadowed / n,
+                });
+            }
+
+            std::cout << "[Benchmark] " << storage.name << " 深度缓冲占用 "
+                      << shadowRenderer->GetDepthBufferBytes() / (1024.0 * 1024.0) << " MB\n";
+        }
+
+        shadow.SetDepthStorage(oldFormat, oldLayout);
+        shadow.UpdateShadowMap(store, casters);
+
+        std::cout << "[Benchmark] 阴影深度存储基准测试完成，样本数：" << n << "，线程数：" << omp_get_max_threads() << '\n';
+        for (const auto& r : results) {
+            std::cout << "    " << r.name << ": " << r.nsPerPixel << " ns/px\n";
+        }
+        return results;
+    }
+
+    vector<BenchmarkResult> RunTextureSampleBenchmark(const Texture& source, int count, uint32_t seed) {
+        vector<BenchmarkResult> results;
+        if (count <= 0 || source.GetWidth() <= 0 || source.GetHeight() <= 0) {
+            return results;
+        }
+        // 在副本上切换格式与布局，BC1 有损，不能在原纹理上来回转换
+        Texture texture = source.Clone();
+        texture.SetFormat(TextureFormat::RGBA8);
+
+        //* 1. 生成 UV 流：每个像素覆盖约 1.5 个纹素，三线性会同时读取第 0、1 级
+        constexpr float TEXELS_PER_PIXEL = 1.5f;
+        const int side = std::max(1, (int)std::sqrt((double)count));
+        const int n = side * side;
+        TextureGradient grad;
+        grad.dUVdx = Vector2f(TEXELS_PER_PIXEL / texture.GetWidth(), 0.0f);
+        grad.dUVdy = Vector2f(0.0f, TEXELS_PER_PIXEL / texture.GetHeight());
+
+        vector<Vector2f> coherent, random;
+        coherent.reserve(n);
+        random.reserve(n);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                coherent.emplace_back((x + 0.5f) * grad.dUVdx.x(), (y + 0.5f) * grad.dUVdy.y());
+            }
+        }
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> uvDist(0.0f, 1.0f);
+        for (int i = 0; i < n; ++i) {
+            random.emplace_back(uvDist(rng), uvDist(rng));
+        }
+
+        //* 2. 存储 × 过滤 × UV 流
+        struct StorageCase {
+            const char* name;
+            TextureFormat format;
+            TextureLayout layout;
+        };
+        struct FilterCase {
+            const char* name;
+            TextureFilter filter;
+            double taps;
+        };
+        const StorageCase storages[] = {
+            {"RGBA8 Linear", TextureFormat::RGBA8, TextureLayout::Linear},
+            {"RGBA8 Tiled",  TextureFormat::RGBA8, TextureLayout::Tiled},
+            {"BC1",          TextureFormat::BC1,   TextureLayout::Tiled},
+        };
+        const FilterCase filters[] = {
+            {"Bilinear",  TextureFilter::Bilinear,  4.0},
+            {"Trilinear", TextureFilter::Trilinear, 8.0},
+        };
+        const std::pair<const char*, const vector<Vector2f>*> streams[] = {
+            {"Coherent", &coherent},
+            {"Random",   &random},
+        };
+
+        DecodedBlockCache& blockCache = DecodedBlockCache::Get();
+        for (const auto& storage : storages) {
+            // 先切换布局再压缩，避免对 BC1 数据重新编码
+            texture.SetFormat(TextureFormat::RGBA8);
+            texture.SetLayout(storage.layout);
+            texture.SetFormat(storage.format);
+            for (const auto& filter : filters) {
+                texture.SetFilter(filter.filter);
+                for (const auto& [streamName, uvs] : streams) {
+                    volatile float sink = 0.0f; // 防止编译器把采样优化掉
+                    blockCache.hits = blockCache.misses = 0;
+
+                    auto start = std::chrono::steady_clock::now();
+                    for (const auto& uv : *uvs) {
+                        Vector3f c = texture.Sample(uv.x(), uv.y(), grad);
+                        sink = sink + c.x();
+                    }
+                    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+                    string name = string(storage.name) + " / " + filter.name + " / " + streamName;
+                    if (storage.format == TextureFormat::BC1) {
+                        double hitRate = (double)blockCache.hits / std::max<uint64_t>(1, blockCache.hits + blockCache.misses);
+                        name += " (hit " + std::to_string((int)(hitRate * 100.0 + 0.5)) + "%)";
+                    }
+                    results.push_back({
+                        .name = name,
+                        .tapsPerPixel = filter.taps,
+                        .nsPerPixel = elapsed.count() / n,
+                        .shadowedRatio = 0.0,
+                    });
+                }
+            }
+            std::cout << "[Benchmark] " << storage.name << " 纹理占用 " << texture.GetMemoryBytes() / (1024.0 * 1024.0) << " MB\n";
+        }
+
+        std::cout << "[Benchmark] 纹理采样基准测试完成，纹理 " << texture.GetWidth() << "x" << texture.GetHeight()
+                  << "，样本数：" << n << '\n';
+        for (const auto& r : results) {
+            std::cout << "    " << r.name << ": " << r.nsPerPixel << " ns/px\n";
+        }
+        return results;
+    }
+
+    vector<FrameBenchmarkResult> RunTextureFormatFrameBenchmark(render::Pipeline& pipeline, sptr<scene::Scene> scene, int frames) {
+        vector<FrameBenchmarkResult> results;
+        auto& manager = TextureManager::GetInstance();
+        auto infos = manager.GetTextureInfos();
+        if (frames <= 0 || infos.empty()) {
+            return results;
+        }
+
+        // 备份原纹理，测试结束后原样还原（BC1 转回 RGBA8 是有损的）
+        vector<Texture> backups;
+        backups.reserve(infos.size());
+        for (const auto& info : infos) {
+            backups.push_back(info.texture->Clone());
+        }
+
+        struct Variant {
+            const char* name;
+            TextureFormat format;
+            bool isVirtual;
+        };
+        const Variant variants[] = {
+            {"RGBA8",         TextureFormat::RGBA8, false},
+            {"BC1",           TextureFormat::BC1,   false},
+            {"RGBA8 Virtual", TextureFormat::RGBA8, true},
+        };
+        for (const auto& [name, format, isVirtual] : variants) {
+            for (size_t i = 0; i < infos.size(); ++i) {
+                *infos[i].texture = backups[i].Clone();
+                infos[i].texture->SetFormat(format);
+                infos[i].texture->SetVirtual(isVirtual);
+            }
+
+            pipeline.Render(scene, scene->GetCamera()); // 预热，填充缓存与阴影贴图
+            for (int f = 0; isVirtual && f < 64; ++f) {
+                // 继续预热直到请求的页全部驻留，计时的是稳定状态
+                VirtualTextureStats stats = manager.GetVirtualStats();
+                if (stats.loadedPages == 0 && stats.missingPages == 0) {
+                    break;
+                }
+                pipeline.Render(scene, scene->GetCamera());
+            }
+            double frameMs = 0.0, fragmentMs = 0.0;
+            for (int f = 0; f < frames; ++f) {
+                auto start = std::chrono::steady_clock::now();
+                pipeline.Render(scene, scene->GetCamera());
+                frameMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                fragmentMs += pipeline.renderer->GetStats().fragmentStageMs;
+            }
+
+            // 虚拟纹理只统计驻留页：这里的后备存储是堆上的副本，正常加载时是磁盘缓存的映射
+            size_t textureBytes = 0;
+            for (const auto& info : infos) {
+                textureBytes += isVirtual ? info.texture->GetVirtualStats().residentBytes : info.texture->GetMemoryBytes();
+            }
+
+            results.push_back({
+                .name = name,
+                .frameMs = frameMs / frames,
+                .fragmentMs = fragmentMs / frames,
+                .textureMB = textureBytes / (1024.0 * 1024.0),
+            });
+        }
+
+        for (size_t i = 0; i < infos.size(); ++i) {
+            *infos[i].texture = std::move(backups[i]);
+        }
+        manager.RefreshMemoryUsage();
+
+        std::cout << "[Benchmark] 纹理格式帧时间基准测试完成，纹理数：" << infos.size() << "，帧数：" << frames << '\n';
+        for (const auto& r : results) {
+            std::cout << "    " << r.name << ": " << r.frameMs << " ms/frame, 片元 " << r.fragmentMs << " ms, 纹理 " << r.textureMB << " MB\n";
+        }
+        return results;
+    }
+}
@@ -0,0 +1,48 @@
+/// FileName: Benchmark.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 程序内置的性能基准测试，结果显示在 Benchmark 窗口中
+
+#pragma once
+
+#include "Render/CommonHeader.hpp"
+#include "Render/Shape.hpp"
+#include "Render/Shadow/DirectionalShadow.hpp"
+#include "Render/Texture.hpp"
+#include "Pipeline.hpp"
+#include "Scene.hpp"
+
+namespace aries::bench {
+    // 单项基准测试结果
+    struct BenchmarkResult {
+        string name;          // 测试项名称
+        double tapsPerPixel;  // 每像素平均采样次数
+        double nsPerPixel;    // 每像素平均耗时（纳秒）
+        double shadowedRatio; // 处于阴影（因子 > 0）中的像素比例，纹理测试中不使用
+    };
+
+    // 整帧渲染基准测试结果
+    struct FrameBenchmarkResult {
+        string name;      // 测试项名称
+        double frameMs;   // 平均每帧耗时（毫秒）
+        double fragmentMs;// 平均片元阶段耗时（毫秒）
+        double textureMB; // 测试时纹理总占用
+    };
+
+    // 在场景表面随机取样若干世界坐标点，模拟片元着色阶段的阴影查询
+    vector<Vector3f> GenerateSurfacePoints(const vector<sptr<Shape>>& shapes, int count, uint32_t seed = 12345);
+
+    // 比较各种阴影过滤模式的每像素采样次数与耗时（单线程）
+    vector<BenchmarkResult> RunShadowFilterBenchmark(const shadow::DirectionalShadow& shadow, const vector<Vector3f>& points);
+
+    // 比较阴影深度存储格式/布局对 PCF 3x3 与 5x5 查询耗时的影响
+    // 按片元阶段的方式用 OpenMP 并行查询，测试结束后恢复原来的存储设置并重绘阴影贴图；store 中所有形状都作为投射者
+    vector<BenchmarkResult> RunShadowStorageBenchmark(shadow::DirectionalShadow& shadow, const model::ShapeStore& store, const vector<Vector3f>& points);
+
+    // 比较 RGBA8 线性/分块与 BC1 存储下双线性、三线性采样的吞吐（单线程），BC1 项附带解码块缓存命中率
+    // 连续 UV 流模拟按扫描线着色一个贴满纹理的表面，随机 UV 流模拟缓存最不友好的访问，在纹理副本上进行
+    vector<BenchmarkResult> RunTextureSampleBenchmark(const Texture& texture, int count, uint32_t seed = 12345);
+
+    // 把所有已加载纹理分别转换为 RGBA8 与 BC1，渲染当前场景若干帧比较帧时间与片元阶段耗时，结束后还原纹理
+    vector<FrameBenchmarkResult> RunTextureFormatFrameBenchmark(render::Pipeline& pipeline, sptr<scene::Scene> scene, int frames);
+}
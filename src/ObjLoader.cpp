@@ -2,7 +2,11 @@
 
 #include "ObjLoader.hpp"
 #include <iostream>
+#include <chrono>
 #include <filesystem>
+#include <unordered_map>
+#include "Render/MeshLodCache.hpp"
+#include "Render/TextureAtlas.hpp"
 #include "Render/TextureManager.hpp"
 #include "Render/Materials/M_BlinnPhongMaterial.hpp"
 #include "Render/Materials/M_PreviewMaterial.hpp"
@@ -11,7 +15,7 @@
 using namespace tinyobj;
 using namespace aries::material;
 
-sptr<Model> ObjLoader::LoadModel(const string& filename) {
+sptr<Model> ObjLoader::LoadModel(const string& filename, const ObjLoadOptions& options) {
     attrib_t attrib;
     vector<shape_t> shapes;
     vector<material_t> materials;
@@ -38,60 +42,211 @@ sptr<Model> ObjLoader::LoadModel(const string& filename) {
         throw std::runtime_error("Failed to load OBJ file: " + filename);
     }
 
-    // 访问并打印 map_Kd (即 diffuse_texname)
-    for (const auto& mat : materials) {
+    //* 收集所有材质的 map_Kd (即 diffuse_texname) 路径，交给纹理管理器并行解码
+    vector<size_t> texturedMaterials;
+    vector<string> texPaths;
+    for (size_t i = 0; i < materials.size(); ++i) {
+        const material_t& mat = materials[i];
         if (!mat.diffuse_texname.empty()) {
             // 替换字符串中所有空格为下划线
             std::string diffuse_name = mat.diffuse_texname;
             std::replace(diffuse_name.begin(), diffuse_name.end(), ' ', '_'); 
             string texPath = base_dir + diffuse_name; // 这里把空格替换为下划线
             std::cout << "[ObjLoader] 材质 “" << mat.name << "” 的 map_Kd = " << texPath << std::endl;
+            texturedMaterials.push_back(i);
+            texPaths.push_back(std::move(texPath));
+        }
+    }
 
-            // 尝试加载纹理
-            sptr<Texture> texture = nullptr;
-
-            try {
-                texture = TextureManager::GetInstance().LoadTexture(texPath);
-            } catch (const std::exception& e) {
-                std::cerr << "[ObjLoader] 加载纹理失败: " << e.what() << std::endl;
-            }
-
-            if (texture) {
-                materialPtrs.push_back(std::make_shared<ShadowedBlinnPhongMaterial>(mat.name, texture)); // 创建材质球并存储
-                std::cout << "[ObjLoader] 材质 “" << mat.name << "” 的纹理加载成功: " << texPath << std::endl;
-            } else {
-                materialPtrs.push_back(std::make_shared<ShadowedBlinnPhongMaterial>(mat.name, nullptr)); // 如果加载失败，使用空纹理
-            }
+    vector<sptr<Texture>> loadedTextures = TextureManager::GetInstance().LoadTextures(texPaths);
+    vector<sptr<Texture>> materialTextures(materials.size()); // 按材质下标，没有纹理的为空
+    for (size_t i = 0; i < texturedMaterials.size(); ++i) {
+        materialTextures[texturedMaterials[i]] = loadedTextures[i];
+        if (loadedTextures[i]) {
+            std::cout << "[ObjLoader] 材质 “" << materials[texturedMaterials[i]].name << "” 的纹理加载成功: " << texPaths[i] << std::endl;
         }
     }
 
+    //* 解析形状，记录各自使用的材质
     vector<sptr<Shape>> outShapes;
-
+    vector<vector<Triangle>> meshes; // 各形状的三角形，图集打包与 LOD 生成之后才创建成只读网格资源
+    vector<int> shapeMaterialIds;
     for (const shape_t& shape : shapes) {
+        if (shape.mesh.material_ids.empty()) {
+            throw std::runtime_error("Shape " + shape.name + " has no material assigned.");
+        }
         sptr<Shape> out = std::make_shared<Shape>(); // 创建一个新的Object实例
         out->name = shape.name; // 设置名称
-        out->mesh = ParseMesh(shape.mesh, attrib); // 解析 mesh 并转换为 Triangle 数组
+        meshes.push_back(ParseMesh(shape.mesh, attrib)); // 解析 mesh 并转换为 Triangle 数组
+        shapeMaterialIds.push_back(shape.mesh.material_ids[0]); //! 获取第一个材质ID
+        std::cout << "[ObjLoader] 已加载形状: " << out->name << ", 顶点数: " << shape.mesh.indices.size() << std::endl;
+        outShapes.push_back(std::move(out)); // 将对象添加到列表中
+    }
 
-        if (shape.mesh.material_ids.size() > 0) {
-            int matId = shape.mesh.material_ids[0]; //! 获取第一个材质ID
-            if (matId >= 0 && matId < materials.size()) {
-                std::cout << "[ObjLoader] 使用材质: " << materials[matId].name << std::endl;
-                out->material = materialPtrs[matId]; // 设置材质球
-            } else {
-                std::cerr << "[ObjLoader] 无效的材质ID: " << matId << "，使用默认材质球" << std::endl;
-                out->material = std::make_shared<ShadowedBlinnPhongMaterial>("DefaultPreviewMaterial", nullptr); //* 使用默认材质
-            }
+    //* 创建材质球，可选地把小纹理打包进图集并合并只有纹理不同的材质
+    for (size_t i = 0; i < materials.size(); ++i) {
+        materialPtrs.push_back(std::make_shared<ShadowedBlinnPhongMaterial>(materials[i].name, materialTextures[i])); // 加载失败时为空纹理
+    }
+    if (options.packTextureAtlas) {
+        PackTextureAtlases(filename, options, materialTextures, meshes, shapeMaterialIds, materialPtrs);
+    }
+
+    for (size_t i = 0; i < outShapes.size(); ++i) {
+        int matId = shapeMaterialIds[i];
+        if (matId >= 0 && matId < (int)materials.size()) {
+            std::cout << "[ObjLoader] 形状 " << outShapes[i]->name << " 使用材质: " << materials[matId].name << std::endl;
+            outShapes[i]->SetMaterial(materialPtrs[matId]); // 设置材质球
         } else {
-            throw std::runtime_error("Shape " + shape.name + " has no material assigned.");
+            std::cerr << "[ObjLoader] 无效的材质ID: " << matId << "，使用默认材质球" << std::endl;
+            outShapes[i]->SetMaterial(std::make_shared<ShadowedBlinnPhongMaterial>("DefaultPreviewMaterial", nullptr)); //* 使用默认材质
         }
-        
-        std::cout << "[ObjLoader] 已加载形状: " << out->name << ", 顶点数: " << shape.mesh.indices.size() << std::endl;
-        outShapes.push_back(std::move(out)); // 将对象添加到列表中
+    }
+
+    //* 生成 LOD：放在图集打包之后，简化网格使用的是重映射后的 UV
+    vector<vector<MeshLod>> lods(outShapes.size());
+    if (options.generateLods) {
+        GenerateLods(options, outShapes, meshes, lods);
+    }
+
+    //* 创建网格资源，同时计算包围体
+    for (size_t i = 0; i < outShapes.size(); ++i) {
+        outShapes[i]->SetMesh(Mesh::Create(std::move(meshes[i]), std::move(lods[i])));
     }
 
     return std::make_shared<Model>(std::move(filename), std::move(outShapes));
 }
 
+void ObjLoader::GenerateLods(const ObjLoadOptions& options, const vector<sptr<Shape>>& shapes, const vector<vector<Triangle>>& meshes,
+                             vector<vector<MeshLod>>& lods) {
+    //? 内容相同的网格（如 OBJ 里重复的子网格）只简化、写缓存一次，其余复制结果；
+    //? 否则它们会被并行简化，同时写同一个缓存临时文件
+    vector<size_t> pending;
+    vector<std::pair<size_t, size_t>> duplicates; // (形状, 与它内容相同的待简化形状)
+    std::unordered_map<uint64_t, size_t> pendingByHash;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        if (meshes[i].size() < options.lodSettings.minTriangles) {
+            continue;
+        }
+        if (MeshLodCache::Load(meshes[i], options.lodSettings, lods[i])) {
+            std::cout << "[ObjLoader] 形状 " << shapes[i]->name << " 的 LOD 从缓存读取，共 " << lods[i].size() << " 级" << std::endl;
+            continue;
+        }
+        auto [it, inserted] = pendingByHash.try_emplace(MeshLodCache::HashMesh(meshes[i]), i);
+        if (inserted) {
+            pending.push_back(i);
+        } else {
+            duplicates.emplace_back(i, it->second);
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+#pragma omp parallel for schedule(dynamic)
+    for (int p = 0; p < (int)pending.size(); ++p) {
+        size_t i = pending[p];
+        lods[i] = MeshSimplifier::BuildLods(meshes[i], options.lodSettings);
+        MeshLodCache::Store(meshes[i], options.lodSettings, lods[i]);
+    }
+    if (!pending.empty()) {
+        float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "[ObjLoader] 为 " << pending.size() << " 个形状生成 LOD，耗时 " << ms << " ms" << std::endl;
+    }
+    for (auto [i, source] : duplicates) {
+        lods[i] = lods[source];
+        std::cout << "[ObjLoader] 形状 " << shapes[i]->name << " 与 " << shapes[source]->name << " 网格相同，复用其 LOD" << std::endl;
+    }
+    for (size_t i : pending) {
+        for (size_t level = 0; level < lods[i].size(); ++level) {
+            const MeshLod& lod = lods[i][level];
+            std::cout << "[ObjLoader] 形状 " << shapes[i]->name << " LOD" << level + 1 << ": " << lod.mesh.size()
+                      << " 个三角形，误差 " << lod.error << std::endl;
+        }
+    }
+}
+
+void ObjLoader::PackTextureAtlases(const string& filename, const ObjLoadOptions& options, const vector<sptr<Texture>>& materialTextures,
+                                   vector<vector<Triangle>>& meshes, const vector<int>& shapeMaterialIds, vector<sptr<IMaterial>>& materialPtrs) {
+    const size_t materialCount = materialTextures.size();
+
+    //* 1. 挑出可以打包的材质：纹理足够小，且使用它的所有形状 UV 都在 [0,1] 内（图集里的子纹理不能循环）
+    vector<bool> eligible(materialCount, false);
+    for (size_t m = 0; m < materialCount; ++m) {
+        const auto& texture = materialTextures[m];
+        eligible[m] = texture && !texture->IsVirtual() &&
+                      texture->GetWidth() <= options.maxPackedTextureSize && texture->GetHeight() <= options.maxPackedTextureSize;
+    }
+    constexpr float UV_EPSILON = 1e-4f;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        int matId = shapeMaterialIds[i];
+        if (matId < 0 || matId >= (int)materialCount || !eligible[matId]) {
+            continue;
+        }
+        for (const Triangle& tri : meshes[i]) {
+            for (const Vector2f& uv : tri.uv) {
+                if (uv.minCoeff() < -UV_EPSILON || uv.maxCoeff() > 1.0f + UV_EPSILON) {
+                    eligible[matId] = false;
+                }
+            }
+        }
+    }
+
+    //* 2. 同一张纹理只打包一次
+    vector<sptr<Texture>> packTextures;
+    vector<int> packIndex(materialCount, -1);
+    for (size_t m = 0; m < materialCount; ++m) {
+        if (!eligible[m]) {
+            continue;
+        }
+        auto it = std::find(packTextures.begin(), packTextures.end(), materialTextures[m]);
+        packIndex[m] = (int)(it - packTextures.begin());
+        if (it == packTextures.end()) {
+            packTextures.push_back(materialTextures[m]);
+        }
+    }
+    if (packTextures.size() < 2) {
+        return; // 只有一张纹理时打包没有意义
+    }
+
+    TextureAtlasResult packed = TextureAtlas::Pack(packTextures, options.maxAtlasSize, options.atlasPadding);
+
+    //* 3. 每张图集一个材质：加载器创建的材质除纹理外属性都相同，放进同一图集的材质直接合并
+    auto& manager = TextureManager::GetInstance();
+    vector<sptr<IMaterial>> atlasMaterials;
+    for (size_t a = 0; a < packed.atlases.size(); ++a) {
+        auto& atlas = packed.atlases[a];
+        atlas->SetFormat(manager.GetDefaultFormat());
+        string key = filename + "#atlas" + std::to_string(a);
+        manager.AddTexture(key, atlas);
+        atlasMaterials.push_back(std::make_shared<ShadowedBlinnPhongMaterial>("Atlas" + std::to_string(a), atlas));
+        std::cout << "[ObjLoader] 生成纹理图集 " << key << ": " << atlas->GetWidth() << 'x' << atlas->GetHeight() << std::endl;
+    }
+
+    //* 4. 把形状的 UV 换算到图集，并改用合并后的材质
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        int matId = shapeMaterialIds[i];
+        if (matId < 0 || matId >= (int)materialCount || packIndex[matId] < 0) {
+            continue;
+        }
+        const AtlasRegion& region = packed.regions[packIndex[matId]];
+        if (region.atlas < 0) {
+            continue;
+        }
+        for (Triangle& tri : meshes[i]) {
+            for (Vector2f& uv : tri.uv) {
+                uv = region.Remap(uv);
+            }
+        }
+    }
+    size_t mergedMaterials = 0;
+    for (size_t m = 0; m < materialCount; ++m) {
+        if (packIndex[m] >= 0 && packed.regions[packIndex[m]].atlas >= 0) {
+            materialPtrs[m] = atlasMaterials[packed.regions[packIndex[m]].atlas];
+            ++mergedMaterials;
+        }
+    }
+    std::cout << "[ObjLoader] " << packTextures.size() << " 张纹理打包进 " << packed.atlases.size() << " 张图集，"
+              << mergedMaterials << " 个材质合并为 " << atlasMaterials.size() << " 个" << std::endl;
+}
+
 // 解析tinyobj::mesh_t并转换为我们的Triangle数组对象
 vector<Triangle> ObjLoader::ParseMesh(const mesh_t& mesh, const attrib_t& attrib) {
     vector<Triangle> triangles;
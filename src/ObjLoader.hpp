@@ -3,12 +3,31 @@
 #include <tiny_obj_loader.h>
 #include "Render/Model.hpp"
 #include "Render/Shape.hpp"
+#include "Render/Texture.hpp"
 
 using namespace aries::model;
 
+// 导入选项
+struct ObjLoadOptions {
+    bool packTextureAtlas = false; // 把小纹理打包进共享图集，并合并只有纹理不同的材质
+    int maxPackedTextureSize = 512; // 宽高都不超过这个值的纹理才参与打包
+    int maxAtlasSize = 2048;        // 图集边长上限，放不下时开新图集
+    int atlasPadding = 8;           // 子纹理四周的边距（纹素），约前 3 级 mipmap 不会混入相邻子纹理
+    bool generateLods = true;       // 为三角形足够多的形状生成简化 LOD（优先读取磁盘缓存）
+    LodSettings lodSettings;
+};
+
 class ObjLoader {
 public:
-    static sptr<Model> LoadModel(const string& filename);
+    static sptr<Model> LoadModel(const string& filename, const ObjLoadOptions& options = {});
 private:
     static vector<Triangle> ParseMesh(const tinyobj::mesh_t& mesh, const tinyobj::attrib_t& attrib);
+
+    // 打包可以进图集的材质纹理，重映射相关形状网格的 UV，并把 materialPtrs 中被合并的材质替换为图集材质
+    static void PackTextureAtlases(const string& filename, const ObjLoadOptions& options, const vector<sptr<Texture>>& materialTextures,
+                                   vector<vector<Triangle>>& meshes, const vector<int>& shapeMaterialIds, vector<sptr<aries::material::IMaterial>>& materialPtrs);
+
+    // 为各形状的网格生成 LOD 写入 lods，命中缓存的直接读取，其余并行简化后写回缓存
+    static void GenerateLods(const ObjLoadOptions& options, const vector<sptr<Shape>>& shapes, const vector<vector<Triangle>>& meshes,
+                             vector<vector<MeshLod>>& lods);
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "Pipeline.hpp"
 #include "SharedConfig.hpp"
+#include "Render/TextureManager.hpp"
 
 #include <chrono>
 
@@ -32,55 +33,260 @@ namespace aries::render {
         lastFrameTime = currentFrameTime;
         frameTime = elapsed.count(); // 计算帧率
 
+        //* 本帧常量：摄像机矩阵、逆矩阵与视锥平面只在这里计算一次，之后各阶段都从 frame 读取
+        frame = FrameContext::Build(*cam, renderer->GetWidth(), renderer->GetHeight(), frame.frameIndex + 1);
+        renderer->BeginFrame(frame);
+
+        //* 遮挡缓冲：清空前先把上一帧的深度重投影进来
+        occlusionStats = {};
+        if (enableOcclusionCulling) {
+            auto t0 = std::chrono::steady_clock::now();
+            if (occlusionBuffer.GetWidth() != occlusionSettings.width || occlusionBuffer.GetHeight() != occlusionSettings.height) {
+                occlusionBuffer.Resize(occlusionSettings.width, occlusionSettings.height);
+            }
+            occlusionBuffer.Begin(frame.viewProjection);
+            if (occlusionSettings.reproject && hasPreviousFrame) {
+                const vector<float>& depth = renderer->GetDepthBuffer();
+                int w = renderer->GetWidth(), h = renderer->GetHeight();
+                occlusionStats.reprojectedPixels = occlusionBuffer.Reproject(w, h,
+                    [&](int x, int y) { return depth[x + (size_t)(h - y - 1) * w]; }, previousViewProjection);
+            }
+            occlusionStats.rasterMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        }
+        previousViewProjection = frame.viewProjection;
+        hasPreviousFrame = true;
+
         //* 清空
+        renderer->SetShadowMaskMode(enableShadow && scene->directionalShadow ? shadowMaskMode : shadow::ShadowMaskMode::Off);
         renderer->Clear();
 
         //shapeListMutex.lock_shared();
-        vector<sptr<Shape>> activeShapes;
 
-        for (auto& wk : shapeList) {
-            if (auto shape = wk.lock()) {
-                activeShapes.emplace_back(std::move(shape));
+        //* 同步形状存储与 BVH：移除已销毁的形状，只有模型变换、网格或材质变化过的行重新读取
+        shapeStore.Sync();
+        shapeBVH.Update(shapeStore);
+        renderQueue.Update(shapeStore);
+
+        auto makeVisible = [&](uint32_t row, bool inside) -> VisibleShape {
+            return {shapeStore.GetShape(row), shapeStore.GetMaterial(row), &shapeStore.GetModelMatrix(row), row, inside};
+        };
+
+        //* 视锥剔除
+        //? BVH 节点完全在视锥外时整棵子树跳过，完全在内时子树不再测试；
+        //? 世界包围盒与视锥相交的形状再用模型空间的包围体细分一次（旋转后的世界 AABB 偏松）；
+        //? 完全在内的形状跳过逐三角形的近远平面与视口检查
+        vector<VisibleShape> visibleShapes;
+        visibleShapes.reserve(shapeStore.Size());
+        insideShapeCount = 0;
+        bvhVisitedNodes = 0;
+        if (enableFrustumCulling) {
+            bvhVisitedNodes = shapeBVH.Query(frame.frustum, [&](const ShapeBVH::Node& leaf, bool inside) {
+                uint32_t row = shapeStore.RowOf(leaf.handle);
+                if (!shapeStore.GetMaterial(row)) {
+                    return;
+                }
+                if (!inside) {
+                    Frustum frustum = Frustum::FromMatrix(frame.viewProjection * shapeStore.GetModelMatrix(row));
+                    Frustum::TestResult result = frustum.Test(shapeStore.GetShape(row)->GetBounds());
+                    if (result == Frustum::TestResult::Outside) {
+                        return;
+                    }
+                    inside = result == Frustum::TestResult::Inside;
+                }
+                insideShapeCount += inside;
+                visibleShapes.push_back(makeVisible(row, inside));
+            });
+        } else {
+            for (uint32_t row = 0; row < shapeStore.Size(); ++row) {
+                if (shapeStore.GetMaterial(row)) {
+                    visibleShapes.push_back(makeVisible(row, false));
+                }
+            }
+        }
+        culledShapeCount = (int)(shapeStore.Size() - visibleShapes.size());
+
+        //* 遮挡剔除
+        if (enableOcclusionCulling) {
+            CullOccludedShapes(visibleShapes);
+        }
+
+        //* 选择 LOD：远处的形状用简化网格，顶点阶段与阴影绘制都受益
+        //? 遮挡物仍按原网格光栅化，简化网格不保证在原网格内侧
+        lodReducedShapes = 0;
+        lodSavedTriangles = 0;
+        for (auto& visible : visibleShapes) {
+            Shape& shape = *visible.shape;
+            SelectLod(shape, *visible.modelMatrix);
+            if (shape.lodIndex > 0) {
+                ++lodReducedShapes;
+                lodSavedTriangles += shape.GetTriangles().size() - shape.GetRenderMesh().size();
             }
         }
 
         //* 渲染阴影贴图
+        auto shadowStart = std::chrono::steady_clock::now();
         if (enableShadow) {
             if (scene->directionalShadow) {
-                scene->directionalShadow->UpdateShadowMap(activeShapes);
+                // 根据视野内的接收者与投射者适配光源投影
+                scene->directionalShadow->FitToScene(shapeBVH, frame);
+                frame.SetLight(scene->directionalShadow->GetLightViewMatrix(), scene->directionalShadow->GetLightProjectionMatrix());
+                vector<uint32_t> casters;
+                if (enableFrustumCulling) {
+                    //? 投射者可能在摄像机视野外，用光源视锥重新查询一次
+                    shapeBVH.Query(frame.lightFrustum, [&](const ShapeBVH::Node& leaf, bool) {
+                        uint32_t row = shapeStore.RowOf(leaf.handle);
+                        SelectLod(*shapeStore.GetShape(row), shapeStore.GetModelMatrix(row)); // 视野外的投射者也按到摄像机的距离选择
+                        casters.push_back(row);
+                    });
+                } else {
+                    casters.reserve(shapeStore.Size());
+                    for (uint32_t row = 0; row < shapeStore.Size(); ++row) {
+                        SelectLod(*shapeStore.GetShape(row), shapeStore.GetModelMatrix(row));
+                        casters.push_back(row);
+                    }
+                }
+                scene->directionalShadow->UpdateShadowMap(shapeStore, casters);
             }
         }
+        shadowPassTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - shadowStart).count();
 
-        //* 把形状按着色器类型分组
-        std::unordered_map<ShaderType, vector<sptr<Shape>>> shapeGroups;
-        for (auto& shape : activeShapes) {
-            if (shape->material) {
-                shapeGroups[shape->material->GetShaderType()].emplace_back(std::move(shape));
-            }
-        }
+        //* 排序：同一着色器的形状连续，着色器内按纹理、材质排列，材质内由近到远，同一网格与 LOD 相邻由渲染器合批为多实例绘制
+        renderQueue.Sort(visibleShapes, shapeStore, frame.view, enableDepthSort);
 
         // 统计三角形数量
         uint64_t tempCnt = 0;
 
-        //* 送入渲染器
-        for (auto [shaderType, shapes] : shapeGroups) {
-            //auto ret = renderer->VertexShaderWith<BlinnPhongShader>(shapes, scene, cam);
-            renderer->RenderWithShader(shaderType, shapes, tempCnt);
+        //* 送入渲染器，每段同一着色器的形状调用一次
+        for (size_t begin = 0; begin < visibleShapes.size();) {
+            ShaderType shaderType = visibleShapes[begin].material->GetShaderType();
+            size_t end = begin + 1;
+            while (end < visibleShapes.size() && visibleShapes[end].material->GetShaderType() == shaderType) {
+                ++end;
+            }
+            renderer->RenderWithShader(shaderType, std::span(visibleShapes).subspan(begin, end - begin), tempCnt);
+            begin = end;
         }
 
+        //* 启用阴影遮罩时，各分组只做了预深度，这里统一算遮罩并着色
+        renderer->ResolveDeferredShading();
+
         triangleCount = tempCnt; // 更新三角形计数
 
+        //* 按本帧的采样反馈调入/淘汰虚拟纹理页，此时已没有线程在采样
+        TextureManager::GetInstance().UpdateVirtualTextures();
+
         //* 绘制坐标系
         if (showCoordinateSystem) {
             renderer->DrawCoordinateSystem();
         }
 
+        //* 绘制包围盒
+        if (showBounds) {
+            debugLines.Clear();
+            debugLines.style.depthWrite = false; // 包围盒只做深度测试，不挡住之后画的线
+            for (const auto& visible : visibleShapes) {
+                if (shapeStore.HasBounds(visible.row)) {
+                    Vector3f color = visible.insideFrustum ? Vector3f(0.2f, 1.0f, 0.2f) : Vector3f(1.0f, 0.8f, 0.2f);
+                    debugLines.AddBox(shapeStore.GetWorldBox(visible.row), color);
+                }
+            }
+            renderer->DrawLines(debugLines);
+        }
+
         //shapeListMutex.unlock_shared();
 
         //* 交换CPU缓冲区
         //raster->SwapBuffers();
     }
 
+    void Pipeline::SelectLod(Shape& shape, const Matrix4f& modelMatrix) const {
+        const BoundingSphere& sphere = shape.GetBounds().sphere;
+        if (!enableLod || shape.GetLods().empty() || !sphere.IsValid()) {
+            shape.lodIndex = 0;
+            return;
+        }
+
+        //* 1. 包围球最近处到摄像机的距离，摄像机在球内或很近时直接用原网格
+        float maxScale = modelMatrix.block<3, 3>(0, 0).colwise().norm().maxCoeff(); // 含父模型缩放
+        Vector4f center = frame.view * modelMatrix * Vector4f(sphere.center.x(), sphere.center.y(), sphere.center.z(), 1.0f);
+        float distance = -center.z() - sphere.radius * maxScale; // 视图空间朝 -z 看
+        if (distance <= 1e-3f) {
+            shape.lodIndex = 0;
+            return;
+        }
+
+        //* 2. 从上一帧的级别出发：误差超出阈值就换细一级，下一级误差明显低于阈值才换粗一级
+        const float errorToPixels = maxScale * frame.pixelsPerUnit / distance;
+        auto projectedError = [&](int level) { return level == 0 ? 0.0f : shape.GetLods()[level - 1].error * errorToPixels; };
+        const int levelCount = (int)shape.GetLods().size();
+        int level = std::clamp(shape.lodIndex, 0, levelCount);
+        while (level > 0 && projectedError(level) > lodErrorPixels) {
+            --level;
+        }
+        while (level < levelCount && projectedError(level + 1) <= lodErrorPixels * (1.0f - lodHysteresis)) {
+            ++level;
+        }
+        shape.lodIndex = level;
+    }
+
+    void Pipeline::CullOccludedShapes(vector<VisibleShape>& visibleShapes) {
+        auto t0 = std::chrono::steady_clock::now();
+
+        //* 1. 投影每个形状的包围盒，挑出遮挡物：指定的形状，或屏幕面积足够大、三角形不多的形状
+        struct Candidate {
+            size_t index;
+            float area;
+        };
+        vector<ScreenBounds> screenBounds(visibleShapes.size());
+        vector<Candidate> occluders;
+        for (size_t i = 0; i < visibleShapes.size(); ++i) {
+            const Shape& shape = *visibleShapes[i].shape;
+            screenBounds[i] = ScreenBounds::Project(shape.GetBounds().box, frame.viewProjection * *visibleShapes[i].modelMatrix);
+            float area = screenBounds[i].valid ? screenBounds[i].Area() : 1.0f; // 越过近平面的形状离相机很近，按占满屏幕算
+            bool automatic = area >= occlusionSettings.minOccluderArea && (int)shape.GetTriangles().size() <= occlusionSettings.maxOccluderTriangles;
+            if (shape.occluder || automatic) {
+                occluders.push_back({i, shape.occluder ? std::numeric_limits<float>::max() : area});
+            }
+        }
+        std::sort(occluders.begin(), occluders.end(), [](const Candidate& a, const Candidate& b) { return a.area > b.area; });
+        if ((int)occluders.size() > occlusionSettings.maxOccluders) {
+            occluders.resize(std::max(occlusionSettings.maxOccluders, 0));
+        }
+
+        //* 2. 光栅化遮挡物
+        vector<char> isOccluder(visibleShapes.size(), 0);
+        for (const auto& occluder : occluders) {
+            const Shape& shape = *visibleShapes[occluder.index].shape;
+            occlusionBuffer.RasterizeOccluder(shape, *visibleShapes[occluder.index].modelMatrix);
+            isOccluder[occluder.index] = 1;
+            occlusionStats.occluderTriangles += shape.GetTriangles().size();
+        }
+        occlusionStats.occluders = (int)occluders.size();
+
+        auto t1 = std::chrono::steady_clock::now();
+
+        //* 3. 其余形状用屏幕包围矩形测试，被挡住的不进入顶点阶段
+        size_t kept = 0;
+        for (size_t i = 0; i < visibleShapes.size(); ++i) {
+            if (!isOccluder[i]) {
+                ++occlusionStats.testedShapes;
+                if (occlusionBuffer.IsOccluded(screenBounds[i])) {
+                    ++occlusionStats.occludedShapes;
+                    continue;
+                }
+            }
+            if (kept != i) {
+                visibleShapes[kept] = visibleShapes[i];
+            }
+            ++kept;
+        }
+        visibleShapes.resize(kept);
+
+        auto t2 = std::chrono::steady_clock::now();
+        occlusionStats.rasterMs += std::chrono::duration<float, std::milli>(t1 - t0).count();
+        occlusionStats.testMs = std::chrono::duration<float, std::milli>(t2 - t1).count();
+    }
+
     void Pipeline::Draw() {
         // 4. 提交并绘制
         raster->UploadToGPU();
@@ -90,9 +296,9 @@ namespace aries::render {
     void Pipeline::AddShape(std::weak_ptr<Shape> obj) {
         if (auto shape = obj.lock()) {
             //shapeListMutex.lock();
-            shapeList.push_back(shape);
+            shapeBVH.Insert(shapeStore.Add(shape), shapeStore);
             //shapeListMutex.unlock();
-            std::cout << "[Pipeline] 添加形状：" << shape->name << "，三角形数：" << shape->mesh.size()
+            std::cout << "[Pipeline] 添加形状：" << shape->name << "，三角形数：" << shape->GetTriangles().size()
                     << '\n';
         } else {
             std::cerr << "[Pipeline] 添加形状失败：形状已被销毁或无效。\n";
@@ -101,11 +307,7 @@ namespace aries::render {
 
     void Pipeline::CleanUpUnusedShapes() {
         //shapeListMutex.lock();
-        shapeList.erase(
-            std::remove_if(shapeList.begin(),
-                        shapeList.end(),
-                        [](const std::weak_ptr<Shape>& shape) { return shape.expired(); }),
-            shapeList.end());
+        shapeStore.RemoveExpired(); // BVH 中对应的叶子句柄随之失效，下一帧 Update 时移除
         //shapeListMutex.unlock();
     }
 }
\ No newline at end of file
@@ -7,25 +7,51 @@
 #include "Render/CommonHeader.hpp"
 
 #include "Render/Camera.hpp"
+#include "Render/FrameContext.hpp"
+#include "Render/LineBatch.hpp"
 #include "Render/Raster.hpp"
+#include "Render/OcclusionBuffer.hpp"
 #include "Render/Renderer.hpp"
+#include "Render/RenderQueue.hpp"
 #include "Render/Shape.hpp"
+#include "Render/ShapeBVH.hpp"
+#include "Render/ShapeStore.hpp"
 
 using namespace aries::scene;
 
 namespace aries::render {
     class Pipeline {
     public:
-        vector<std::weak_ptr<Shape>> shapeList; // 对象列表，弱引用
+        ShapeStore shapeStore; // 形状的按列存储（模型矩阵、世界包围盒、网格、材质），不持有形状，形状销毁后自动移除
+        ShapeBVH shapeBVH; // 形状世界包围盒的层次结构，用于视锥查询（与 shapeStore 一起通过 AddShape 加入）
+        RenderQueue renderQueue; // 可见形状的绘制顺序，排序键随 shapeStore 的状态版本更新
         sptr<Raster> raster;
         sptr<Renderer> renderer;
 
         //std::shared_mutex shapeListMutex; // 保护shapeList的互斥锁，避免渲染线程和主线程冲突
         bool showCoordinateSystem = true; // 是否显示坐标系
+        bool showBounds = false; // 是否画出可见形状的世界包围盒（完全在视锥内为绿色，其余为黄色）
         bool enableShadow = true; // 是否启用阴影
+        bool enableFrustumCulling = true; // 是否按 BVH 与包围体做视锥剔除
+        bool enableOcclusionCulling = true; // 是否用大遮挡物的低分辨率深度做遮挡剔除
+        OcclusionCullingSettings occlusionSettings;
+        OcclusionBuffer occlusionBuffer;
+        bool enableLod = true; // 是否按屏幕误差为有 LOD 的形状选择简化网格
+        float lodErrorPixels = 1.0f; // 允许的简化误差投影到屏幕上的像素数
+        float lodHysteresis = 0.25f; // 切换到更粗一级时误差须低于 lodErrorPixels * (1 - lodHysteresis)，避免在阈值附近来回切换
+        bool enableDepthSort = true; // 渲染队列在同一材质内按深度由近到远排序
+        shadow::ShadowMaskMode shadowMaskMode = shadow::ShadowMaskMode::Off; // 屏幕空间阴影遮罩模式
 
         uint64_t triangleCount = 0; // 三角形计数
+        int culledShapeCount = 0; // 本帧被视锥剔除的形状数
+        int insideShapeCount = 0; // 本帧完全在视锥内、走快速路径的形状数
+        int bvhVisitedNodes = 0; // 本帧摄像机视锥查询访问的 BVH 节点数
+        OcclusionStats occlusionStats; // 本帧遮挡剔除统计
+        int lodReducedShapes = 0; // 本帧使用简化网格绘制的可见形状数
+        uint64_t lodSavedTriangles = 0; // 本帧可见形状因 LOD 少绘制的三角形数
         float frameTime = 0.0f; // 帧时间
+        float shadowPassTime = 0.0f; // 阴影贴图绘制耗时（毫秒）
+        FrameContext frame; // 本帧的摄像机与光源常量，Render 开始时计算，渲染器在本帧内引用它
 
         Pipeline();
 
@@ -38,5 +64,16 @@ namespace aries::render {
         void AddShape(std::weak_ptr<Shape> obj);
 
         void CleanUpUnusedShapes();
+
+    private:
+        Matrix4f previousViewProjection = Matrix4f::Identity(); // 上一帧的 投影*视图，用于重投影深度
+        bool hasPreviousFrame = false;
+        LineBatch debugLines; // 包围盒等调试线段，每帧重新填充
+
+        // 按包围球最近处的简化误差像素数为形状选择 LOD 级别，带滞回
+        void SelectLod(Shape& shape, const Matrix4f& modelMatrix) const;
+
+        // 光栅化本帧的遮挡物并剔除被挡住的形状，遮挡物本身保留
+        void CullOccludedShapes(vector<VisibleShape>& visibleShapes);
     };
 }
\ No newline at end of file
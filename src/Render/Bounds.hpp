@@ -0,0 +1,182 @@
+/// FileName: Bounds.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Triangle.hpp"
+
+#include <limits>
+
+namespace aries::model {
+    // 轴对齐包围盒
+    struct AABB {
+        Vector3f min = Vector3f::Constant(std::numeric_limits<float>::max());
+        Vector3f max = Vector3f::Constant(std::numeric_limits<float>::lowest());
+
+        inline bool IsValid() const {
+            return min.x() <= max.x() && min.y() <= max.y() && min.z() <= max.z();
+        }
+
+        inline void Expand(const Vector3f& p) {
+            min = min.cwiseMin(p);
+            max = max.cwiseMax(p);
+        }
+
+        inline void Expand(const AABB& other) {
+            min = min.cwiseMin(other.min);
+            max = max.cwiseMax(other.max);
+        }
+
+        inline Vector3f Center() const { return (min + max) * 0.5f; }
+
+        inline Vector3f Extents() const { return (max - min) * 0.5f; }
+
+        // 表面积的一半，用作 BVH 的插入代价
+        inline float HalfArea() const {
+            Vector3f d = max - min;
+            return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+        }
+
+        inline bool Contains(const AABB& other) const {
+            return min.x() <= other.min.x() && min.y() <= other.min.y() && min.z() <= other.min.z() &&
+                   max.x() >= other.max.x() && max.y() >= other.max.y() && max.z() >= other.max.z();
+        }
+
+        static AABB Union(const AABB& a, const AABB& b) {
+            AABB result = a;
+            result.Expand(b);
+            return result;
+        }
+
+        // 第 i 个角点（i ∈ [0, 8)，按位选择 min/max）
+        inline Vector3f Corner(int i) const {
+            return Vector3f(
+                (i & 1) ? max.x() : min.x(),
+                (i & 2) ? max.y() : min.y(),
+                (i & 4) ? max.z() : min.z()
+            );
+        }
+
+        inline bool Overlaps(const AABB& other) const {
+            return min.x() <= other.max.x() && max.x() >= other.min.x() &&
+                   min.y() <= other.max.y() && max.y() >= other.min.y() &&
+                   min.z() <= other.max.z() && max.z() >= other.min.z();
+        }
+
+        // 经仿射矩阵变换后的包围盒（Arvo 方法，只需一次遍历矩阵元素，不用变换 8 个角点）
+        AABB Transformed(const Matrix4f& m) const {
+            if (!IsValid()) return *this;
+            AABB result;
+            for (int i = 0; i < 3; ++i) {
+                result.min[i] = result.max[i] = m(i, 3);
+                for (int j = 0; j < 3; ++j) {
+                    float a = m(i, j) * min[j];
+                    float b = m(i, j) * max[j];
+                    result.min[i] += std::min(a, b);
+                    result.max[i] += std::max(a, b);
+                }
+            }
+            return result;
+        }
+    };
+
+    // 包围球
+    struct BoundingSphere {
+        Vector3f center = Vector3f::Zero();
+        float radius = -1.0f; // 负数表示无效
+
+        inline bool IsValid() const { return radius >= 0.0f; }
+    };
+
+    // 形状的包围体（模型空间），加载时计算一次
+    struct Bounds {
+        AABB box;
+        BoundingSphere sphere;
+
+        // 从三角形列表计算包围盒与包围球（球心取包围盒中心）
+        static Bounds FromTriangles(const vector<Triangle>& mesh) {
+            Bounds bounds;
+            for (const auto& tri : mesh) {
+                bounds.box.Expand(tri.vertex[0]);
+                bounds.box.Expand(tri.vertex[1]);
+                bounds.box.Expand(tri.vertex[2]);
+            }
+            if (!bounds.box.IsValid()) {
+                return bounds;
+            }
+
+            bounds.sphere.center = bounds.box.Center();
+            float radiusSq = 0.0f;
+            for (const auto& tri : mesh) {
+                for (int k = 0; k < 3; ++k) {
+                    radiusSq = std::max(radiusSq, (tri.vertex[k] - bounds.sphere.center).squaredNorm());
+                }
+            }
+            bounds.sphere.radius = std::sqrt(radiusSq);
+            return bounds;
+        }
+    };
+
+    // 视锥体（6 个平面，法线朝内），从 投影*视图(*模型) 矩阵中提取
+    struct Frustum {
+        enum class TestResult {
+            Outside,   // 完全在外
+            Intersect, // 与边界相交
+            Inside,    // 完全在内
+        };
+
+        Vector4f planes[6]; // 左、右、下、上、近、远
+
+        // Gribb-Hartmann 方法提取裁剪平面（OpenGL 风格 NDC，z ∈ [-1, 1]）
+        static Frustum FromMatrix(const Matrix4f& m) {
+            Frustum f;
+            Vector4f r0 = m.row(0), r1 = m.row(1), r2 = m.row(2), r3 = m.row(3);
+            f.planes[0] = r3 + r0;
+            f.planes[1] = r3 - r0;
+            f.planes[2] = r3 + r1;
+            f.planes[3] = r3 - r1;
+            f.planes[4] = r3 + r2;
+            f.planes[5] = r3 - r2;
+            for (auto& p : f.planes) {
+                p /= p.head<3>().norm();
+            }
+            return f;
+        }
+
+        // 测试包围盒与视锥体的关系
+        TestResult Test(const AABB& box) const {
+            if (!box.IsValid()) return TestResult::Outside;
+            Vector3f center = box.Center();
+            Vector3f extents = box.Extents();
+            bool inside = true;
+            for (const auto& p : planes) {
+                // 包围盒在平面法线上的投影半径
+                float r = extents.x() * std::abs(p.x()) + extents.y() * std::abs(p.y()) + extents.z() * std::abs(p.z());
+                float d = p.head<3>().dot(center) + p.w();
+                if (d < -r) return TestResult::Outside;
+                if (d < r) inside = false;
+            }
+            return inside ? TestResult::Inside : TestResult::Intersect;
+        }
+
+        // 测试包围球与视锥体的关系
+        TestResult Test(const BoundingSphere& sphere) const {
+            if (!sphere.IsValid()) return TestResult::Outside;
+            bool inside = true;
+            for (const auto& p : planes) {
+                float d = p.head<3>().dot(sphere.center) + p.w();
+                if (d < -sphere.radius) return TestResult::Outside;
+                if (d < sphere.radius) inside = false;
+            }
+            return inside ? TestResult::Inside : TestResult::Intersect;
+        }
+
+        // 先用包围球快速判定，球与边界相交时再用更紧的包围盒细分
+        TestResult Test(const Bounds& bounds) const {
+            TestResult result = Test(bounds.sphere);
+            return result == TestResult::Intersect ? Test(bounds.box) : result;
+        }
+    };
+}
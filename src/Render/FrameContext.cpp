@@ -0,0 +1,77 @@
+/// FileName: FrameContext.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "FrameContext.hpp"
+
+namespace aries::render {
+    FrameContext FrameContext::Build(Camera& camera, int width, int height, uint64_t frameIndex) {
+        camera.ApplyEluaAngle(); // 应用欧拉角到摄像机方向和上向量
+
+        FrameContext frame;
+        frame.frameIndex = frameIndex;
+        frame.width = width;
+        frame.height = height;
+        frame.viewport = BuildViewportMatrix(width, height);
+
+        frame.cameraPosition = camera.Position.head<3>();
+        frame.cameraDirection = camera.Direction;
+        frame.nearPlane = camera.Near;
+        frame.farPlane = camera.Far;
+        frame.view = BuildViewMatrix(camera);
+        frame.projection = BuildProjectionMatrix(camera);
+        frame.viewProjection = frame.projection * frame.view;
+        frame.viewportProjection = frame.viewport * frame.projection;
+        frame.invView = frame.view.inverse();
+        frame.invViewProjection = frame.viewProjection.inverse();
+        frame.frustum = model::Frustum::FromMatrix(frame.viewProjection);
+        frame.pixelsPerUnit = frame.projection(1, 1) * height * 0.5f;
+        return frame;
+    }
+
+    void FrameContext::SetLight(const Matrix4f& lightViewMatrix, const Matrix4f& lightProjectionMatrix) {
+        hasLight = true;
+        lightView = lightViewMatrix;
+        lightProjection = lightProjectionMatrix;
+        lightViewProjection = lightProjection * lightView;
+        lightFrustum = model::Frustum::FromMatrix(lightViewProjection);
+    }
+
+    Matrix4f FrameContext::BuildViewMatrix(const Camera& c) {
+        // 将摄像机移动到原点，然后使用旋转矩阵的正交性让摄像机摆正
+        Matrix4f move; // 移动矩阵
+        Vector3f right; // 摄像机的x轴
+        Matrix4f rotateT; // 旋转矩阵的转置矩阵
+
+        move << 1, 0, 0, -c.Position.x(), 0, 1, 0, -c.Position.y(), 0, 0, 1, -c.Position.z(), 0, 0, 0,
+            1;
+
+        right = c.Direction.cross(c.Up);
+
+        rotateT << right.x(), right.y(), right.z(), 0, c.Up.x(), c.Up.y(), c.Up.z(), 0,
+            -c.Direction.x(), -c.Direction.y(), -c.Direction.z(), 0, 0, 0, 0, 1;
+
+        return rotateT * move;
+    }
+
+    Matrix4f FrameContext::BuildProjectionMatrix(const Camera& c) {
+        float radFov;
+        Matrix4f frustum;
+
+        radFov = ToRadian(c.Fov);
+
+        frustum << 1 / (c.AspectRatio * tan(radFov / 2)), 0, 0, 0, 0, 1 / tan(radFov / 2), 0, 0, 0, 0,
+            -(c.Far + c.Near) / (c.Far - c.Near), -(2 * c.Far * c.Near) / (c.Far - c.Near), 0, 0, -1, 0;
+
+        return frustum;
+    }
+
+    Matrix4f FrameContext::BuildViewportMatrix(int width, int height) {
+        Matrix4f viewport;
+        viewport << width / 2., 0, 0, width / 2.,
+                    0, height / 2., 0, height / 2.,
+                    0, 0, 1, 0,
+                    0, 0, 0, 1;
+        return viewport;
+    }
+}
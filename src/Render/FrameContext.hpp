@@ -0,0 +1,54 @@
+/// FileName: FrameContext.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 每帧的摄像机与光源常量，帧开始时计算一次，各阶段（剔除、阴影、顶点、画线、遮罩）共用
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Bounds.hpp"
+#include "Camera.hpp"
+
+namespace aries::render {
+    struct FrameContext {
+        uint64_t frameIndex = 0; // 帧序号，从 1 开始
+
+        //* 视口
+        int width = 0;
+        int height = 0;
+        Matrix4f viewport = Matrix4f::Identity(); // NDC → 屏幕像素
+
+        //* 摄像机
+        Vector3f cameraPosition = Vector3f::Zero();
+        Vector3f cameraDirection = Vector3f(0.0f, 0.0f, -1.0f);
+        float nearPlane = 0.1f;
+        float farPlane = 100.0f;
+        Matrix4f view = Matrix4f::Identity();                // 世界 → 视图
+        Matrix4f projection = Matrix4f::Identity();          // 视图 → 裁剪
+        Matrix4f viewProjection = Matrix4f::Identity();      // 世界 → 裁剪
+        Matrix4f viewportProjection = Matrix4f::Identity();  // 视图 → 屏幕（未做透视除法），画线用
+        Matrix4f invView = Matrix4f::Identity();
+        Matrix4f invViewProjection = Matrix4f::Identity();   // 由 NDC 还原世界坐标
+        model::Frustum frustum;                              // 世界空间视锥平面
+        float pixelsPerUnit = 1.0f; // 视图空间距离 1 处一个单位长度对应的像素数
+
+        //* 光源，阴影适配之后由 SetLight 填入
+        bool hasLight = false;
+        Matrix4f lightView = Matrix4f::Identity();
+        Matrix4f lightProjection = Matrix4f::Identity();
+        Matrix4f lightViewProjection = Matrix4f::Identity();
+        model::Frustum lightFrustum;
+
+        // 按摄像机当前状态计算摄像机相关的常量
+        //? 摄像机的欧拉角在这里应用到方向与上向量，每帧只做一次
+        static FrameContext Build(Camera& camera, int width, int height, uint64_t frameIndex);
+
+        void SetLight(const Matrix4f& lightViewMatrix, const Matrix4f& lightProjectionMatrix);
+
+        static Matrix4f BuildViewMatrix(const Camera& camera);
+
+        static Matrix4f BuildProjectionMatrix(const Camera& camera);
+
+        static Matrix4f BuildViewportMatrix(int width, int height);
+    };
+}
@@ -0,0 +1,81 @@
+/// FileName: LineBatch.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 线段批次：收集一帧内要画的线段（坐标系、包围盒、线框等），由渲染器一次变换、裁剪并并行光栅化
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Bounds.hpp"
+#include "Triangle.hpp"
+
+namespace aries::render {
+    // 线段绘制设置，对整个批次生效
+    struct LineStyle {
+        float width = 1.0f;      // 线宽（像素）
+        bool antiAlias = false;  // 按像素到线段中心线的距离算覆盖率，与帧缓冲中的颜色混合
+        bool depthTest = true;   // 与场景深度比较，被挡住的像素不画
+        bool depthWrite = true;  // 画出的像素写入深度；抗锯齿时只有覆盖率过半的像素写入
+    };
+
+    class LineBatch {
+    public:
+        LineStyle style;
+
+        // 添加一条世界空间线段
+        inline void Add(const Vector3f& start, const Vector3f& end, const Vector3f& color) {
+            m_points.emplace_back(start.x(), start.y(), start.z(), 1.0f);
+            m_points.emplace_back(end.x(), end.y(), end.z(), 1.0f);
+            m_colors.push_back(color);
+        }
+
+        // 添加包围盒的 12 条棱
+        void AddBox(const model::AABB& box, const Vector3f& color) {
+            if (!box.IsValid()) {
+                return;
+            }
+            //? 角点编号的三个位分别选择 x/y/z 的 min/max，只差一位的两个角点之间是一条棱
+            for (int i = 0; i < 8; ++i) {
+                for (int axis = 1; axis < 8; axis <<= 1) {
+                    if (!(i & axis)) {
+                        Add(box.Corner(i), box.Corner(i | axis), color);
+                    }
+                }
+            }
+        }
+
+        // 添加网格的线框，modelMatrix 把网格变换到世界空间；共用的边会画两次
+        void AddWireframe(const vector<Triangle>& mesh, const Matrix4f& modelMatrix, const Vector3f& color) {
+            m_points.reserve(m_points.size() + mesh.size() * 6);
+            m_colors.reserve(m_colors.size() + mesh.size() * 3);
+            for (const auto& tri : mesh) {
+                Vector3f v[3];
+                for (int k = 0; k < 3; ++k) {
+                    v[k] = (modelMatrix * Vector4f(tri.vertex[k].x(), tri.vertex[k].y(), tri.vertex[k].z(), 1.0f)).head<3>();
+                }
+                Add(v[0], v[1], color);
+                Add(v[1], v[2], color);
+                Add(v[2], v[0], color);
+            }
+        }
+
+        inline void Clear() {
+            m_points.clear();
+            m_colors.clear();
+        }
+
+        inline size_t Size() const { return m_colors.size(); }
+
+        inline bool Empty() const { return m_colors.empty(); }
+
+        // 端点，第 i 条线段为 [2i, 2i + 1]
+        const vector<Vector4f>& GetPoints() const { return m_points; }
+
+        const Vector3f& GetColor(size_t i) const { return m_colors[i]; }
+
+    private:
+        //? 端点以齐次坐标连续存放，可以直接映射成 4×2N 矩阵，一次矩阵乘法变换所有端点
+        vector<Vector4f> m_points;
+        vector<Vector3f> m_colors;
+    };
+}
@@ -0,0 +1,36 @@
+/// FileName: MappedFile.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 只读内存映射文件（Windows 使用 CreateFileMapping，其他平台使用 mmap）
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class MappedFile {
+public:
+    // 以只读方式映射整个文件，失败（不存在、为空、映射出错）时返回 nullptr
+    static std::unique_ptr<MappedFile> Open(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射起始地址按页对齐
+    inline const uint8_t* Data() const { return data; }
+
+    inline size_t Size() const { return size; }
+
+private:
+    MappedFile() = default;
+
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -8,6 +8,7 @@ namespace aries::material {
     class IMaterial { 
     public:
         virtual ShaderType GetShaderType() const = 0; // 获取着色器类型
+        virtual const Texture* GetTexture() const = 0; // 获取主纹理，没有时为空；渲染队列按它排序
         virtual ~IMaterial() = default;
     };
 
@@ -30,6 +31,14 @@ namespace aries::material {
             return ShaderBase<ShaderT>::GetType();
         }
 
+        const Texture* GetTexture() const override {
+            if constexpr (requires { property.texture.get(); }) {
+                return property.texture.get();
+            } else {
+                return nullptr;
+            }
+        }
+
         /* shader_t& GetShader() const {
             return *shader;
         }*/
@@ -0,0 +1,30 @@
+/// FileName: Mesh.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 只读网格资源，由多个形状共享
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Triangle.hpp"
+#include "Bounds.hpp"
+#include "MeshSimplifier.hpp"
+
+namespace aries::model {
+    // 网格资源：三角形、模型空间包围体与简化 LOD
+    //? 创建后不再修改，形状通过 sptr<const Mesh> 引用，复制模型或实例化只增加引用计数
+    struct Mesh {
+        vector<Triangle> triangles;
+        Bounds bounds;
+        vector<MeshLod> lods; // 逐级简化的网格（不含原网格），误差递增
+
+        // 创建网格资源并计算包围体
+        static sptr<const Mesh> Create(vector<Triangle> triangles, vector<MeshLod> lods = {}) {
+            auto mesh = std::make_shared<Mesh>();
+            mesh->triangles = std::move(triangles);
+            mesh->bounds = Bounds::FromTriangles(mesh->triangles);
+            mesh->lods = std::move(lods);
+            return mesh;
+        }
+    };
+}
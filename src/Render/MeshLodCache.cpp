@@ -0,0 +1,215 @@
+/// FileName: MeshLodCache.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "MeshLodCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace aries::model {
+    namespace {
+        constexpr char CACHE_MAGIC[8] = {'A', 'R', 'L', 'O', 'D', '\0', '\0', '\0'};
+        constexpr uint32_t CACHE_VERSION = 1;
+        constexpr size_t FLOATS_PER_TRIANGLE = 24; // 3 个顶点 × (位置 3 + 法线 3 + UV 2)
+
+        // 文件头，紧跟 levelCount 个 CacheLevel，再依次存放各级三角形
+        struct CacheHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t levelCount;
+            uint64_t meshHash;
+            uint64_t sourceTriangles;
+            int32_t levels;
+            float reduction;
+            uint64_t minTriangles;
+            float minReduction;
+            uint32_t reserved;
+        };
+
+        struct CacheLevel {
+            uint64_t triangleCount;
+            float error;
+            uint32_t reserved;
+        };
+
+        string& CacheDirectory() {
+            static string directory = "cache/meshes";
+            return directory;
+        }
+
+        bool& CacheEnabled() {
+            static bool enabled = true;
+            return enabled;
+        }
+
+        void PackTriangle(const Triangle& tri, float* out) {
+            for (int k = 0; k < 3; ++k) {
+                std::memcpy(out + k * 8, tri.vertex[k].data(), sizeof(float) * 3);
+                std::memcpy(out + k * 8 + 3, tri.normal[k].data(), sizeof(float) * 3);
+                std::memcpy(out + k * 8 + 6, tri.uv[k].data(), sizeof(float) * 2);
+            }
+        }
+
+        void UnpackTriangle(const float* in, Triangle& tri) {
+            for (int k = 0; k < 3; ++k) {
+                std::memcpy(tri.vertex[k].data(), in + k * 8, sizeof(float) * 3);
+                std::memcpy(tri.normal[k].data(), in + k * 8 + 3, sizeof(float) * 3);
+                std::memcpy(tri.uv[k].data(), in + k * 8 + 6, sizeof(float) * 2);
+            }
+        }
+
+        bool SameSettings(const CacheHeader& header, const LodSettings& settings) {
+            return header.levels == settings.levels && header.reduction == settings.reduction &&
+                   header.minTriangles == settings.minTriangles && header.minReduction == settings.minReduction;
+        }
+    }
+
+    void MeshLodCache::SetDirectory(const string& directory) {
+        CacheDirectory() = directory;
+    }
+
+    const string& MeshLodCache::GetDirectory() {
+        return CacheDirectory();
+    }
+
+    void MeshLodCache::SetEnabled(bool enabled) {
+        CacheEnabled() = enabled;
+    }
+
+    bool MeshLodCache::IsEnabled() {
+        return CacheEnabled();
+    }
+
+    uint64_t MeshLodCache::HashMesh(const vector<Triangle>& mesh) {
+        // FNV-1a 64 位，按打包后的浮点数逐个混入
+        uint64_t hash = 14695981039346656037ull;
+        float packed[FLOATS_PER_TRIANGLE];
+        for (const auto& tri : mesh) {
+            PackTriangle(tri, packed);
+            for (float value : packed) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                hash ^= bits;
+                hash *= 1099511628211ull;
+            }
+        }
+        return hash;
+    }
+
+    string MeshLodCache::CacheFilePath(uint64_t meshHash, const LodSettings& settings) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "%016llx_%d_%03d.alod", (unsigned long long)meshHash, settings.levels,
+                      (int)(settings.reduction * 100.0f + 0.5f));
+        return (fs::path(CacheDirectory()) / name).string();
+    }
+
+    bool MeshLodCache::Load(const vector<Triangle>& mesh, const LodSettings& settings, vector<MeshLod>& lods) {
+        if (!CacheEnabled()) {
+            return false;
+        }
+        const uint64_t meshHash = HashMesh(mesh);
+        std::ifstream in(CacheFilePath(meshHash, settings), std::ios::binary);
+        if (!in) {
+            return false;
+        }
+
+        //* 1. 校验文件头：内容哈希、三角形数与生成设置都要一致
+        CacheHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+            header.meshHash != meshHash || header.sourceTriangles != mesh.size() || !SameSettings(header, settings) ||
+            header.levelCount > (uint32_t)std::max(settings.levels, 0)) {
+            return false;
+        }
+        vector<CacheLevel> levels(header.levelCount);
+        if (!in.read(reinterpret_cast<char*>(levels.data()), levels.size() * sizeof(CacheLevel))) {
+            return false;
+        }
+
+        //* 2. 读取各级三角形
+        vector<MeshLod> result(levels.size());
+        vector<float> packed;
+        for (size_t i = 0; i < levels.size(); ++i) {
+            if (levels[i].triangleCount > mesh.size()) {
+                return false;
+            }
+            packed.resize(levels[i].triangleCount * FLOATS_PER_TRIANGLE);
+            if (!in.read(reinterpret_cast<char*>(packed.data()), packed.size() * sizeof(float))) {
+                return false; // 文件被截断
+            }
+            result[i].error = levels[i].error;
+            result[i].mesh.resize(levels[i].triangleCount);
+            for (size_t t = 0; t < result[i].mesh.size(); ++t) {
+                UnpackTriangle(packed.data() + t * FLOATS_PER_TRIANGLE, result[i].mesh[t]);
+            }
+        }
+        lods = std::move(result);
+        return true;
+    }
+
+    bool MeshLodCache::Store(const vector<Triangle>& mesh, const LodSettings& settings, const vector<MeshLod>& lods) {
+        if (!CacheEnabled()) {
+            return false;
+        }
+        std::error_code ec;
+        fs::create_directories(CacheDirectory(), ec);
+        if (ec) {
+            std::cout << "[MeshLodCache] 无法创建缓存目录: " << CacheDirectory() << std::endl;
+            return false;
+        }
+
+        //* 1. 填写文件头与级别表
+        CacheHeader header{};
+        std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header.version = CACHE_VERSION;
+        header.levelCount = (uint32_t)lods.size();
+        header.meshHash = HashMesh(mesh);
+        header.sourceTriangles = mesh.size();
+        header.levels = settings.levels;
+        header.reduction = settings.reduction;
+        header.minTriangles = settings.minTriangles;
+        header.minReduction = settings.minReduction;
+        vector<CacheLevel> levels;
+        levels.reserve(lods.size());
+        for (const auto& lod : lods) {
+            levels.push_back({(uint64_t)lod.mesh.size(), lod.error, 0});
+        }
+
+        //* 2. 写临时文件，成功后替换正式文件
+        string cachePath = CacheFilePath(header.meshHash, settings);
+        string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(CacheLevel));
+            vector<float> packed;
+            for (const auto& lod : lods) {
+                packed.resize(lod.mesh.size() * FLOATS_PER_TRIANGLE);
+                for (size_t t = 0; t < lod.mesh.size(); ++t) {
+                    PackTriangle(lod.mesh[t], packed.data() + t * FLOATS_PER_TRIANGLE);
+                }
+                out.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(float));
+            }
+            if (!out) {
+                out.close();
+                fs::remove(tempPath, ec);
+                return false;
+            }
+        }
+        fs::rename(tempPath, cachePath, ec);
+        if (ec) {
+            fs::remove(tempPath, ec);
+            return false;
+        }
+        return true;
+    }
+}
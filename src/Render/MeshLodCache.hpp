@@ -0,0 +1,34 @@
+/// FileName: MeshLodCache.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 简化后 LOD 网格的磁盘缓存，按原网格内容与生成设置查找
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "MeshSimplifier.hpp"
+
+namespace aries::model {
+    class MeshLodCache {
+    public:
+        // 缓存文件所在目录，默认 "cache/meshes"（相对工作目录）
+        static void SetDirectory(const string& directory);
+        static const string& GetDirectory();
+
+        static void SetEnabled(bool enabled);
+        static bool IsEnabled();
+
+        // 按原网格内容哈希与设置查找缓存，命中时写入 lods 并返回 true
+        //? 键取网格内容而不是源文件，图集打包改写 UV 后的网格也能命中，改了模型文件的形状自然失效
+        static bool Load(const vector<Triangle>& mesh, const LodSettings& settings, vector<MeshLod>& lods);
+
+        // 写入缓存，写临时文件后再替换，中途失败不会留下半个文件；lods 为空时也写入，之后不再重复尝试简化
+        static bool Store(const vector<Triangle>& mesh, const LodSettings& settings, const vector<MeshLod>& lods);
+
+        // 网格内容哈希，也是缓存文件名的一部分；内容相同的网格哈希相同
+        static uint64_t HashMesh(const vector<Triangle>& mesh);
+
+    private:
+        static string CacheFilePath(uint64_t meshHash, const LodSettings& settings);
+    };
+}
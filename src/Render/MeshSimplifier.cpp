@@ -0,0 +1,346 @@
+/// FileName: MeshSimplifier.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "MeshSimplifier.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace aries::model {
+    namespace {
+        struct Vertex {
+            Vector3f position;
+            Vector3f normal;
+            Vector2f uv;
+        };
+
+        // 按字节比较的键，焊接时 -0.0 与 0.0 视为不同，不影响正确性
+        template<size_t N>
+        struct FloatKey {
+            float values[N];
+
+            bool operator==(const FloatKey& other) const {
+                return std::memcmp(values, other.values, sizeof(values)) == 0;
+            }
+        };
+
+        template<size_t N>
+        struct FloatKeyHash {
+            size_t operator()(const FloatKey<N>& key) const {
+                uint64_t hash = 14695981039346656037ull;
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(key.values);
+                for (size_t i = 0; i < sizeof(key.values); ++i) {
+                    hash ^= bytes[i];
+                    hash *= 1099511628211ull;
+                }
+                return (size_t)hash;
+            }
+        };
+
+        // 对称 4x4 二次型 Q(p) = pᵀAp + 2bᵀp + c，附带累计权重，误差取加权平均的平方距离
+        struct Quadric {
+            double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+            double b0 = 0, b1 = 0, b2 = 0, c = 0;
+            double weight = 0;
+
+            static Quadric FromPlane(const Eigen::Vector3d& n, double d, double w) {
+                Quadric q;
+                q.a00 = w * n.x() * n.x(); q.a01 = w * n.x() * n.y(); q.a02 = w * n.x() * n.z();
+                q.a11 = w * n.y() * n.y(); q.a12 = w * n.y() * n.z(); q.a22 = w * n.z() * n.z();
+                q.b0 = w * n.x() * d; q.b1 = w * n.y() * d; q.b2 = w * n.z() * d;
+                q.c = w * d * d;
+                q.weight = w;
+                return q;
+            }
+
+            Quadric& operator+=(const Quadric& o) {
+                a00 += o.a00; a01 += o.a01; a02 += o.a02; a11 += o.a11; a12 += o.a12; a22 += o.a22;
+                b0 += o.b0; b1 += o.b1; b2 += o.b2; c += o.c;
+                weight += o.weight;
+                return *this;
+            }
+
+            // 加权平均的平方距离
+            double Evaluate(const Vector3f& p) const {
+                double x = p.x(), y = p.y(), z = p.z();
+                double e = a00 * x * x + a11 * y * y + a22 * z * z
+                         + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+                         + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+                return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+            }
+        };
+
+        struct Collapse {
+            uint32_t from, to;
+            double cost;
+        };
+    }
+
+    vector<Triangle> MeshSimplifier::Simplify(const vector<Triangle>& mesh, size_t targetTriangles, float maxError, float* outError) {
+        //* 1. 焊接顶点：属性完全相同的角点合成一个顶点，只有位置相同的记为同一位置组
+        vector<Vertex> vertices;
+        vector<uint32_t> positionIds;
+        vector<uint32_t> indices;
+        indices.reserve(mesh.size() * 3);
+        {
+            std::unordered_map<FloatKey<8>, uint32_t, FloatKeyHash<8>> vertexMap;
+            std::unordered_map<FloatKey<3>, uint32_t, FloatKeyHash<3>> positionMap;
+            vertexMap.reserve(mesh.size() * 2);
+            positionMap.reserve(mesh.size());
+            for (const auto& tri : mesh) {
+                for (int k = 0; k < 3; ++k) {
+                    const Vector3f& p = tri.vertex[k];
+                    const Vector3f& n = tri.normal[k];
+                    const Vector2f& t = tri.uv[k];
+                    FloatKey<8> key{{p.x(), p.y(), p.z(), n.x(), n.y(), n.z(), t.x(), t.y()}};
+                    auto [it, inserted] = vertexMap.try_emplace(key, (uint32_t)vertices.size());
+                    if (inserted) {
+                        vertices.push_back({p, n, t});
+                        FloatKey<3> pkey{{p.x(), p.y(), p.z()}};
+                        positionIds.push_back(positionMap.try_emplace(pkey, (uint32_t)positionMap.size()).first->second);
+                    }
+                    indices.push_back(it->second);
+                }
+            }
+        }
+        const uint32_t vertexCount = (uint32_t)vertices.size();
+
+        //* 2. 锁定顶点：UV/法线接缝（位置组里有多个顶点）、开放边界与非流形边的端点
+        vector<char> locked(vertexCount, 0);
+        {
+            vector<uint32_t> groupSize(vertexCount, 0);
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                ++groupSize[positionIds[v]];
+            }
+            vector<char> lockedPosition(vertexCount, 0);
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                lockedPosition[positionIds[v]] |= groupSize[positionIds[v]] > 1;
+            }
+
+            // 按位置组统计每条无向边被几个三角形共用
+            std::unordered_map<uint64_t, int> edgeUse;
+            edgeUse.reserve(indices.size());
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                for (int k = 0; k < 3; ++k) {
+                    uint32_t a = positionIds[indices[i + k]], b = positionIds[indices[i + (k + 1) % 3]];
+                    if (a == b) continue;
+                    ++edgeUse[(uint64_t)std::min(a, b) << 32 | std::max(a, b)];
+                }
+            }
+            for (const auto& [edge, count] : edgeUse) {
+                if (count != 2) {
+                    lockedPosition[edge >> 32] = 1;
+                    lockedPosition[edge & 0xffffffffu] = 1;
+                }
+            }
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                locked[v] = lockedPosition[positionIds[v]];
+            }
+        }
+
+        //* 3. 初始二次型：每个位置组累加相邻三角形所在平面，按面积加权
+        vector<Quadric> quadrics(vertexCount);
+        {
+            vector<Quadric> positionQuadrics(vertexCount);
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                Eigen::Vector3d p0 = vertices[indices[i]].position.cast<double>();
+                Eigen::Vector3d p1 = vertices[indices[i + 1]].position.cast<double>();
+                Eigen::Vector3d p2 = vertices[indices[i + 2]].position.cast<double>();
+                Eigen::Vector3d n = (p1 - p0).cross(p2 - p0);
+                double area2 = n.norm();
+                if (area2 <= 0.0) continue;
+                n /= area2;
+                Quadric q = Quadric::FromPlane(n, -n.dot(p0), area2 * 0.5);
+                for (int k = 0; k < 3; ++k) {
+                    positionQuadrics[positionIds[indices[i + k]]] += q;
+                }
+            }
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                quadrics[v] = positionQuadrics[positionIds[v]];
+            }
+        }
+
+        //* 4. 分轮坍缩：每轮按代价排序，互不相邻的坍缩一起执行，再统一重建索引
+        //? 坍缩源顶点的一环邻域在本轮内都不再变动，所以翻面检查用到的位置都是最终位置
+        const double maxErrorSq = (double)maxError * maxError;
+        size_t triangleCount = indices.size() / 3;
+        double worstError = 0.0;
+        vector<uint32_t> remap(vertexCount);
+        vector<char> touched(vertexCount);
+        vector<uint32_t> adjacencyOffset(vertexCount + 1);
+        vector<uint32_t> adjacency;
+        vector<Collapse> collapses;
+        vector<uint32_t> ringA, ringB;
+
+        while (triangleCount > targetTriangles) {
+            // 顶点 → 相邻三角形（CSR）
+            std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+            for (uint32_t index : indices) {
+                ++adjacencyOffset[index + 1];
+            }
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                adjacencyOffset[v + 1] += adjacencyOffset[v];
+            }
+            adjacency.resize(indices.size());
+            {
+                vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+                for (size_t i = 0; i < indices.size(); ++i) {
+                    adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+                }
+            }
+
+            // 候选：每条边上未锁定的端点坍缩到另一端
+            collapses.clear();
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                for (int k = 0; k < 3; ++k) {
+                    uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+                    if (!locked[a]) collapses.push_back({a, b, quadrics[a].Evaluate(vertices[b].position)});
+                    if (!locked[b]) collapses.push_back({b, a, quadrics[b].Evaluate(vertices[a].position)});
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+            for (uint32_t v = 0; v < vertexCount; ++v) {
+                remap[v] = v;
+            }
+            std::fill(touched.begin(), touched.end(), 0);
+
+            size_t performed = 0;
+            for (const Collapse& collapse : collapses) {
+                if (triangleCount <= targetTriangles || collapse.cost > maxErrorSq) {
+                    break;
+                }
+                const uint32_t a = collapse.from, b = collapse.to;
+                if (touched[a] || touched[b]) {
+                    continue;
+                }
+
+                // 检查：a 的一环与 b 的一环只能共享坍缩边两侧的顶点（否则产生非流形），a 的其余三角形不能翻面
+                int removed = 0, sharedNeighbors = 0;
+                bool valid = true;
+                for (uint32_t t = adjacencyOffset[a]; t < adjacencyOffset[a + 1] && valid; ++t) {
+                    const uint32_t* tri = &indices[(size_t)adjacency[t] * 3];
+                    if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+                        continue;
+                    }
+                    if (tri[0] == b || tri[1] == b || tri[2] == b) {
+                        ++removed;
+                        continue;
+                    }
+                    Vector3f p[3], q[3];
+                    for (int k = 0; k < 3; ++k) {
+                        p[k] = vertices[tri[k]].position;
+                        q[k] = tri[k] == a ? vertices[b].position : p[k];
+                    }
+                    Vector3f before = (p[1] - p[0]).cross(p[2] - p[0]);
+                    Vector3f after = (q[1] - q[0]).cross(q[2] - q[0]);
+                    if (before.dot(after) <= 0.0f) {
+                        valid = false;
+                    }
+                }
+                if (!valid || removed == 0) {
+                    continue;
+                }
+                ringA.clear();
+                ringB.clear();
+                auto collectRing = [&](uint32_t center, vector<uint32_t>& ring) {
+                    for (uint32_t t = adjacencyOffset[center]; t < adjacencyOffset[center + 1]; ++t) {
+                        const uint32_t* tri = &indices[(size_t)adjacency[t] * 3];
+                        for (int k = 0; k < 3; ++k) {
+                            if (tri[k] != a && tri[k] != b) ring.push_back(positionIds[tri[k]]);
+                        }
+                    }
+                    std::sort(ring.begin(), ring.end());
+                    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+                };
+                collectRing(a, ringA);
+                collectRing(b, ringB);
+                for (size_t i = 0, j = 0; i < ringA.size() && j < ringB.size();) {
+                    if (ringA[i] < ringB[j]) {
+                        ++i;
+                    } else if (ringA[i] > ringB[j]) {
+                        ++j;
+                    } else {
+                        ++sharedNeighbors;
+                        ++i;
+                        ++j;
+                    }
+                }
+                //? 流形上两端点的一环只共享坍缩边两侧三角形的第三个顶点，多出来的共享顶点坍缩后会形成非流形
+                if (sharedNeighbors > removed) {
+                    continue;
+                }
+
+                remap[a] = b;
+                quadrics[b] += quadrics[a];
+                touched[a] = touched[b] = 1;
+                for (uint32_t t = adjacencyOffset[a]; t < adjacencyOffset[a + 1]; ++t) {
+                    const uint32_t* tri = &indices[(size_t)adjacency[t] * 3];
+                    touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                }
+                triangleCount -= removed;
+                worstError = std::max(worstError, collapse.cost);
+                ++performed;
+            }
+
+            if (performed == 0) {
+                break; // 剩下的都被锁定、会翻面或超出误差上限
+            }
+
+            // 重建索引，删除退化三角形
+            size_t write = 0;
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                uint32_t v0 = remap[indices[i]], v1 = remap[indices[i + 1]], v2 = remap[indices[i + 2]];
+                if (v0 == v1 || v1 == v2 || v0 == v2) continue;
+                indices[write++] = v0;
+                indices[write++] = v1;
+                indices[write++] = v2;
+            }
+            indices.resize(write);
+            triangleCount = write / 3;
+        }
+
+        if (outError) {
+            *outError = (float)std::sqrt(worstError);
+        }
+
+        //* 5. 输出
+        vector<Triangle> result;
+        result.reserve(indices.size() / 3);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            const Vertex& v0 = vertices[indices[i]];
+            const Vertex& v1 = vertices[indices[i + 1]];
+            const Vertex& v2 = vertices[indices[i + 2]];
+            result.emplace_back(std::array<Vector3f, 3>{v0.position, v1.position, v2.position},
+                                std::array<Vector3f, 3>{v0.normal, v1.normal, v2.normal},
+                                std::array<Vector2f, 3>{v0.uv, v1.uv, v2.uv});
+        }
+        return result;
+    }
+
+    vector<MeshLod> MeshSimplifier::BuildLods(const vector<Triangle>& mesh, const LodSettings& settings) {
+        vector<MeshLod> lods;
+        if (mesh.size() < settings.minTriangles) {
+            return lods;
+        }
+        const vector<Triangle>* source = &mesh;
+        float accumulatedError = 0.0f;
+        for (int level = 0; level < settings.levels; ++level) {
+            size_t target = (size_t)(source->size() * settings.reduction);
+            if (target < 4) {
+                break;
+            }
+            float error = 0.0f;
+            vector<Triangle> simplified = Simplify(*source, target, std::numeric_limits<float>::max(), &error);
+            if (simplified.empty() || simplified.size() > source->size() * settings.minReduction) {
+                break;
+            }
+            accumulatedError += error;
+            lods.push_back({std::move(simplified), accumulatedError});
+            source = &lods.back().mesh;
+        }
+        return lods;
+    }
+}
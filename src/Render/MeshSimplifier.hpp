@@ -0,0 +1,37 @@
+/// FileName: MeshSimplifier.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 基于二次误差度量（QEM）的网格简化与 LOD 生成
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Triangle.hpp"
+
+namespace aries::model {
+    // 一级 LOD：简化后的网格与它相对原网格的几何误差（模型空间距离）
+    struct MeshLod {
+        vector<Triangle> mesh;
+        float error = 0.0f;
+    };
+
+    // LOD 生成设置
+    struct LodSettings {
+        int levels = 3;                 // 除原网格外最多生成的级数
+        float reduction = 0.25f;        // 每一级的目标三角形数为上一级的这个比例
+        size_t minTriangles = 1024;     // 三角形少于这个数的网格不生成 LOD
+        float minReduction = 0.8f;      // 简化后三角形数仍超过上一级的这个比例时（锁定的顶点太多）停止
+    };
+
+    class MeshSimplifier {
+    public:
+        // 把网格简化到不超过 targetTriangles 个三角形，或误差达到 maxError 为止
+        // 返回简化后的网格，outError 为最大一次坍缩的误差
+        //? 按位置、法线与 UV 完全相同焊接顶点后做半边坍缩：被坍缩的顶点移到相邻顶点上，不产生新的属性值；
+        //? UV 接缝（同一位置有多组属性）与开放边界上的顶点锁定不动，只能作为坍缩目标，外形与纹理接缝保持不变
+        static vector<Triangle> Simplify(const vector<Triangle>& mesh, size_t targetTriangles, float maxError, float* outError = nullptr);
+
+        // 逐级简化，每一级从上一级继续，误差按级累加；不满足 minTriangles 时返回空
+        static vector<MeshLod> BuildLods(const vector<Triangle>& mesh, const LodSettings& settings);
+    };
+}
@@ -17,15 +17,142 @@ namespace aries::model {
             }
         }
 
-        Matrix4f GetModelMatrix() const {
+        Model(const Model&) = delete;
+        Model& operator=(const Model&) = delete;
+
+        ~Model() {
+            SetParent(nullptr);
+            for (Model* child : m_children) {
+                child->m_parent = nullptr;
+                child->InvalidateWorld();
+            }
+        }
+
+        //* 局部变换（相对父模型，没有父模型时即世界空间），修改后本模型与所有子孙的世界矩阵失效
+        const Vector3f& GetPosition() const { return m_position; }
+        const Vector3f& GetRotation() const { return m_rotation; } // 欧拉角（度）
+        const Vector3f& GetScale() const { return m_scale; }
+
+        void SetPosition(const Vector3f& position) {
+            if (position != m_position) {
+                m_position = position;
+                InvalidateLocal();
+            }
+        }
+
+        void SetRotation(const Vector3f& rotation) {
+            if (rotation != m_rotation) {
+                m_rotation = rotation;
+                InvalidateLocal();
+            }
+        }
+
+        void SetScale(const Vector3f& scale) {
+            if (scale != m_scale) {
+                m_scale = scale;
+                InvalidateLocal();
+            }
+        }
+
+        // 局部矩阵，变换修改过才重新计算
+        const Matrix4f& GetLocalMatrix() const {
+            if (m_localDirty) {
+                m_localMatrix = ComputeLocalMatrix();
+                m_localDirty = false;
+            }
+            return m_localMatrix;
+        }
+
+        // 模型空间 → 世界空间：父模型的世界矩阵 × 局部矩阵，失效时才重新计算
+        //? 惰性计算不加锁，渲染时 ShapeBVH::Update 已在主线程把变化过的模型都算好，之后的并行阶段只读缓存
+        const Matrix4f& GetModelMatrix() const {
+            if (m_worldDirty) {
+                m_worldMatrix = m_parent ? Matrix4f(m_parent->GetModelMatrix() * GetLocalMatrix()) : GetLocalMatrix();
+                m_worldDirty = false;
+            }
+            return m_worldMatrix;
+        }
+
+        // 世界矩阵失效一次加一，缓存了由世界矩阵派生的数据（如 BVH 包围盒）的地方比较版本号即可判断是否过期
+        uint64_t GetTransformVersion() const { return m_transformVersion; }
+
+        //* 层次结构：父模型不持有子模型，任一方销毁时自动断开
+        // 设置父模型，nullptr 表示脱离；会形成环时不做修改并返回 false
+        bool SetParent(Model* parent) {
+            for (Model* p = parent; p; p = p->m_parent) {
+                if (p == this) {
+                    return false;
+                }
+            }
+            if (parent == m_parent) {
+                return true;
+            }
+            if (m_parent) {
+                auto& siblings = m_parent->m_children;
+                siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+            }
+            m_parent = parent;
+            if (m_parent) {
+                m_parent->m_children.push_back(this);
+            }
+            InvalidateWorld();
+            return true;
+        }
+
+        Model* GetParent() const { return m_parent; }
+
+        const vector<Model*>& GetChildren() const { return m_children; }
+
+        string name;
+
+        vector<sptr<Shape>> shapes; // 模型的形状列表
+
+    private:
+        Vector3f m_position = Vector3f(0.0f, 0.0f, 0.0f); // 模型位置
+        Vector3f m_rotation = Vector3f(0.0f, 0.0f, 0.0f); // 模型旋转
+        Vector3f m_scale = Vector3f(1.0f, 1.0f, 1.0f); // 模型缩放
+
+        Model* m_parent = nullptr;
+        vector<Model*> m_children;
+
+        mutable Matrix4f m_localMatrix = Matrix4f::Identity();
+        mutable Matrix4f m_worldMatrix = Matrix4f::Identity();
+        mutable bool m_localDirty = true;
+        mutable bool m_worldDirty = true;
+        uint64_t m_transformVersion = 0;
+
+        void InvalidateLocal() {
+            m_localDirty = true;
+            InvalidateWorld();
+        }
+
+        // 本模型与所有子孙的世界矩阵失效，并通知形状所在的 ShapeStore
+        //? 失效的模型其子孙一定也已失效（子模型算世界矩阵前总会先算父模型），所以已失效的子树直接返回，
+        //? 同一帧内反复修改只在第一次遍历子树；版本号因此在两次重新计算之间只增加一次，使用方要在读取世界矩阵时一并记录
+        //? ShapeStore 刷新变化的行时会重新读取世界矩阵，之后再修改时又会从这里通知到
+        void InvalidateWorld() {
+            if (m_worldDirty) {
+                return;
+            }
+            ++m_transformVersion;
+            m_worldDirty = true;
+            for (const auto& shape : shapes) {
+                shape->MarkChanged(SHAPE_CHANGED_TRANSFORM);
+            }
+            for (Model* child : m_children) {
+                child->InvalidateWorld();
+            }
+        }
+
+        Matrix4f ComputeLocalMatrix() const {
             Matrix4f rX, rY, rZ;
             float radX, radY, radZ;
             Matrix4f mat_scale;
             Matrix4f mat_move;
 
-            radX = ToRadian(rotation.x());
-            radY = ToRadian(rotation.y());
-            radZ = ToRadian(rotation.z());
+            radX = ToRadian(m_rotation.x());
+            radY = ToRadian(m_rotation.y());
+            radZ = ToRadian(m_rotation.z());
 
             rX <<   1, 0, 0, 0, 
                     0, cos(radX), -sin(radX), 0, 
@@ -42,25 +169,17 @@ namespace aries::model {
                     0, 0, 1, 0, 
                     0, 0, 0, 1;
 
-            mat_scale <<    scale.x(), 0, 0, 0, 
-                            0, scale.y(), 0, 0, 
-                            0, 0, scale.z(), 0, 
+            mat_scale <<    m_scale.x(), 0, 0, 0, 
+                            0, m_scale.y(), 0, 0, 
+                            0, 0, m_scale.z(), 0, 
                             0, 0, 0, 1;
 
-            mat_move << 1, 0, 0, position.x(), 
-                        0, 1, 0, position.y(), 
-                        0, 0, 1, position.z(), 
+            mat_move << 1, 0, 0, m_position.x(), 
+                        0, 1, 0, m_position.y(), 
+                        0, 0, 1, m_position.z(), 
                         0, 0, 0, 1;
 
             return mat_move * rZ * rX * rY * mat_scale;
         }
-
-        string name;
-
-        Vector3f position = Vector3f(0.0f, 0.0f, 0.0f); // 模型位置
-        Vector3f rotation = Vector3f(0.0f, 0.0f, 0.0f); // 模型旋转
-        Vector3f scale = Vector3f(1.0f, 1.0f, 1.0f); // 模型缩放
-
-        vector<sptr<Shape>> shapes; // 模型的形状列表
     };
 }
\ No newline at end of file
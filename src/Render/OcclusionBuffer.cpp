@@ -0,0 +1,149 @@
+/// FileName: OcclusionBuffer.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "OcclusionBuffer.hpp"
+#include "RasterCore.hpp"
+
+namespace aries::render {
+    ScreenBounds ScreenBounds::Project(const model::AABB& box, const Matrix4f& mvp) {
+        ScreenBounds result;
+        if (!box.IsValid()) {
+            return result;
+        }
+        result.min = Vector2f::Constant(std::numeric_limits<float>::max());
+        result.max = Vector2f::Constant(std::numeric_limits<float>::lowest());
+        result.nearestZ = std::numeric_limits<float>::max();
+        for (int i = 0; i < 8; ++i) {
+            Vector3f corner = box.Corner(i);
+            Vector4f clip = mvp * Vector4f(corner.x(), corner.y(), corner.z(), 1.0f);
+            if (clip.z() < -clip.w()) {
+                return result; // 越过近平面，投影范围没有意义
+            }
+            Vector3f ndc = clip.head<3>() / clip.w();
+            result.min = result.min.cwiseMin(ndc.head<2>());
+            result.max = result.max.cwiseMax(ndc.head<2>());
+            result.nearestZ = std::min(result.nearestZ, ndc.z());
+        }
+        result.valid = true;
+        return result;
+    }
+
+    void OcclusionBuffer::Resize(int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_depth.assign((size_t)width * height, std::numeric_limits<float>::max());
+    }
+
+    void OcclusionBuffer::Begin(const Matrix4f& viewProjection) {
+        m_viewProjection = viewProjection;
+        std::fill(m_depth.begin(), m_depth.end(), std::numeric_limits<float>::max());
+    }
+
+    void OcclusionBuffer::RasterizeOccluder(const model::Shape& shape, const Matrix4f& modelMatrix) {
+        Matrix4f mvp = m_viewProjection * modelMatrix;
+        for (const auto& tri : shape.GetTriangles()) {
+            Vector4f clip[3];
+            for (int k = 0; k < 3; ++k) {
+                clip[k] = mvp * Vector4f(tri.vertex[k].x(), tri.vertex[k].y(), tri.vertex[k].z(), 1.0f);
+            }
+            if (IsTriangleOutsideFrustum(clip[0], clip[1], clip[2])) {
+                continue;
+            }
+
+            Vector4f polygon[MAX_CLIP_VERTICES];
+            int vertexCount = 3;
+            if (uint32_t planes = ClipPlanesNeeded(clip[0], clip[1], clip[2])) [[unlikely]] {
+                vertexCount = ClipTriangle(clip, polygon, planes,
+                    [](const Vector4f& v) -> const Vector4f& { return v; },
+                    [](const Vector4f& a, const Vector4f& b, float t) -> Vector4f { return a + (b - a) * t; });
+            } else {
+                polygon[0] = clip[0];
+                polygon[1] = clip[1];
+                polygon[2] = clip[2];
+            }
+
+            for (int k = 0; k < vertexCount; ++k) {
+                polygon[k] /= polygon[k].w();
+            }
+            for (int k = 1; k + 1 < vertexCount; ++k) {
+                if (IsBackFacing(polygon[0], polygon[k], polygon[k + 1]) ||
+                    IsTriangleOutsideViewport(polygon[0], polygon[k], polygon[k + 1])) {
+                    continue;
+                }
+                RasterizeConservative(ToViewport(polygon[0]), ToViewport(polygon[k]), ToViewport(polygon[k + 1]));
+            }
+        }
+    }
+
+    void OcclusionBuffer::RasterizeConservative(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2) {
+        float area = (v1.x() - v0.x()) * (v2.y() - v0.y()) - (v1.y() - v0.y()) * (v2.x() - v0.x());
+        if (area <= 0.0f) {
+            return; // 背面已剔除，这里只剩退化三角形
+        }
+
+        int minX = std::max(0, (int)std::floor(std::min({v0.x(), v1.x(), v2.x()})));
+        int maxX = std::min(m_width, (int)std::ceil(std::max({v0.x(), v1.x(), v2.x()})));
+        int minY = std::max(0, (int)std::floor(std::min({v0.y(), v1.y(), v2.y()})));
+        int maxY = std::min(m_height, (int)std::ceil(std::max({v0.y(), v1.y(), v2.y()})));
+        if (minX >= maxX || minY >= maxY) {
+            return;
+        }
+
+        // 边 i 与顶点 i 相对，内部为正；与 RasterizeTriangle 相同的写法
+        const Vector3f* from[3] = {&v1, &v2, &v0};
+        const Vector3f* to[3] = {&v2, &v0, &v1};
+        float A[3], B[3], C[3];
+        for (int i = 0; i < 3; ++i) {
+            float dx = to[i]->x() - from[i]->x();
+            float dy = to[i]->y() - from[i]->y();
+            A[i] = -dy;
+            B[i] = dx;
+            //? 把边向内收半个像素（在像素中心处减去 |A|/2 + |B|/2），中心通过测试即整个像素都在边内侧
+            C[i] = dy * from[i]->x() - dx * from[i]->y() - 0.5f * (std::abs(A[i]) + std::abs(B[i]));
+        }
+
+        // 深度平面 z = Zx·x + Zy·y + Z0，像素内的最大值在中心处加上 |Zx|/2 + |Zy|/2，且不超过三个顶点的最大深度
+        const float invArea = 1.0f / area;
+        const float Zx = (A[0] * v0.z() + A[1] * v1.z() + A[2] * v2.z()) * invArea;
+        const float Zy = (B[0] * v0.z() + B[1] * v1.z() + B[2] * v2.z()) * invArea;
+        const float Z0 = v0.z() - Zx * v0.x() - Zy * v0.y() + 0.5f * (std::abs(Zx) + std::abs(Zy));
+        const float maxZ = std::max({v0.z(), v1.z(), v2.z()});
+
+        for (int y = minY; y < maxY; ++y) {
+            const float py = (float)y + 0.5f;
+            const float r0 = B[0] * py + C[0], r1 = B[1] * py + C[1], r2 = B[2] * py + C[2];
+            const float rz = Zy * py + Z0;
+            float* row = m_depth.data() + (size_t)y * m_width;
+            //? 循环体无分支，编译器可以把一行按 SIMD 宽度展开
+            for (int x = minX; x < maxX; ++x) {
+                const float px = (float)x + 0.5f;
+                const bool covered = (A[0] * px + r0 >= 0.0f) & (A[1] * px + r1 >= 0.0f) & (A[2] * px + r2 >= 0.0f);
+                const float z = std::min(Zx * px + rz, maxZ);
+                row[x] = covered ? std::min(row[x], z) : row[x];
+            }
+        }
+    }
+
+    bool OcclusionBuffer::IsOccluded(const ScreenBounds& bounds) const {
+        if (!bounds.valid) {
+            return false;
+        }
+        int minX = std::max(0, (int)std::floor((bounds.min.x() + 1.0f) * 0.5f * m_width));
+        int maxX = std::min(m_width, (int)std::ceil((bounds.max.x() + 1.0f) * 0.5f * m_width));
+        int minY = std::max(0, (int)std::floor((bounds.min.y() + 1.0f) * 0.5f * m_height));
+        int maxY = std::min(m_height, (int)std::ceil((bounds.max.y() + 1.0f) * 0.5f * m_height));
+        if (minX >= maxX || minY >= maxY) {
+            return false;
+        }
+        for (int y = minY; y < maxY; ++y) {
+            const float* row = m_depth.data() + (size_t)y * m_width;
+            for (int x = minX; x < maxX; ++x) {
+                if (row[x] >= bounds.nearestZ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
@@ -0,0 +1,132 @@
+/// FileName: OcclusionBuffer.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 软件遮挡剔除：把大遮挡物光栅化进低分辨率深度缓冲，再用形状的屏幕包围矩形做保守测试
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Bounds.hpp"
+#include "Shape.hpp"
+
+namespace aries::render {
+    // 遮挡剔除设置
+    struct OcclusionCullingSettings {
+        int width = 256;                  // 遮挡深度缓冲尺寸
+        int height = 128;
+        int maxOccluders = 16;            // 每帧最多光栅化的遮挡物数（按屏幕面积从大到小）
+        int maxOccluderTriangles = 4096;  // 自动选择的遮挡物三角形上限，指定的遮挡物不受限制
+        float minOccluderArea = 0.05f;    // 自动选择遮挡物的最小屏幕面积占比
+        bool reproject = false;           // 是否把上一帧的深度重投影进来
+    };
+
+    // 遮挡剔除统计
+    struct OcclusionStats {
+        int occluders = 0;              // 本帧光栅化的遮挡物数
+        uint64_t occluderTriangles = 0; // 遮挡物三角形数
+        int reprojectedPixels = 0;      // 重投影写入的像素数
+        int testedShapes = 0;           // 参与测试的形状数
+        int occludedShapes = 0;         // 判定被遮挡的形状数
+        float rasterMs = 0.0f;          // 重投影与遮挡物光栅化耗时
+        float testMs = 0.0f;            // 测试耗时
+    };
+
+    // 形状包围盒投影到屏幕后的范围（NDC）与最近深度
+    struct ScreenBounds {
+        Vector2f min, max;
+        float nearestZ = -1.0f;
+        bool valid = false; // 包围盒越过近平面时无效，此时既不能当遮挡物的面积估计，也不能判定被遮挡
+
+        inline float Area() const {
+            Vector2f size = (max.cwiseMin(Vector2f::Ones()) - min.cwiseMax(-Vector2f::Ones())).cwiseMax(Vector2f::Zero());
+            return size.x() * size.y() * 0.25f; // 占 NDC [-1,1]² 的比例
+        }
+
+        static ScreenBounds Project(const model::AABB& box, const Matrix4f& mvp);
+    };
+
+    // 低分辨率遮挡深度缓冲
+    //? 每个像素存"完全覆盖该像素的遮挡物三角形在像素内的最大深度"的最小值，不覆盖整个像素的三角形不写入，
+    //? 所以测试只会把确实被挡住的形状判为遮挡，不会因为分辨率低而误剔除
+    class OcclusionBuffer {
+    public:
+        void Resize(int width, int height);
+
+        // 开始新的一帧：清空为不遮挡，设置本帧的 投影*视图 矩阵
+        void Begin(const Matrix4f& viewProjection);
+
+        // 把上一帧的全分辨率深度按像素块取最大值后重投影到本帧，返回写入的像素数
+        //? depthAt(x, y) 返回上一帧 (x, y) 处的 NDC 深度（y 轴向上，无内容时为 FLT_MAX）；
+        //? 每块只投到一个目标像素，相机移动后的空洞保持不遮挡
+        template<typename DepthFn>
+        int Reproject(int srcWidth, int srcHeight, DepthFn&& depthAt, const Matrix4f& prevViewProjection);
+
+        // 光栅化一个遮挡物（只做背面剔除与近平面裁剪，不着色）
+        void RasterizeOccluder(const model::Shape& shape, const Matrix4f& modelMatrix);
+
+        // 形状的屏幕包围矩形内每个像素的遮挡深度都比形状最近点更近时返回 true
+        bool IsOccluded(const ScreenBounds& bounds) const;
+
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+
+        // 行主序、y 轴向上，FLT_MAX 表示没有遮挡物
+        const vector<float>& GetDepth() const { return m_depth; }
+
+    private:
+        int m_width = 0, m_height = 0;
+        vector<float> m_depth;
+        Matrix4f m_viewProjection = Matrix4f::Identity();
+
+        // 保守光栅化一个视口变换后的三角形（逆时针），只写完全覆盖的像素
+        void RasterizeConservative(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2);
+
+        // 把 NDC 点变换到本缓冲的像素坐标
+        inline Vector3f ToViewport(const Vector4f& ndc) const {
+            return Vector3f((ndc.x() + 1.0f) * 0.5f * m_width, (ndc.y() + 1.0f) * 0.5f * m_height, ndc.z());
+        }
+    };
+
+    template<typename DepthFn>
+    int OcclusionBuffer::Reproject(int srcWidth, int srcHeight, DepthFn&& depthAt, const Matrix4f& prevViewProjection) {
+        Matrix4f reprojection = m_viewProjection * prevViewProjection.inverse();
+        int written = 0;
+#pragma omp parallel for schedule(static) reduction(+:written)
+        for (int cy = 0; cy < m_height; ++cy) {
+            int y0 = cy * srcHeight / m_height, y1 = std::max(y0 + 1, (cy + 1) * srcHeight / m_height);
+            for (int cx = 0; cx < m_width; ++cx) {
+                int x0 = cx * srcWidth / m_width, x1 = std::max(x0 + 1, (cx + 1) * srcWidth / m_width);
+
+                //* 块内最大深度，有一个像素没有内容就整块视为不遮挡
+                float maxZ = -1.0f;
+                for (int y = y0; y < y1 && maxZ <= 1.0f; ++y) {
+                    for (int x = x0; x < x1; ++x) {
+                        maxZ = std::max(maxZ, depthAt(x, y));
+                    }
+                }
+                if (maxZ > 1.0f) {
+                    continue;
+                }
+
+                //* 块中心按最大深度还原，投到本帧
+                Vector4f prev((cx + 0.5f) / m_width * 2.0f - 1.0f, (cy + 0.5f) / m_height * 2.0f - 1.0f, maxZ, 1.0f);
+                Vector4f clip = reprojection * prev;
+                if (clip.w() <= 0.0f) {
+                    continue;
+                }
+                Vector3f p = ToViewport(clip / clip.w());
+                int tx = (int)std::floor(p.x()), ty = (int)std::floor(p.y());
+                if (tx < 0 || tx >= m_width || ty < 0 || ty >= m_height || p.z() < -1.0f) {
+                    continue;
+                }
+                //? 不同行的块可能投到同一目标像素，这里只做取小，竞争时丢掉一次写入也仍是保守的
+                float& target = m_depth[(size_t)ty * m_width + tx];
+                if (p.z() < target) {
+                    target = p.z();
+                    ++written;
+                }
+            }
+        }
+        return written;
+    }
+}
@@ -39,6 +39,17 @@ void Raster::SetPixel(int x, int y, color_t r, color_t g, color_t b, color_t a)
     swBuffer[idx + 3] = a;
 }
 
+void Raster::GetPixel(int x, int y, color_t& r, color_t& g, color_t& b) const {
+    if (x < 0 || x >= swW || y < 0 || y >= swH) {
+        r = g = b = 0;
+        return;
+    }
+    int idx = (y * swW + x) * 4;
+    r = swBuffer[idx + 0];
+    g = swBuffer[idx + 1];
+    b = swBuffer[idx + 2];
+}
+
 // 切换缓冲区
 /*void Raster::SwapBuffers() {
     swLast = swCur; // 保存当前缓冲区索引
@@ -32,6 +32,9 @@ public:
     // CPU 端写像素
     void SetPixel(int x, int y, color_t r, color_t g, color_t b, color_t a = 255);
 
+    // CPU 端读像素，越界时返回黑色
+    void GetPixel(int x, int y, color_t& r, color_t& g, color_t& b) const;
+
     // 上传像素缓冲区到 GPU
     void UploadToGPU();
 
@@ -0,0 +1,325 @@
+/// FileName: RasterCore.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 主渲染器与阴影渲染器共用的三角形裁剪、剔除与光栅化核心
+
+#pragma once
+
+#include "CommonHeader.hpp"
+
+#include <bit>
+
+namespace aries::render {
+    // 光栅化模式
+    enum class RasterMode {
+        DepthOnly,    // 只插值深度（阴影贴图、预深度），回调 fn(x, y, z)
+        Interpolated, // 额外给出屏幕空间重心坐标，回调 fn(x, y, z, l0, l1, l2)
+    };
+
+    //* 齐次裁剪空间中的裁剪平面，按位组合
+    //? 侧面用保护带（NDC 的 ±GUARD_BAND 倍）代替视口边界：顶点越出视口但仍在保护带内时不裁剪，
+    //? 光栅化按屏幕范围收紧每行的区间即可；只有越出保护带的顶点才裁剪，以限制屏幕坐标的数值范围
+    enum ClipPlaneBits : uint32_t {
+        CLIP_NEAR = 1u << 0,   // z >= -w
+        CLIP_FAR = 1u << 1,    // z <= w
+        CLIP_LEFT = 1u << 2,   // x >= -GUARD_BAND * w
+        CLIP_RIGHT = 1u << 3,  // x <= GUARD_BAND * w
+        CLIP_BOTTOM = 1u << 4, // y >= -GUARD_BAND * w
+        CLIP_TOP = 1u << 5,    // y <= GUARD_BAND * w
+        CLIP_ALL = (1u << 6) - 1,
+    };
+
+    inline constexpr float GUARD_BAND = 4.0f;
+
+    // 每个平面裁剪后多边形最多多一个顶点
+    inline constexpr int MAX_CLIP_VERTICES = 3 + 6;
+
+    // 顶点到裁剪平面的有符号距离，非负为内侧；guard 为侧面所在的 NDC 范围
+    inline float ClipPlaneDistance(const Vector4f& v, int plane, float guard = GUARD_BAND) {
+        switch (plane) {
+            case 0: return v.z() + v.w();
+            case 1: return v.w() - v.z();
+            case 2: return v.x() + guard * v.w();
+            case 3: return guard * v.w() - v.x();
+            case 4: return v.y() + guard * v.w();
+            default: return guard * v.w() - v.y();
+        }
+    }
+
+    // 顶点在哪些平面之外，guard 为侧面所在的 NDC 范围
+    inline uint32_t ClipOutcode(const Vector4f& v, float guard = GUARD_BAND) {
+        uint32_t code = 0;
+        if (v.z() < -v.w()) code |= CLIP_NEAR;
+        if (v.z() > v.w()) code |= CLIP_FAR;
+        if (v.x() < -guard * v.w()) code |= CLIP_LEFT;
+        if (v.x() > guard * v.w()) code |= CLIP_RIGHT;
+        if (v.y() < -guard * v.w()) code |= CLIP_BOTTOM;
+        if (v.y() > guard * v.w()) code |= CLIP_TOP;
+        return code;
+    }
+
+    // 三个顶点都在视锥（侧面取视口边界）的同一个平面之外，整个三角形不可见
+    inline bool IsTriangleOutsideFrustum(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
+        return (ClipOutcode(v0, 1.0f) & ClipOutcode(v1, 1.0f) & ClipOutcode(v2, 1.0f)) != 0;
+    }
+
+    // 需要裁剪的平面：有顶点越过近、远平面，或越出保护带
+    inline uint32_t ClipPlanesNeeded(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
+        return ClipOutcode(v0) | ClipOutcode(v1) | ClipOutcode(v2);
+    }
+
+    // 用 planes 中的平面依次裁剪三角形（Sutherland-Hodgman），返回输出凸多边形的顶点数（0 或 3 ~ MAX_CLIP_VERTICES），按扇形剖分即可
+    // getPos(v) 返回顶点的齐次裁剪坐标，lerp(a, b, t) 对两个顶点线性插值
+    //? 近平面最先裁剪，之后的顶点 w 都为正，侧面的保护带判断才有意义
+    template<typename VertexT, typename PosFn, typename LerpFn>
+    inline int ClipTriangle(const VertexT (&in)[3], VertexT (&out)[MAX_CLIP_VERTICES], uint32_t planes, PosFn&& getPos, LerpFn&& lerp) {
+        //? 两个缓冲来回倒，按要裁剪的平面数选第一个输出缓冲，使最后一次恰好写进 out
+        VertexT temp[MAX_CLIP_VERTICES];
+        VertexT* buffers[2] = {out, temp};
+        int target = std::popcount(planes) % 2 == 1 ? 0 : 1;
+
+        const VertexT* src = in;
+        int count = 3;
+        for (int plane = 0; plane < 6; ++plane) {
+            if (!(planes & (1u << plane))) {
+                continue;
+            }
+            VertexT* dst = buffers[target];
+            int outCount = 0;
+            for (int i = 0; i < count; ++i) {
+                const VertexT& current = src[i];
+                const VertexT& next = src[(i + 1) % count];
+                float d1 = ClipPlaneDistance(getPos(current), plane);
+                float d2 = ClipPlaneDistance(getPos(next), plane);
+                bool currentInside = d1 >= 0.0f;
+                bool nextInside = d2 >= 0.0f;
+
+                if (currentInside) {
+                    dst[outCount++] = current;
+                }
+                if (currentInside != nextInside) {
+                    dst[outCount++] = lerp(current, next, d1 / (d1 - d2));
+                }
+            }
+            if (outCount < 3) {
+                return 0;
+            }
+            src = dst;
+            count = outCount;
+            target ^= 1;
+        }
+
+        if (src == in) {
+            for (int i = 0; i < 3; ++i) {
+                out[i] = in[i];
+            }
+        }
+        return count;
+    }
+
+    // 透视除法后的三角形包围盒与 NDC [-1,1]² 不相交
+    inline bool IsTriangleOutsideViewport(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
+        float minX = std::min({v0.x(), v1.x(), v2.x()});
+        float maxX = std::max({v0.x(), v1.x(), v2.x()});
+        float minY = std::min({v0.y(), v1.y(), v2.y()});
+        float maxY = std::max({v0.y(), v1.y(), v2.y()});
+        return maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f;
+    }
+
+    // 背面剔除：透视除法后按顺时针绕序（y 轴向上）判定为背面
+    inline bool IsBackFacing(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
+        float crossZ = (v1.x() - v0.x()) * (v2.y() - v0.y()) - (v1.y() - v0.y()) * (v2.x() - v0.x());
+        return crossZ < 0;
+    }
+
+    //* 定点光栅化
+    //? 视口变换后的顶点吸附到 1/256 像素（16.8 定点），边函数用 64 位整数精确计算：
+    //? 共享边在相邻两个三角形中的边函数互为相反数，且与遍历从哪个像素开始无关，
+    //? 配合左上填充规则，落在共享边上的像素中心恰好属于其中一个三角形，既不漏也不重复
+    inline constexpr int SUBPIXEL_BITS = 8;
+    inline constexpr int64_t SUBPIXEL_SCALE = int64_t(1) << SUBPIXEL_BITS;
+    inline constexpr int64_t SUBPIXEL_HALF = SUBPIXEL_SCALE / 2; // 像素中心相对像素左下角的偏移
+
+    // 顶点屏幕坐标的绝对值上限（像素），保证定点边函数不溢出；保护带内的三角形远小于它，超出的不绘制
+    inline constexpr float RASTER_MAX_COORD = float(1 << 20);
+
+    // 屏幕坐标四舍五入到定点
+    //? 不用 std::lrint：未开 -fno-math-errno 时它是库函数调用，每个三角形要调用六次
+    inline int64_t ToFixed(float v) {
+        float scaled = v * SUBPIXEL_SCALE;
+        return (int64_t)(scaled + (scaled >= 0.0f ? 0.5f : -0.5f));
+    }
+
+    // 包围盒宽于此像素数的三角形逐行求覆盖区间
+    inline constexpr int RASTER_SPAN_MIN_WIDTH = 16;
+
+    // 包围盒内像素中心不超过 N×N 的三角形直接逐个测试，致密网格中绝大多数三角形属于这类
+    inline constexpr int SMALL_TRIANGLE_SIZE = 2;
+
+    // 三个顶点吸附到定点，坐标超出范围（或为 NaN）时返回 false
+    inline bool SnapToFixed(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2, int64_t (&fx)[3], int64_t (&fy)[3]) {
+        const Vector4f* p[3] = {&v0, &v1, &v2};
+        for (int i = 0; i < 3; ++i) {
+            if (!(std::abs(p[i]->x()) < RASTER_MAX_COORD && std::abs(p[i]->y()) < RASTER_MAX_COORD)) {
+                return false;
+            }
+            fx[i] = ToFixed(p[i]->x());
+            fy[i] = ToFixed(p[i]->y());
+        }
+        return true;
+    }
+
+    // 定点三角形包围盒内、屏幕内的像素中心范围 [minX, maxX) × [minY, maxY)，一个都没有时返回 false
+    //? 像素 x 的中心在定点下为 x * S + S / 2，包围盒内的中心为 ceil((min - S/2) / S) ~ floor((max - S/2) / S)；算术右移即向下取整
+    inline bool PixelCenterBounds(const int64_t (&fx)[3], const int64_t (&fy)[3], int width, int height, int& minX, int& maxX, int& minY, int& maxY) {
+        minX = (int)std::max<int64_t>(0, (std::min({fx[0], fx[1], fx[2]}) - SUBPIXEL_HALF + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS);
+        maxX = (int)std::min<int64_t>(width, ((std::max({fx[0], fx[1], fx[2]}) - SUBPIXEL_HALF) >> SUBPIXEL_BITS) + 1);
+        minY = (int)std::max<int64_t>(0, (std::min({fy[0], fy[1], fy[2]}) - SUBPIXEL_HALF + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS);
+        maxY = (int)std::min<int64_t>(height, ((std::max({fy[0], fy[1], fy[2]}) - SUBPIXEL_HALF) >> SUBPIXEL_BITS) + 1);
+        return minX < maxX && minY < maxY;
+    }
+
+    // 屏幕空间三角形的包围盒内是否有像素中心；没有则光栅化时一定不覆盖任何像素
+    //? 致密网格中大量三角形落在像素中心之间，顶点阶段用它丢弃，不再进入片元阶段
+    inline bool HasPixelCenterInBounds(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2, int width, int height) {
+        int64_t fx[3], fy[3];
+        int minX, maxX, minY, maxY;
+        return SnapToFixed(v0, v1, v2, fx, fy) && PixelCenterBounds(fx, fy, width, height, minX, maxX, minY, maxY);
+    }
+
+    // 光栅化屏幕空间三角形（视口变换之后，z 为 NDC 深度），对覆盖的每个像素中心调用 fn
+    template<RasterMode Mode, typename FragmentFn>
+    inline void RasterizeTriangle(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2, int width, int height, FragmentFn&& fn) {
+        //* 1. 吸附到定点
+        int64_t fx[3], fy[3];
+        if (!SnapToFixed(v0, v1, v2, fx, fy)) {
+            return;
+        }
+
+        //* 2. 按像素中心收紧包围盒
+        //? 包围盒里一个像素中心都没有的三角形在这里就结束，不做任何边函数设置
+        int minX, maxX, minY, maxY;
+        if (!PixelCenterBounds(fx, fy, width, height, minX, maxX, minY, maxY)) {
+            return;
+        }
+
+        int64_t area = (fx[1] - fx[0]) * (fy[2] - fy[0]) - (fy[1] - fy[0]) * (fx[2] - fx[0]);
+        if (area == 0) {
+            return; // 退化三角形（吸附后面积为零）
+        }
+
+        // 统一成逆时针，边函数在内部为正
+        const Vector4f* p[3] = {&v0, &v1, &v2};
+        const bool flipped = area < 0;
+        if (flipped) {
+            std::swap(p[1], p[2]);
+            std::swap(fx[1], fx[2]);
+            std::swap(fy[1], fy[2]);
+            area = -area;
+        }
+
+        //* 3. 边函数 E_i(x, y) = A_i * x + B_i * y + C_i，边 i 与顶点 i 相对
+        //? 左上规则写成偏置：不是左边或上边的边，E == 0 也算在外，测试统一为 E + bias >= 0
+        int64_t A[3], B[3], C[3], bias[3];
+        for (int i = 0; i < 3; ++i) {
+            int from = (i + 1) % 3, to = (i + 2) % 3;
+            int64_t dx = fx[to] - fx[from];
+            int64_t dy = fy[to] - fy[from];
+            A[i] = -dy;
+            B[i] = dx;
+            C[i] = dy * fx[from] - dx * fy[from];
+            // 逆时针且 y 轴向上：向下走的边是左边，向左走的水平边是上边
+            bool topLeft = dy < 0 || (dy == 0 && dx < 0);
+            bias[i] = topLeft ? 0 : -1;
+        }
+
+        const float invArea = 1.0f / (float)area;
+        const float z0 = p[0]->z(), z1 = p[1]->z(), z2 = p[2]->z();
+
+        // 覆盖像素：按传入的顶点顺序给出重心坐标
+        auto emit = [&](int x, int y, int64_t e0, int64_t e1, float z) {
+            if constexpr (Mode == RasterMode::DepthOnly) {
+                fn(x, y, z);
+            } else {
+                float l[3];
+                l[0] = (float)(e0 - bias[0]) * invArea;
+                l[1] = (float)(e1 - bias[1]) * invArea;
+                l[2] = 1.0f - l[0] - l[1];
+                if (flipped) {
+                    std::swap(l[1], l[2]);
+                }
+                fn(x, y, z, l[0], l[1], l[2]);
+            }
+        };
+
+        //* 4. 小三角形：包围盒内最多 SMALL_TRIANGLE_SIZE² 个像素中心，逐个直接求边函数，不做步进设置
+        if (maxX - minX <= SMALL_TRIANGLE_SIZE && maxY - minY <= SMALL_TRIANGLE_SIZE) {
+            for (int y = minY; y < maxY; ++y) {
+                const int64_t cy = y * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+                for (int x = minX; x < maxX; ++x) {
+                    const int64_t cx = x * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+                    int64_t e0 = A[0] * cx + B[0] * cy + C[0] + bias[0];
+                    int64_t e1 = A[1] * cx + B[1] * cy + C[1] + bias[1];
+                    int64_t e2 = A[2] * cx + B[2] * cy + C[2] + bias[2];
+                    if ((e0 | e1 | e2) < 0) {
+                        continue;
+                    }
+                    float z = ((float)(e0 - bias[0]) * z0 + (float)(e1 - bias[1]) * z1 + (float)(e2 - bias[2]) * z2) * invArea;
+                    emit(x, y, e0, e1, z);
+                }
+            }
+            return;
+        }
+
+        //* 5. 一般三角形：逐行步进
+        const int64_t stepX[3] = {A[0] * SUBPIXEL_SCALE, A[1] * SUBPIXEL_SCALE, A[2] * SUBPIXEL_SCALE};
+        // 深度在屏幕空间线性，按平面方程逐像素步进
+        const float dzdx = ((float)A[0] * z0 + (float)A[1] * z1 + (float)A[2] * z2) * SUBPIXEL_SCALE * invArea;
+
+        //? 包围盒较宽时（大三角形、保护带内越出屏幕的三角形）按边函数解出每行的覆盖区间，
+        //? 只遍历区间内的像素，工作量与实际覆盖面积成正比；区间两端各放宽一个像素，由逐像素的整数测试定最终覆盖
+        const bool useSpans = maxX - minX > RASTER_SPAN_MIN_WIDTH;
+
+        for (int y = minY; y < maxY; ++y) {
+            const int64_t cy = y * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+            int spanBegin = minX, spanEnd = maxX;
+            if (useSpans) {
+                //* E_i = A_i * cx + r_i >= 0，A_i > 0 时给出左端，A_i < 0 时给出右端（cx 为定点的像素中心）
+                double left = minX, right = maxX;
+                bool empty = false;
+                for (int i = 0; i < 3; ++i) {
+                    double r = (double)(B[i] * cy + C[i]);
+                    if (A[i] != 0) {
+                        double x = (-r / (double)A[i] - SUBPIXEL_HALF) / SUBPIXEL_SCALE;
+                        if (A[i] > 0) {
+                            left = std::max(left, x);
+                        } else {
+                            right = std::min(right, x + 1.0);
+                        }
+                    } else if (r < 0.0) {
+                        empty = true; // 水平边之外的整行
+                    }
+                }
+                if (empty || left > right) {
+                    continue;
+                }
+                spanBegin = std::max(minX, (int)std::floor(left) - 1);
+                spanEnd = std::min(maxX, (int)std::ceil(right) + 1);
+            }
+
+            const int64_t cx = spanBegin * SUBPIXEL_SCALE + SUBPIXEL_HALF;
+            int64_t e0 = A[0] * cx + B[0] * cy + C[0] + bias[0];
+            int64_t e1 = A[1] * cx + B[1] * cy + C[1] + bias[1];
+            int64_t e2 = A[2] * cx + B[2] * cy + C[2] + bias[2];
+            float z = ((float)(e0 - bias[0]) * z0 + (float)(e1 - bias[1]) * z1 + (float)(e2 - bias[2]) * z2) * invArea;
+
+            for (int x = spanBegin; x < spanEnd; ++x, e0 += stepX[0], e1 += stepX[1], e2 += stepX[2], z += dzdx) {
+                if ((e0 | e1 | e2) < 0) {
+                    continue; // 任一边函数为负（符号位）即在外
+                }
+
+                emit(x, y, e0, e1, z);
+            }
+        }
+    }
+}
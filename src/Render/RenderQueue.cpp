@@ -0,0 +1,122 @@
+/// FileName: RenderQueue.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "RenderQueue.hpp"
+
+namespace aries::render {
+    void RenderQueue::Update(const model::ShapeStore& store) {
+        m_stats.rebuilt = false;
+        if (store.GetStateVersion() == m_stateVersion) {
+            return;
+        }
+        m_stateVersion = store.GetStateVersion();
+        m_stats.rebuilt = true;
+
+        const uint32_t rowCount = store.Size();
+        m_rows.assign(rowCount, RowKey{});
+
+        //* 1. 状态序号：有材质的行按（着色器、纹理、材质）排序后依次编号
+        struct RowState {
+            ShaderType shader;
+            const Texture* texture;
+            const IMaterial* material;
+            uint32_t row;
+        };
+        vector<RowState> states;
+        states.reserve(rowCount);
+        for (uint32_t row = 0; row < rowCount; ++row) {
+            if (const IMaterial* material = store.GetMaterial(row)) {
+                states.push_back({material->GetShaderType(), material->GetTexture(), material, row});
+            }
+        }
+        std::sort(states.begin(), states.end(), [](const RowState& a, const RowState& b) {
+            return std::tuple(a.shader, a.texture, a.material) < std::tuple(b.shader, b.texture, b.material);
+        });
+        uint32_t rank = 0;
+        for (size_t i = 0; i < states.size(); ++i) {
+            if (i > 0 && states[i].material != states[i - 1].material) {
+                ++rank;
+            }
+            m_rows[states[i].row].stateRank = std::min(rank, INVALID_RANK - 1);
+            m_rows[states[i].row].texture = states[i].texture;
+        }
+        m_stats.states = states.empty() ? 0 : (int)rank + 1;
+
+        //* 2. 网格序号：只用于让同一网格相邻，按地址编号即可
+        vector<std::pair<const model::Mesh*, uint32_t>> meshes;
+        meshes.reserve(rowCount);
+        for (uint32_t row = 0; row < rowCount; ++row) {
+            meshes.emplace_back(store.GetMesh(row), row);
+        }
+        std::sort(meshes.begin(), meshes.end());
+        rank = 0;
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            if (i > 0 && meshes[i].first != meshes[i - 1].first) {
+                ++rank;
+            }
+            m_rows[meshes[i].second].meshRank = std::min(rank, INVALID_RANK);
+        }
+    }
+
+    void RenderQueue::Sort(vector<VisibleShape>& shapes, const model::ShapeStore& store, const Matrix4f& view, bool depthSort) {
+        m_stats.items = (int)shapes.size();
+        CountChanges(shapes, m_stats.unsortedShaderChanges, m_stats.unsortedMaterialChanges, m_stats.unsortedTextureChanges);
+
+        //* 1. 拼出排序键，深度取世界包围盒最近处的视图深度（中心深度减去半对角线）
+        m_order.resize(shapes.size());
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            const RowKey& row = m_rows[shapes[i].row];
+            uint64_t bucket = 0;
+            if (depthSort) {
+                const model::AABB& box = store.GetWorldBox(shapes[i].row);
+                Vector3f center = box.Center();
+                float depth = -(view.row(2).head<3>().dot(center) + view(2, 3)) - box.Extents().norm(); // 视图空间朝 -z 看
+                bucket = (uint64_t)DepthBucket(depth);
+            }
+            uint64_t key = (uint64_t)row.stateRank << 40 | bucket << 34 | (uint64_t)row.meshRank << 10 |
+                           (uint64_t)std::clamp(shapes[i].shape->lodIndex, 0, 1023);
+            m_order[i] = {key, (uint32_t)i};
+        }
+
+        //* 2. 整数键排序，键相同时保持剔除输出的顺序
+        std::sort(m_order.begin(), m_order.end());
+        m_sorted.resize(shapes.size());
+        for (size_t i = 0; i < m_order.size(); ++i) {
+            m_sorted[i] = shapes[m_order[i].second];
+        }
+        shapes.swap(m_sorted);
+
+        CountChanges(shapes, m_stats.shaderChanges, m_stats.materialChanges, m_stats.textureChanges);
+    }
+
+    int RenderQueue::DepthBucket(float depth) {
+        if (!(depth > MIN_BUCKET_DEPTH)) {
+            return 0; // 与摄像机相交或在身后（也包括 NaN）
+        }
+        int bucket = 1 + (int)(std::log2(depth / MIN_BUCKET_DEPTH) * BUCKETS_PER_OCTAVE);
+        return std::min(bucket, DEPTH_BUCKETS - 1);
+    }
+
+    void RenderQueue::CountChanges(const vector<VisibleShape>& shapes, int& shaderChanges, int& materialChanges, int& textureChanges) const {
+        shaderChanges = materialChanges = textureChanges = 0;
+        const IMaterial* lastMaterial = nullptr;
+        const Texture* lastTexture = nullptr;
+        ShaderType lastShader{};
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            const IMaterial* material = shapes[i].material;
+            if (i > 0 && material == lastMaterial) {
+                continue;
+            }
+            const RowKey& row = m_rows[shapes[i].row];
+            ShaderType shader = material->GetShaderType();
+            //? 第一个形状也算一次切换（绑定初始状态），与排序前后的计数口径一致
+            shaderChanges += i == 0 || shader != lastShader;
+            textureChanges += i == 0 || row.texture != lastTexture;
+            ++materialChanges;
+            lastMaterial = material;
+            lastTexture = row.texture;
+            lastShader = shader;
+        }
+    }
+}
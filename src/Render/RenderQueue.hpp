@@ -0,0 +1,67 @@
+/// FileName: RenderQueue.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 渲染队列：按（着色器、纹理、材质、深度分段、网格）排序本帧可见形状，减少状态切换并让材质内由近到远绘制
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Renderer.hpp"
+#include "ShapeStore.hpp"
+
+namespace aries::render {
+    // 渲染队列统计，"按剔除顺序"为不排序、直接按剔除输出顺序绘制时的切换次数
+    struct RenderQueueStats {
+        int items = 0;                   // 本帧排序的形状数
+        int states = 0;                  // 存储中不同的（着色器、纹理、材质）组合数
+        int shaderChanges = 0;           // 排序后的着色器切换次数
+        int materialChanges = 0;         // 排序后的材质切换次数
+        int textureChanges = 0;          // 排序后的纹理切换次数
+        int unsortedShaderChanges = 0;   // 按剔除顺序的着色器切换次数
+        int unsortedMaterialChanges = 0; // 按剔除顺序的材质切换次数
+        int unsortedTextureChanges = 0;  // 按剔除顺序的纹理切换次数
+        bool rebuilt = false;            // 本帧是否因场景变化重建了排序键
+    };
+
+    // 持久的渲染队列，每个存储行缓存一个状态序号与网格序号，只在存储的状态版本变化（增删形状、换网格或材质）时重建；
+    // 每帧只为可见形状拼出 64 位整数键排序
+    //? 键从高到低为：状态序号（着色器 → 纹理 → 材质）、深度分段、网格序号、LOD 级别；
+    //? 材质决定纹理，按纹理排列材质后纹理切换不多于材质切换；同一分段内同一网格相邻，渲染器仍能合批为多实例绘制；
+    //? 片元阶段先做深度测试再着色，材质内由近到远绘制时被挡住的像素不再着色
+    class RenderQueue {
+    public:
+        static constexpr int DEPTH_BUCKETS = 64;           // 深度分段数
+        static constexpr float BUCKETS_PER_OCTAVE = 4.0f;  // 视图深度每增大一倍跨过的分段数
+        static constexpr float MIN_BUCKET_DEPTH = 1.0f / 16.0f; // 第 0 段的深度上限，更近的形状都归入第 0 段
+
+        // 存储状态变化时重建每行的状态与网格序号，需在 store.Sync() 之后调用
+        void Update(const model::ShapeStore& store);
+
+        // 把本帧的可见形状按键排序，depthSort 为 false 时不分深度段
+        void Sort(vector<VisibleShape>& shapes, const model::ShapeStore& store, const Matrix4f& view, bool depthSort);
+
+        const RenderQueueStats& GetStats() const { return m_stats; }
+
+    private:
+        static constexpr uint32_t INVALID_RANK = (1u << 24) - 1;
+
+        // 每个存储行的排序信息
+        struct RowKey {
+            uint32_t stateRank = INVALID_RANK; // 没有材质的行为 INVALID_RANK，不会进入可见列表
+            uint32_t meshRank = 0;
+            const Texture* texture = nullptr;
+        };
+
+        uint64_t m_stateVersion = std::numeric_limits<uint64_t>::max();
+        vector<RowKey> m_rows;
+        vector<std::pair<uint64_t, uint32_t>> m_order; // 每帧复用：（键，可见列表下标）
+        vector<VisibleShape> m_sorted;
+        RenderQueueStats m_stats;
+
+        // 视图深度 → 深度分段
+        static int DepthBucket(float depth);
+
+        // 按 shapes 当前顺序统计着色器、材质与纹理切换次数
+        void CountChanges(const vector<VisibleShape>& shapes, int& shaderChanges, int& materialChanges, int& textureChanges) const;
+    };
+}
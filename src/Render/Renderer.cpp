@@ -11,15 +11,91 @@ namespace aries::render {
         m_raster = std::move(raster);
         _zBuffer.resize(w * h);
 
-        _viewport <<    _width / 2., 0, 0, _width / 2., 
-                        0, _height / 2., 0, _height / 2., 
-                        0, 0, 1, 0, 
-                        0, 0, 0, 1;
+        _viewport = FrameContext::BuildViewportMatrix(w, h);
     }
 
     void Renderer::Clear() {
+        m_stats = {};
         m_raster->ClearCurrentBuffer();
         std::fill(_zBuffer.begin(), _zBuffer.end(), /*std::numeric_limits<float>::infinity()*/ std::numeric_limits<float>::max()); // 或者使用最大值
+
+        if (m_shadowMaskMode != shadow::ShadowMaskMode::Off) {
+            std::fill(_prepassBuffer.begin(), _prepassBuffer.end(), std::numeric_limits<uint64_t>::max());
+            m_primitiveReceivers.clear();
+            m_shadowReceivers.clear();
+            m_deferredShading.clear();
+            m_primitiveCount = 0;
+        }
+    }
+
+    void Renderer::SetShadowMaskMode(shadow::ShadowMaskMode mode) {
+        m_shadowMaskMode = mode;
+        if (mode != shadow::ShadowMaskMode::Off && _primitiveBuffer.empty()) {
+            // 第一次启用时才分配预深度相关的缓冲
+            _primitiveBuffer.resize(_width * _height, INVALID_PRIMITIVE);
+            _prepassBuffer.resize(_width * _height, std::numeric_limits<uint64_t>::max());
+            m_shadowMask.Resize(_width, _height);
+        }
+    }
+
+    void Renderer::UnpackPrepass() {
+        const int count = _width * _height;
+#pragma omp parallel for schedule(static)
+        for (int i = 0; i < count; ++i) {
+            const uint64_t packed = _prepassBuffer[i];
+            const uint32_t prim = (uint32_t)packed;
+            _primitiveBuffer[i] = prim;
+            if (prim != INVALID_PRIMITIVE) {
+                _zBuffer[i] = KeyToDepth((uint32_t)(packed >> 32));
+            }
+        }
+    }
+
+    void Renderer::ResolveDeferredShading() {
+        if (m_deferredShading.empty()) {
+            return;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        UnpackPrepass();
+        auto tUnpack = std::chrono::steady_clock::now();
+        m_stats.prepassMs += std::chrono::duration<float, std::milli>(tUnpack - t0).count();
+        t0 = tUnpack;
+
+        //* 由像素中心和 NDC 深度还原世界坐标，逆变换后的 w 分量即 1 / 裁剪空间 w
+        const Matrix4f& invViewProjection = m_frame->invViewProjection;
+        if (m_scene && m_scene->directionalShadow) {
+            m_shadowMask.Resolve(m_shadowMaskMode, *m_scene->directionalShadow, [&](int x, int y) {
+                shadow::ShadowMaskSurface surface;
+                int idx = GetPixelIndex(x, y);
+                uint32_t prim = _primitiveBuffer[idx];
+                if (prim == INVALID_PRIMITIVE || m_primitiveReceivers[prim] < 0) {
+                    return surface;
+                }
+                Vector4f ndc(
+                    (x + 0.5f) / _width * 2.0f - 1.0f,
+                    (y + 0.5f) / _height * 2.0f - 1.0f,
+                    _zBuffer[idx],
+                    1.0f
+                );
+                Vector4f world = invViewProjection * ndc;
+                surface.settings = &m_shadowReceivers[m_primitiveReceivers[prim]];
+                surface.worldPos = world.head<3>() / world.w();
+                surface.viewDepth = 1.0f / world.w();
+                return surface;
+            });
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+
+        for (auto& shade : m_deferredShading) {
+            shade();
+        }
+        m_deferredShading.clear();
+
+        auto t2 = std::chrono::steady_clock::now();
+        m_stats.shadowMaskMs += std::chrono::duration<float, std::milli>(t1 - t0).count();
+        m_stats.fragmentStageMs += std::chrono::duration<float, std::milli>(t2 - t1).count();
     }
 
     void Renderer::SetCameraAndScene(sptr<Camera> camera, sptr<Scene> scene) {
@@ -27,150 +103,301 @@ namespace aries::render {
         m_scene = std::move(scene);
     }
 
-    Matrix4f Renderer::GetViewMatrix() {
-        auto& c = *m_camera;
+    void Renderer::DrawLine3D(Vector3f start, Vector3f end, Vector3f color, bool ignoreDepthTest) {
+        m_overlayLines.Clear();
+        m_overlayLines.style = {};
+        m_overlayLines.style.depthTest = !ignoreDepthTest;
+        m_overlayLines.style.depthWrite = !ignoreDepthTest;
+        m_overlayLines.Add(start, end, color);
+        DrawLines(m_overlayLines);
+    }
+
+    void Renderer::DrawLines(const LineBatch& batch) {
+        if (batch.Empty()) {
+            return;
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
 
-        c.ApplyEluaAngle(); // 应用欧拉角到摄像机方向和上向量
+        const FrameContext& frame = *m_frame;
+        const auto& points = batch.GetPoints();
+        const Eigen::Index pointCount = static_cast<Eigen::Index>(points.size());
 
-        // 将摄像机移动到原点，然后使用旋转矩阵的正交性让摄像机摆正
-        Matrix4f move; // 移动矩阵
-        Vector3f right; // 摄像机的x轴
-        Matrix4f rotateT; // 旋转矩阵的转置矩阵
+        //* 1. 所有端点一次变换到视图空间
+        //? 端点在批次中连续存放，直接映射成 4×2N 的矩阵，Eigen 按列向量化做矩阵乘法
+        Eigen::Map<const Eigen::Matrix<float, 4, Eigen::Dynamic>> worldPoints(points.front().data(), 4, pointCount);
+        m_lineView.resize(4, pointCount);
+        m_lineView.noalias() = frame.view * worldPoints;
 
-        move << 1, 0, 0, -c.Position.x(), 0, 1, 0, -c.Position.y(), 0, 0, 1, -c.Position.z(), 0, 0, 0,
-            1;
+        //* 2. 裁剪近平面 (-z 是朝向摄像机前方)
+        const float nearZ = -frame.nearPlane;
+        m_screenLines.clear();
+        for (uint32_t i = 0; i < batch.Size(); ++i) {
+            auto start = m_lineView.col(2 * i);
+            auto end = m_lineView.col(2 * i + 1);
+            bool startBehind = start.z() > nearZ;
+            bool endBehind = end.z() > nearZ;
+            if (startBehind && endBehind) {
+                continue; // 两个点都在摄像机后面或太靠近，不绘制
+            }
+            if (startBehind) {
+                float t = (nearZ - start.z()) / (end.z() - start.z());
+                start = start + t * (end - start);
+            }
+            else if (endBehind) {
+                float t = (nearZ - end.z()) / (start.z() - end.z());
+                end = end + t * (start - end);
+            }
+            ScreenLine line{};
+            line.index = i;
+            m_screenLines.push_back(line);
+        }
+        if (m_screenLines.empty()) {
+            return;
+        }
 
-        right = c.Direction.cross(c.Up);
+        //* 3. 一次投影到屏幕并做透视除法
+        //? 被丢弃线段的 w 可能为 0，除出的无穷大不会被读取
+        m_lineScreen.resize(4, pointCount);
+        m_lineScreen.noalias() = frame.viewportProjection * m_lineView;
+        m_lineScreen.topRows<3>().array().rowwise() /= m_lineScreen.row(3).array();
 
-        rotateT << right.x(), right.y(), right.z(), 0, c.Up.x(), c.Up.y(), c.Up.z(), 0,
-            -c.Direction.x(), -c.Direction.y(), -c.Direction.z(), 0, 0, 0, 0, 1;
+        //* 4. 剔除完全在屏幕外的线段，算出每条线段的光栅化参数
+        const LineStyle& style = batch.style;
+        const float halfWidth = style.width * 0.5f;
+        size_t kept = 0;
+        for (const auto& clipped : m_screenLines) {
+            Vector3f a = m_lineScreen.col(2 * clipped.index).head<3>();
+            Vector3f b = m_lineScreen.col(2 * clipped.index + 1).head<3>();
+            float minX = std::min(a.x(), b.x());
+            float maxX = std::max(a.x(), b.x());
+            float minY = std::min(a.y(), b.y());
+            float maxY = std::max(a.y(), b.y());
 
-        return rotateT * move;
-    }
+            ScreenLine line;
+            line.index = clipped.index;
+            line.steep = std::abs(b.y() - a.y()) > std::abs(b.x() - a.x());
+            if (line.steep) {
+                a = Vector3f(a.y(), a.x(), a.z());
+                b = Vector3f(b.y(), b.x(), b.z());
+            }
+            if (a.x() > b.x()) {
+                std::swap(a, b);
+            }
+            float du = b.x() - a.x();
+            line.au = a.x();
+            line.av = a.y();
+            line.az = a.z();
+            line.bu = b.x();
+            line.slope = du > 0.0f ? (b.y() - a.y()) / du : 0.0f;
+            line.zSlope = du > 0.0f ? (b.z() - a.z()) / du : 0.0f;
+            line.secant = std::sqrt(1.0f + line.slope * line.slope);
 
-    Matrix4f Renderer::GetClipMatrix() {
-        auto& c = *m_camera;
-        float radFov;
-        Matrix4f frustum;
+            //? 外扩量与 RasterizeLine 的副轴覆盖范围一致（斜线要乘 1/cos），四个方向都放宽，宽线和抗锯齿边缘伸进屏幕或相邻分带时不会丢
+            const float margin = (style.antiAlias ? halfWidth + 0.5f : std::max(halfWidth, 0.5f)) * line.secant + 1.0f;
+            minX -= margin;
+            maxX += margin;
+            minY -= margin;
+            maxY += margin;
+            if (maxX < 0.0f || minX >= _width || maxY < 0.0f || minY >= _height) {
+                continue;
+            }
+            line.minY = minY;
+            line.maxY = maxY;
+            m_screenLines[kept++] = line;
+        }
+        m_screenLines.resize(kept);
+        m_stats.lineSegments += static_cast<int>(kept);
+
+        //* 5. 光栅化
+        //? 线段很少或只有一个线程时分带只有开销，直接整屏按提交顺序画
+        if (m_screenLines.size() < LINE_PARALLEL_MIN || omp_get_max_threads() == 1) {
+            for (const auto& line : m_screenLines) {
+                RasterizeLine(line, batch.GetColor(line.index), style, 0, _height);
+            }
+        }
+        else {
+            //* 按覆盖的行分带（计数排序，带内保持提交顺序），各带并行，每个线程只写自己带内的行
+            const int bandCount = (_height + LINE_BAND_HEIGHT - 1) / LINE_BAND_HEIGHT;
+            auto bandOf = [&](float y) {
+                float clamped = std::clamp(y, 0.0f, static_cast<float>(_height - 1));
+                return static_cast<int>(clamped) / LINE_BAND_HEIGHT;
+            };
 
-        radFov = ToRadian(c.Fov);
+            m_lineBandOffsets.assign(bandCount + 1, 0);
+            for (const auto& line : m_screenLines) {
+                for (int band = bandOf(line.minY), last = bandOf(line.maxY); band <= last; ++band) {
+                    ++m_lineBandOffsets[band + 1];
+                }
+            }
+            for (int band = 0; band < bandCount; ++band) {
+                m_lineBandOffsets[band + 1] += m_lineBandOffsets[band];
+            }
+            m_lineBandItems.resize(m_lineBandOffsets[bandCount]);
+            m_lineBandCursor.assign(m_lineBandOffsets.begin(), m_lineBandOffsets.end() - 1);
+            for (uint32_t i = 0; i < m_screenLines.size(); ++i) {
+                const auto& line = m_screenLines[i];
+                for (int band = bandOf(line.minY), last = bandOf(line.maxY); band <= last; ++band) {
+                    m_lineBandItems[m_lineBandCursor[band]++] = i;
+                }
+            }
 
-        frustum << 1 / (c.AspectRatio * tan(radFov / 2)), 0, 0, 0, 0, 1 / tan(radFov / 2), 0, 0, 0, 0,
-            -(c.Far + c.Near) / (c.Far - c.Near), -(2 * c.Far * c.Near) / (c.Far - c.Near), 0, 0, -1, 0;
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int band = 0; band < bandCount; ++band) {
+                int rowBegin = band * LINE_BAND_HEIGHT;
+                int rowEnd = std::min(rowBegin + LINE_BAND_HEIGHT, _height);
+                for (int k = m_lineBandOffsets[band]; k < m_lineBandOffsets[band + 1]; ++k) {
+                    const auto& line = m_screenLines[m_lineBandItems[k]];
+                    RasterizeLine(line, batch.GetColor(line.index), style, rowBegin, rowEnd);
+                }
+            }
+        }
 
-        return frustum;
+        auto t1 = std::chrono::steady_clock::now();
+        m_stats.lineMs += std::chrono::duration<float, std::milli>(t1 - t0).count();
     }
 
-    void Renderer::DrawLine3D(Vector3f start, Vector3f end, Vector3f color, bool ignoreDepthTest) {
-        Vector4f startPos(start.x(), start.y(), start.z(), 1.0f);
-        Vector4f endPos(end.x(), end.y(), end.z(), 1.0f);
+    void Renderer::RasterizeLine(const ScreenLine& line, const Vector3f& color, const LineStyle& style, int rowBegin, int rowEnd) {
+        const bool steep = line.steep;
+        const int majorLimit = steep ? _height : _width;
+        const int minorLimit = steep ? _width : _height;
 
-        // 先只应用视图矩阵，检查点是否在摄像机前面
-        Matrix4f viewMatrix = GetViewMatrix();
-        Vector4f startView = viewMatrix * startPos;
-        Vector4f endView = viewMatrix * endPos;
-        
-        // 检查点是否在摄像机后面 (-z 是朝向摄像机前方)
-        const float NEAR_CLIP = 0.1f; //? 暂时不使用与摄像机的近平面一致的值
-        
-        // 两个点都在摄像机后面或太靠近，不绘制
-        if (startView.z() > -NEAR_CLIP && endView.z() > -NEAR_CLIP) {
-            return;
+        //? 副轴方向上的线宽要乘以 1/cos，斜线才和水平线一样粗；抗锯齿时向外多半个像素做过渡
+        const float halfWidth = style.width * 0.5f;
+        const bool thin = !style.antiAlias && style.width <= 1.0f;
+        const float reach = thin ? 0.5f : (halfWidth + (style.antiAlias ? 0.5f : 0.0f)) * line.secant;
+
+        //* 1. 主轴范围：端点所在像素之间（含两端），限制在屏幕内
+        float uFirst = std::max(std::floor(line.au), 0.0f);
+        float uLast = std::min(std::floor(line.bu), static_cast<float>(majorLimit - 1));
+
+        //* 2. 限制在 [rowBegin, rowEnd) 行内
+        int minorBegin = 0, minorEnd = minorLimit - 1;
+        if (steep) {
+            uFirst = std::max(uFirst, static_cast<float>(rowBegin));
+            uLast = std::min(uLast, static_cast<float>(rowEnd - 1));
         }
-        
-        // 如果一个点在摄像机后面，需要裁剪到近平面
-        if (startView.z() > -NEAR_CLIP) {
-            // 计算裁剪因子
-            float t = (-NEAR_CLIP - startView.z()) / (endView.z() - startView.z());
-            startView = startView + t * (endView - startView);
+        else {
+            minorBegin = rowBegin;
+            minorEnd = rowEnd - 1;
+            //? 由斜率反解线段经过这些行的主轴区间，两端各放宽一个像素
+            float lo = rowBegin - reach - 1.0f;
+            float hi = rowEnd + reach + 1.0f;
+            if (std::abs(line.slope) > 1e-6f) {
+                float u0 = line.au + (lo - line.av) / line.slope;
+                float u1 = line.au + (hi - line.av) / line.slope;
+                if (u0 > u1) {
+                    std::swap(u0, u1);
+                }
+                uFirst = std::max(uFirst, std::floor(u0) - 1.0f);
+                uLast = std::min(uLast, std::ceil(u1) + 1.0f);
+            }
+            else if (line.av < lo || line.av > hi) {
+                return;
+            }
         }
-        else if (endView.z() > -NEAR_CLIP) {
-            // 计算裁剪因子
-            float t = (-NEAR_CLIP - endView.z()) / (startView.z() - endView.z());
-            endView = endView + t * (startView - endView);
+        if (uFirst > uLast) {
+            return;
         }
-        
-        // 应用投影和视口变换
-        Matrix4f projViewport = _viewport * GetClipMatrix();
-        Vector4f startVP = projViewport * startView;
-        Vector4f endVP = projViewport * endView;
-
-        // 透视除法
-        Vector3f startScreen(startVP.x() / startVP.w(), startVP.y() / startVP.w(), startVP.z() / startVP.w());
-        Vector3f endScreen(endVP.x() / endVP.w(), endVP.y() / endVP.w(), endVP.z() / endVP.w());
-
-        // Bresenham算法绘制线
-        int x0 = static_cast<int>(startScreen.x());
-        int y0 = static_cast<int>(startScreen.y());
-        int x1 = static_cast<int>(endScreen.x());
-        int y1 = static_cast<int>(endScreen.y());
-
-        bool steep = false, swapStartEnd = false;
-        if (std::abs(x0 - x1) < std::abs(y0 - y1)) {
-            std::swap(x0, y0);
-            std::swap(x1, y1);
-            steep = true;
-        }
-
-        if (x0 > x1) {
-            std::swap(x0, x1);
-            std::swap(y0, y1);
-            swapStartEnd = true;
-        }
-
-        int dx = x1 - x0;
-        int dy = y1 - y0;
-        int derror2 = std::abs(dy) * 2;
-        int error2 = 0;
-        int y = y0;
-
-        for (int x = x0; x <= x1; x++) {
-            int drawX = steep ? y : x;
-            int drawY = steep ? x : y;
-
-            if (drawX >= 0 && drawX < _width && drawY >= 0 && drawY < _height) {
-                //* 插值
-                float t = (float)(x - x0) / std::max(1, dx);
-                if (swapStartEnd) t = 1 - t;
-                
-                float depth = ((1 - t) * startScreen.z() + t * endScreen.z());
-                
-                // 应用深度测试
-                int idx = GetPixelIndex(drawX, drawY);
-                if (ignoreDepthTest || _zBuffer[idx] > depth) {
-                    if (!ignoreDepthTest) _zBuffer[idx] = depth;
-                    SetPixelColor(drawX, drawY, color);
+
+        //? 深度缓冲下标 = x + (H - 1 - y) * W，写成主轴与副轴坐标的线性组合，逐像素不再分支
+        float* depth = _zBuffer.data();
+        const int majorStride = steep ? -_width : 1;
+        const int minorStride = steep ? 1 : -_width;
+        const int baseIndex = (_height - 1) * _width;
+        const bool depthTest = style.depthTest;
+        const bool depthWrite = style.depthWrite;
+
+        //? 深度测试放在循环内，通过测试的像素才调用写入
+        auto write = [&](int u, int j, int idx, float z, float coverage) {
+            int x = steep ? j : u;
+            int y = steep ? u : j;
+            if (coverage >= 1.0f) {
+                SetPixelColor(x, y, color);
+                if (depthWrite) {
+                    depth[idx] = z;
                 }
+                return;
             }
+            //? 部分覆盖的像素与帧缓冲中已有的颜色混合，覆盖率过半才写深度，避免边缘挡住后画的线
+            Raster::color_t r, g, b;
+            m_raster->GetPixel(x, y, r, g, b);
+            Vector3f dst(r / 255.0f, g / 255.0f, b / 255.0f);
+            SetPixelColor(x, y, color * coverage + dst * (1.0f - coverage));
+            if (depthWrite && coverage >= 0.5f) {
+                depth[idx] = z;
+            }
+        };
+
+        //* 3. 逐列（或逐行）计算中心线位置与深度，画出副轴方向上被覆盖的像素
+        //? t 为像素中心到起点的主轴距离，两端像素的中心可能超出线段，截到端点上
+        const int uBegin = static_cast<int>(uFirst);
+        const int uEnd = static_cast<int>(uLast);
+        const float du = line.bu - line.au;
+        const float vLimit = static_cast<float>(minorEnd + 1);
+        float tCenter = uBegin + 0.5f - line.au;
+        for (int u = uBegin; u <= uEnd; ++u, tCenter += 1.0f) {
+            float t = std::clamp(tCenter, 0.0f, du);
+            float v = line.av + line.slope * t;
+            float z = line.az + line.zSlope * t;
 
-            error2 += derror2;
-            if (error2 > dx) {
-                y += (y1 > y0 ? 1 : -1);
-                error2 -= dx * 2;
+            if (thin) {
+                //? 先判断范围，负数不会进入截断取整
+                if (v >= minorBegin && v < vLimit) {
+                    int j = static_cast<int>(v);
+                    int idx = baseIndex + u * majorStride + j * minorStride;
+                    if (!depthTest || depth[idx] > z) {
+                        write(u, j, idx, z, 1.0f);
+                    }
+                }
+                continue;
+            }
+
+            int jBegin = std::max(static_cast<int>(std::ceil(v - reach - 0.5f)), minorBegin);
+            int jEnd = std::min(static_cast<int>(std::floor(v + reach - 0.5f)), minorEnd);
+            for (int j = jBegin; j <= jEnd; ++j) {
+                int idx = baseIndex + u * majorStride + j * minorStride;
+                if (depthTest && !(depth[idx] > z)) {
+                    continue;
+                }
+                float coverage = 1.0f;
+                if (style.antiAlias) {
+                    float distance = std::abs(j + 0.5f - v) / line.secant; // 像素中心到中心线的垂直距离
+                    coverage = std::clamp(halfWidth + 0.5f - distance, 0.0f, 1.0f);
+                    if (coverage <= 0.0f) {
+                        continue;
+                    }
+                }
+                write(u, j, idx, z, coverage);
             }
         }
     }
 
     void Renderer::DrawCoordinateSystem(float axisLength, bool showGrid, float gridSize, int gridCount) {
+        //? 所有线段先收集到一个批次，一次变换、裁剪与光栅化
+        LineBatch& lines = m_overlayLines;
+        lines.Clear();
+        lines.style = {};
+
         // 绘制主坐标轴
-        DrawLine3D(Vector3f(0,0,0), Vector3f(axisLength,0,0), Vector3f(1,0,0)); // X轴 (红)
-        DrawLine3D(Vector3f(0,0,0), Vector3f(0,axisLength,0), Vector3f(0,1,0)); // Y轴 (绿)
-        DrawLine3D(Vector3f(0,0,0), Vector3f(0,0,axisLength), Vector3f(0,0,1)); // Z轴 (蓝)
+        lines.Add(Vector3f(0,0,0), Vector3f(axisLength,0,0), Vector3f(1,0,0)); // X轴 (红)
+        lines.Add(Vector3f(0,0,0), Vector3f(0,axisLength,0), Vector3f(0,1,0)); // Y轴 (绿)
+        lines.Add(Vector3f(0,0,0), Vector3f(0,0,axisLength), Vector3f(0,0,1)); // Z轴 (蓝)
         
         // 绘制坐标轴箭头
         const float arrowSize = 0.1f;
         
         // X轴箭头
-        DrawLine3D(Vector3f(axisLength,0,0), Vector3f(axisLength-arrowSize,arrowSize/2,0), Vector3f(1,0,0));
-        DrawLine3D(Vector3f(axisLength,0,0), Vector3f(axisLength-arrowSize,-arrowSize/2,0), Vector3f(1,0,0));
+        lines.Add(Vector3f(axisLength,0,0), Vector3f(axisLength-arrowSize,arrowSize/2,0), Vector3f(1,0,0));
+        lines.Add(Vector3f(axisLength,0,0), Vector3f(axisLength-arrowSize,-arrowSize/2,0), Vector3f(1,0,0));
         
         // Y轴箭头
-        DrawLine3D(Vector3f(0,axisLength,0), Vector3f(arrowSize/2,axisLength-arrowSize,0), Vector3f(0,1,0));
-        DrawLine3D(Vector3f(0,axisLength,0), Vector3f(-arrowSize/2,axisLength-arrowSize,0), Vector3f(0,1,0));
+        lines.Add(Vector3f(0,axisLength,0), Vector3f(arrowSize/2,axisLength-arrowSize,0), Vector3f(0,1,0));
+        lines.Add(Vector3f(0,axisLength,0), Vector3f(-arrowSize/2,axisLength-arrowSize,0), Vector3f(0,1,0));
         
         // Z轴箭头
-        DrawLine3D(Vector3f(0,0,axisLength), Vector3f(0,arrowSize/2,axisLength-arrowSize), Vector3f(0,0,1));
-        DrawLine3D(Vector3f(0,0,axisLength), Vector3f(0,-arrowSize/2,axisLength-arrowSize), Vector3f(0,0,1));
+        lines.Add(Vector3f(0,0,axisLength), Vector3f(0,arrowSize/2,axisLength-arrowSize), Vector3f(0,0,1));
+        lines.Add(Vector3f(0,0,axisLength), Vector3f(0,-arrowSize/2,axisLength-arrowSize), Vector3f(0,0,1));
         
         // 绘制网格(如果启用)
         if (showGrid) {
@@ -180,13 +407,15 @@ namespace aries::render {
             // XZ平面网格
             for (int i = -gridCount; i <= gridCount; i++) {
                 float pos = i * gridSize;
-                DrawLine3D(Vector3f(-extent, 0, pos), Vector3f(extent, 0, pos), gridColor, false);
-                DrawLine3D(Vector3f(pos, 0, -extent), Vector3f(pos, 0, extent), gridColor, false);
+                lines.Add(Vector3f(-extent, 0, pos), Vector3f(extent, 0, pos), gridColor);
+                lines.Add(Vector3f(pos, 0, -extent), Vector3f(pos, 0, extent), gridColor);
             }
         }
+
+        DrawLines(lines);
     }
 
-    void Renderer::RenderWithShader(ShaderType type, vector<sptr<Shape>>& shapeList, uint64_t& triangleCount) {
+    void Renderer::RenderWithShader(ShaderType type, std::span<const VisibleShape> shapeList, uint64_t& triangleCount) {
         ShaderDispatcher<RegisteredShaders>::Dispatch(*this, type, shapeList, triangleCount);
     }
 }
\ No newline at end of file
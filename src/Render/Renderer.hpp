@@ -5,13 +5,22 @@
 #include "Model.hpp"
 #include "Shape.hpp"
 #include "Camera.hpp"
+#include "FrameContext.hpp"
+#include "LineBatch.hpp"
 #include "Raster.hpp"
+#include "RasterCore.hpp"
 
 #include "Shaders/ShaderRegister.hpp"
 #include "Materials/Material.hpp"
+#include "Shadow/ShadowMask.hpp"
 
 #include <omp.h>
 #include <boost/pfr.hpp>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <span>
 
 using namespace aries::shader;
 using namespace aries::material;
@@ -27,17 +36,77 @@ namespace aries::render {
         ShaderT::property_t* property; // 着色器属性
     };
 
+    // 渲染阶段统计，每帧在 Clear 时重置
+    struct RenderStats {
+        float vertexStageMs = 0.0f;   // 顶点着色（含裁剪、剔除）耗时
+        float fragmentStageMs = 0.0f; // 光栅化与片元着色耗时
+        float prepassMs = 0.0f;       // 预深度耗时（仅启用阴影遮罩时）
+        float shadowMaskMs = 0.0f;    // 屏幕空间阴影遮罩耗时
+        int drawBatches = 0;          // 顶点阶段的批次数，同一网格与材质的连续形状合为一批
+        int instancedShapes = 0;      // 以多实例批次绘制的形状数
+        int clippedTriangles = 0;     // 越过近远平面或越出保护带、需要裁剪的三角形数
+        int sampleCulledTriangles = 0; // 包围盒内没有像素中心、在顶点阶段丢弃的小三角形数
+        float lineMs = 0.0f;          // 批量画线耗时
+        int lineSegments = 0;         // 裁剪后实际光栅化的线段数
+    };
+
+    // 通过视锥剔除、需要绘制的形状
+    //? 指针指向 ShapeStore 的行与列，只在本帧内有效
+    struct VisibleShape {
+        Shape* shape = nullptr;
+        material::IMaterial* material = nullptr;
+        const Matrix4f* modelMatrix = nullptr; // 存储中缓存的模型矩阵
+        uint32_t row = 0; // 在 ShapeStore 中的行号
+        bool insideFrustum = false; // 包围盒完全在视锥内，走跳过逐三角形裁剪检查的快速路径
+    };
+
     class Renderer {
     private:
         int _width, _height;
 
+        RenderStats m_stats;
+
         Matrix4f _viewport;
 
         //std::vector<Vector3f> _frameBuffer;
         vector<float> _zBuffer;
+
+        //* 屏幕空间阴影遮罩相关：启用时先做预深度，记录每像素可见图元，再逐像素算阴影，最后只着色可见片元
+        static constexpr uint32_t INVALID_PRIMITIVE = std::numeric_limits<uint32_t>::max();
+        shadow::ShadowMaskMode m_shadowMaskMode = shadow::ShadowMaskMode::Off;
+        shadow::ShadowMask m_shadowMask;
+        vector<uint32_t> _primitiveBuffer;   // 每像素可见图元编号
+        vector<uint64_t> _prepassBuffer;     // 预深度时每像素的（深度键 << 32 | 图元编号），整体原子地取最小值
+        vector<int> m_primitiveReceivers;    // 图元 → 阴影接收设置下标，-1 表示不接收
+        vector<shadow::ShadowFilterSettings> m_shadowReceivers;
+        vector<std::function<void()>> m_deferredShading; // 等待遮罩完成后执行的着色任务
+        uint32_t m_primitiveCount = 0;
+
         sptr<Raster> m_raster;
         sptr<Camera> m_camera;
         sptr<Scene> m_scene;
+        const FrameContext* m_frame = nullptr; // 本帧常量，由管线持有
+
+        //* 批量画线，各缓冲在每次 DrawLines 之间复用
+        static constexpr int LINE_BAND_HEIGHT = 32;   // 按屏幕行分带并行，每个线程独占一带，不需要同步
+        static constexpr size_t LINE_PARALLEL_MIN = 64; // 线段少于此数时不分带，直接按提交顺序画
+        //? 沿主轴（变化较大的轴）逐像素前进，u 为主轴坐标，v 为副轴坐标；端点已按 u 从小到大排列
+        struct ScreenLine {
+            float au, av, az;    // 起点的主轴、副轴坐标与 NDC 深度
+            float bu;            // 终点的主轴坐标
+            float slope, zSlope; // 主轴每前进一个像素，副轴坐标与深度的变化量
+            float secant;        // 副轴方向上的线宽是垂直线宽的倍数
+            float minY, maxY;    // 覆盖的屏幕行（含线宽）
+            bool steep;          // 主轴为 y
+            uint32_t index;      // 在批次中的序号，取颜色用
+        };
+        Eigen::Matrix<float, 4, Eigen::Dynamic> m_lineView;   // 视图空间端点
+        Eigen::Matrix<float, 4, Eigen::Dynamic> m_lineScreen; // 屏幕空间端点
+        vector<ScreenLine> m_screenLines;
+        vector<int> m_lineBandOffsets;   // 每带线段在 m_lineBandItems 中的起始位置
+        vector<int> m_lineBandCursor;
+        vector<uint32_t> m_lineBandItems;  // 每带覆盖到的线段，带内按提交顺序
+        LineBatch m_overlayLines;        // DrawLine3D 与 DrawCoordinateSystem 使用
 
     public:
         Renderer() = delete;
@@ -46,276 +115,110 @@ namespace aries::render {
 
         void SetCameraAndScene(sptr<Camera> camera, sptr<Scene> scene);
 
+        // 设置本帧常量，frame 须在本帧绘制结束前保持有效；顶点阶段、画线与阴影遮罩都从这里读取矩阵
+        void BeginFrame(const FrameContext& frame) { m_frame = &frame; }
+
+        const FrameContext& GetFrame() const { return *m_frame; }
+
         void Clear(); // 清除缓存
 
+        // 获取本帧的阶段统计
+        const RenderStats& GetStats() const { return m_stats; }
+
+        // 设置屏幕空间阴影遮罩模式，需在 Clear 之前调用
+        void SetShadowMaskMode(shadow::ShadowMaskMode mode);
+
+        shadow::ShadowMaskMode GetShadowMaskMode() const { return m_shadowMaskMode; }
+
+        const shadow::ShadowMask& GetShadowMask() const { return m_shadowMask; }
+
+        // 所有着色器分组提交后调用：计算阴影遮罩并执行延后的片元着色
+        void ResolveDeferredShading();
+
+        int GetWidth() const { return _width; }
+
+        int GetHeight() const { return _height; }
+
+        // 本帧（绘制完成后即上一帧）的 NDC 深度，按 GetPixelIndex 排列，无内容处为 FLT_MAX
+        const vector<float>& GetDepthBuffer() const { return _zBuffer; }
+
         // 获取像素索引
         inline int GetPixelIndex(int x, int y) {
             return x + (_height - y - 1) * _width;
         }
 
-        Matrix4f GetViewMatrix();
-
-        Matrix4f GetClipMatrix();
-
-        // 绘制一条3D线段
+        // 绘制一条3D线段，画多条线时用 DrawLines
         void DrawLine3D(Vector3f start, Vector3f end, Vector3f color, bool ignoreDepthTest = false);
 
+        // 绘制一批3D线段：所有端点一次矩阵乘法变换到视图空间并裁剪近平面，再一次乘法投影到屏幕，
+        // 之后按屏幕行分带并行光栅化；同一像素上的线段按加入批次的顺序绘制
+        void DrawLines(const LineBatch& batch);
+
         // 绘制坐标系
         void DrawCoordinateSystem(float axisLength = 3.0f, bool showGrid = true, float gridSize = 0.1f, int gridCount = 20);
 
         template<ShaderConcept ShaderT> // 顶点着色器
-        vector<PipelineFragmentData<ShaderT>> VertexShaderWith(vector<sptr<Shape>>& shapeList, uint64_t& triangleCount) { 
+        vector<PipelineFragmentData<ShaderT>> VertexShaderWith(std::span<const VisibleShape> shapeList, uint64_t& triangleCount) { 
             static uint64_t lastTriangleCount = 0;
 
             // a2v → v2f → 组装 TriangleData 列表
             vector<PipelineFragmentData<ShaderT>> prims;
             prims.reserve(lastTriangleCount * 1.2f); // 预分配空间，避免频繁扩容，实测能加速顶点着色速度很多
 
-            Matrix4f mat_world_to_view = GetViewMatrix();
-            Matrix4f mat_view_to_clip = GetClipMatrix();
+            const Matrix4f& mat_world_to_view = m_frame->view;
+            const Matrix4f& mat_view_to_clip = m_frame->projection;
 
             ShaderBase<ShaderT>::BeforeShader({
                 .scene = m_scene.get(),
                 .camera = m_camera.get(),
+                .frame = m_frame,
+                .shadowMask = m_shadowMaskMode != shadow::ShadowMaskMode::Off ? &m_shadowMask : nullptr,
             });
 
-            for (auto shape : shapeList) {
-                Matrix4f mat_model_to_world = shape->model->GetModelMatrix();
-                Matrix4f mat_model_to_view = mat_world_to_view * mat_model_to_world;
-                Matrix4f mat_model_to_clip = mat_view_to_clip * mat_model_to_view;
-
-                auto* property = &static_cast<MaterialBase<ShaderT>*>(shape->material.get())->property;
-
-                Matrixs matrixs = {
-                    .mat_model = mat_model_to_world,
-                    .mat_view = mat_model_to_view,
-                    .mat_mvp = mat_model_to_clip,
-                };
-
-                // 每个三角形
-                for (size_t ti = 0; ti < shape->mesh.size(); ++ti) {
-                    auto& tri = shape->mesh[ti];
-                    
-                    a2v in[3];
-                    for (int k = 0; k < 3; ++k) {
-                        in[k].position = Vector4f(tri.vertex[k].x(), tri.vertex[k].y(), tri.vertex[k].z(), 1.f);
-                        in[k].normal = tri.normal[k];
-                        in[k].uv = tri.uv[k];
-                    }
-
-                    // 装配到 TriangleData
-                    PipelineFragmentData<ShaderT> pd;
-
-                    pd.matrixs = matrixs;
-                    pd.property = property;
-
-                    //* 调用 Shader::VertexShader 得到 v2f
-                    pd.fragmentData[0] = ShaderBase<ShaderT>::VertexShader(in[0], matrixs, *property);
-                    pd.fragmentData[1] = ShaderBase<ShaderT>::VertexShader(in[1], matrixs, *property);
-                    pd.fragmentData[2] = ShaderBase<ShaderT>::VertexShader(in[2], matrixs, *property);
-                    // 此时已经在NDC坐标系下，但是未经透视除法处理，先做裁剪再做透视除法
-
-                    //* 近远平面裁剪
-                    //? 为什么要先做裁剪，再做透视除法?
-                    //? 1. 第一个原因，避免裁剪出来的新三角形有畸变
-                    //? 2. 进行透视除法之前会进行裁剪，会把z=0的部分剔除掉，从而保证透视除法的时候不会存在z=0的顶点。
-
-                    bool allBehindNear = true, allBeyondFar = true, hasBehindNear = false, hasBeyondFar = false;
-                    for (int i = 0; i < 3; ++i) {
-                        if (pd.fragmentData[i].screenPos.z() >= -pd.fragmentData[i].screenPos.w())
-                            allBehindNear = false;
-                        else
-                            hasBehindNear = true;
-                        if (pd.fragmentData[i].screenPos.z() <= pd.fragmentData[i].screenPos.w())
-                            allBeyondFar = false;
-                        else
-                            hasBeyondFar = true;
-                    }
-                    if (allBehindNear || allBeyondFar) {
-                        continue; // 丢弃该三角形
+            //* 引用同一网格（同一级 LOD）且材质相同的连续形状作为一批实例绘制
+            //? 按三角形分块，一块对所有实例做完顶点着色再换下一块，三角形数据只从内存读一次，之后各实例都命中缓存；
+            //? 实例已经逐个通过了视锥与遮挡剔除，这里只是每个实例带自己的矩阵
+            vector<Matrixs> instanceMatrixs;
+            for (size_t begin = 0, end; begin < shapeList.size(); begin = end) {
+                const Shape& first = *shapeList[begin].shape;
+                const vector<Triangle>& mesh = first.GetRenderMesh();
+                for (end = begin + 1; end < shapeList.size(); ++end) {
+                    const Shape& shape = *shapeList[end].shape;
+                    if (&shape.GetRenderMesh() != &mesh || shapeList[end].material != shapeList[begin].material) {
+                        break;
                     }
+                }
 
-                    // 卡在远平面间的三角形保留不裁剪，只裁近平面
-
-                    if (hasBehindNear && !allBehindNear) [[unlikely]] {
-                        // 有部分顶点在近平面后面，有部分在前面，需要裁剪
-                        //* 收集裁剪后的顶点
-                        //? 使用栈分配的固定大小数组替代 vector
-                        typename ShaderT::v2f_t clippedVertices[5]; // 最多5个顶点
-                        float clippedW[5];
-                        int vertexCount = 0;
-
-                        for (int i = 0; i < 3; ++i) {
-                            int next = (i + 1) % 3;
-                            
-                            auto& current = pd.fragmentData[i];
-                            auto& nextVertex = pd.fragmentData[next];
-                            
-                            // 检查当前顶点是否在近平面前面
-                            bool currentInside = current.screenPos.z() >= -current.screenPos.w();
-                            bool nextInside = nextVertex.screenPos.z() >= -nextVertex.screenPos.w();
-                            
-                            if (currentInside) {
-                                // 当前顶点在近平面前面，添加它
-                                clippedVertices[vertexCount] = current;
-                                clippedW[vertexCount] = current.screenPos.w();
-                                vertexCount++;
-                                
-                                if (!nextInside) {
-                                    // 计算交点
-                                    float t = ComputeNearPlaneIntersection(current.screenPos, nextVertex.screenPos);
-                                    auto intersection = LinerInterpolateV2f<ShaderT>(current, nextVertex, t);
-                                    clippedVertices[vertexCount] = intersection;
-                                    clippedW[vertexCount] = intersection.screenPos.w();
-                                    vertexCount++;
-                                }
-                            } else if (nextInside) {
-                                // 计算交点
-                                float t = ComputeNearPlaneIntersection(current.screenPos, nextVertex.screenPos);
-                                auto intersection = LinerInterpolateV2f<ShaderT>(current, nextVertex, t);
-                                clippedVertices[vertexCount] = intersection;
-                                clippedW[vertexCount] = intersection.screenPos.w();
-                                vertexCount++;
-                            }
-                        }
-                        
-                        // 如果裁剪后顶点数量不足3个，丢弃该三角形
-                        if (vertexCount < 3) {
-                            continue;
-                        }
-                        
-                        //* 使用扇形三角剖分将裁剪后的多边形分解成三角形
-                        for (int k = 1; k < vertexCount - 1; ++k) {
-                            PipelineFragmentData<ShaderT> clippedPd;
-
-                            clippedPd.matrixs = pd.matrixs; // 继承原始矩阵数据
-                            clippedPd.property = pd.property; // 继承原始属性
-                            
-                            //* 设置三角形的三个顶点
-                            clippedPd.fragmentData[0] = clippedVertices[0];
-                            clippedPd.fragmentData[1] = clippedVertices[k];
-                            clippedPd.fragmentData[2] = clippedVertices[k + 1];
-                            
-                            //* 设置对应的 w 值
-                            clippedPd.clipW[0] = clippedW[0];
-                            clippedPd.clipW[1] = clippedW[k];
-                            clippedPd.clipW[2] = clippedW[k + 1];
-                            
-                            //* 透视除法
-                            clippedPd.fragmentData[0].screenPos /= clippedPd.fragmentData[0].screenPos.w();
-                            clippedPd.fragmentData[1].screenPos /= clippedPd.fragmentData[1].screenPos.w();
-                            clippedPd.fragmentData[2].screenPos /= clippedPd.fragmentData[2].screenPos.w();
-
-                            //* 视口裁剪
-                            {
-                                // 计算三角形的边界盒
-                                float minX = std::min({clippedPd.fragmentData[0].screenPos.x(),
-                                                    clippedPd.fragmentData[1].screenPos.x(),
-                                                    clippedPd.fragmentData[2].screenPos.x()});
-                                float maxX = std::max({clippedPd.fragmentData[0].screenPos.x(),
-                                                    clippedPd.fragmentData[1].screenPos.x(),
-                                                    clippedPd.fragmentData[2].screenPos.x()});
-                                float minY = std::min({clippedPd.fragmentData[0].screenPos.y(),
-                                                    clippedPd.fragmentData[1].screenPos.y(),
-                                                    clippedPd.fragmentData[2].screenPos.y()});
-                                float maxY = std::max({clippedPd.fragmentData[0].screenPos.y(),
-                                                    clippedPd.fragmentData[1].screenPos.y(),
-                                                    clippedPd.fragmentData[2].screenPos.y()});
-                                
-                                // 检查边界盒是否与视口相交
-                                if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) {
-                                    continue; // 三角形边界盒与视口不相交，丢弃
-                                }
-                            }
-                            
-                            //* 背面剔除
-                            {
-                                Vector2f v0 = clippedPd.fragmentData[0].screenPos.template head<2>();
-                                Vector2f v1 = clippedPd.fragmentData[1].screenPos.template head<2>();
-                                Vector2f v2 = clippedPd.fragmentData[2].screenPos.template head<2>();
-                                
-                                Vector2f e1 = v1 - v0;
-                                Vector2f e2 = v2 - v0;
-                                
-                                float crossZ = e1.x() * e2.y() - e1.y() * e2.x();
-                                
-                                if (crossZ < 0) {
-                                    continue; // 丢弃背面三角形
-                                }
-                            }
-                            
-                            //* 视口变换
-                            clippedPd.fragmentData[0].screenPos = _viewport * clippedPd.fragmentData[0].screenPos;
-                            clippedPd.fragmentData[1].screenPos = _viewport * clippedPd.fragmentData[1].screenPos;
-                            clippedPd.fragmentData[2].screenPos = _viewport * clippedPd.fragmentData[2].screenPos;
-                            
-                            // 添加到结果列表
-                            prims.emplace_back(std::move(clippedPd));
-                        }
-                    } else [[likely]] {
-                        // 所有顶点都在近平面前面，正常处理无需裁剪
-
-                        //* 保存齐次坐标 w 分量，为后面透视矫正插值准备
-                        pd.clipW[0] = pd.fragmentData[0].screenPos.w();
-                        pd.clipW[1] = pd.fragmentData[1].screenPos.w();
-                        pd.clipW[2] = pd.fragmentData[2].screenPos.w();
-
-                        //* 齐次除法
-                        // NDC坐标系 z ∈ [-1, 1]，靠近近平面时 z < 0，靠近远平面时 z > 0
-                        pd.fragmentData[0].screenPos /= pd.fragmentData[0].screenPos.w(); 
-                        pd.fragmentData[1].screenPos /= pd.fragmentData[1].screenPos.w();
-                        pd.fragmentData[2].screenPos /= pd.fragmentData[2].screenPos.w();
-
-                        //* 视口裁剪
-                        {
-                            // 计算三角形的边界盒
-                            float minX = std::min({pd.fragmentData[0].screenPos.x(),
-                                                pd.fragmentData[1].screenPos.x(),
-                                                pd.fragmentData[2].screenPos.x()});
-                            float maxX = std::max({pd.fragmentData[0].screenPos.x(),
-                                                pd.fragmentData[1].screenPos.x(),
-                                                pd.fragmentData[2].screenPos.x()});
-                            float minY = std::min({pd.fragmentData[0].screenPos.y(),
-                                                pd.fragmentData[1].screenPos.y(),
-                                                pd.fragmentData[2].screenPos.y()});
-                            float maxY = std::max({pd.fragmentData[0].screenPos.y(),
-                                                pd.fragmentData[1].screenPos.y(),
-                                                pd.fragmentData[2].screenPos.y()});
-                            
-                            // 检查边界盒是否与视口相交
-                            if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f) {
-                                continue; // 三角形边界盒与视口不相交，丢弃
-                            }
-                        }
+                auto* property = &static_cast<MaterialBase<ShaderT>*>(shapeList[begin].material)->property;
+
+                instanceMatrixs.clear();
+                for (size_t i = begin; i < end; ++i) {
+                    const Matrix4f& mat_model_to_world = *shapeList[i].modelMatrix;
+                    Matrix4f mat_model_to_view = mat_world_to_view * mat_model_to_world;
+                    Matrix4f mat_model_to_clip = mat_view_to_clip * mat_model_to_view;
+                    instanceMatrixs.push_back({
+                        .mat_model = mat_model_to_world,
+                        .mat_view = mat_model_to_view,
+                        .mat_mvp = mat_model_to_clip,
+                    });
+                }
 
-                        //* 背面剔除
-                        {
-                            Vector2f v0 = pd.fragmentData[0].screenPos.template head<2>();
-                            Vector2f v1 = pd.fragmentData[1].screenPos.template head<2>();
-                            Vector2f v2 = pd.fragmentData[2].screenPos.template head<2>();
-                            
-                            // 计算两条边的向量
-                            Vector2f e1 = v1 - v0;
-                            Vector2f e2 = v2 - v0;
-                            
-                            // 计算叉积（2D向量的叉积实际是行列式）
-                            float crossZ = e1.x() * e2.y() - e1.y() * e2.x();
-                            
-                            // 这里假设 crossZ < 0 表示背面
-                            if (crossZ < 0) {
-                                continue; // 丢弃背面三角形
-                            }
+                const size_t chunk = end - begin > 1 ? INSTANCE_CHUNK_TRIANGLES : mesh.size();
+                for (size_t triBegin = 0; triBegin < mesh.size(); triBegin += chunk) {
+                    const size_t triEnd = std::min(mesh.size(), triBegin + chunk);
+                    for (size_t i = begin; i < end; ++i) {
+                        if (shapeList[i].insideFrustum) {
+                            AssembleTrianglesWith<ShaderT, true>(mesh, triBegin, triEnd, instanceMatrixs[i - begin], property, prims);
+                        } else {
+                            AssembleTrianglesWith<ShaderT, false>(mesh, triBegin, triEnd, instanceMatrixs[i - begin], property, prims);
                         }
-
-                        //* 视口变换
-                        pd.fragmentData[0].screenPos = _viewport * pd.fragmentData[0].screenPos; // 屏幕空间
-                        pd.fragmentData[1].screenPos = _viewport * pd.fragmentData[1].screenPos; // 屏幕空间
-                        pd.fragmentData[2].screenPos = _viewport * pd.fragmentData[2].screenPos; // 屏幕空间
-
-                        // 将处理后的数据添加到片元列表
-                        prims.emplace_back(std::move(pd));
                     }
                 }
+
+                ++m_stats.drawBatches;
+                if (end - begin > 1) {
+                    m_stats.instancedShapes += (int)(end - begin);
+                }
             }
 
             triangleCount += lastTriangleCount = prims.size(); // 更新最后处理的三角形数量
@@ -323,159 +226,300 @@ namespace aries::render {
         }
 
         // 片元着色器(使用特定着色器类型)
-        template<ShaderConcept ShaderT>
-        void FragmentShaderWith(vector<PipelineFragmentData<ShaderT>>&& frags) {
+        // AfterPrepass: 已做过预深度，只着色 _primitiveBuffer 中记录为可见的像素，primitiveBase 为本组图元的起始编号
+        template<ShaderConcept ShaderT, bool AfterPrepass = false>
+        void FragmentShaderWith(vector<PipelineFragmentData<ShaderT>>&& frags, uint32_t primitiveBase = 0) {
         
             //! temp
             //!uint64_t _pixelCount = 0; // 计算着色的像素数量
 
 #pragma omp parallel for schedule(static)
             for (size_t i = 0; i < frags.size(); ++i) {
-                auto&& [frag, clipW, mats, property] = frags[i];
-                float minXf = _width, maxXf = 0, minYf = _height, maxYf = 0;
-                for (int j = 0; j < 3; ++j) {
-                    Vector4f v = frag[j].screenPos;
-                    minXf = std::min(minXf, v.x());
-                    maxXf = std::max(maxXf, v.x());
-                    minYf = std::min(minYf, v.y());
-                    maxYf = std::max(maxYf, v.y());
-                }
-                minXf = std::clamp(minXf, 0.0f, (float)_width);
-                maxXf = std::clamp(maxXf, 0.0f, (float)_width);
-                minYf = std::clamp(minYf, 0.0f, (float)_height);
-                maxYf = std::clamp(maxYf, 0.0f, (float)_height);
-                int minX = (int)std::floor(minXf), maxX = (int)std::ceil(maxXf);
-                int minY = (int)std::floor(minYf), maxY = (int)std::ceil(maxYf);
-
-//#pragma omp parallel for collapse(2) schedule(static)
-                typename ShaderT::v2f_t v2f;
-                for (int y = minY; y < maxY; ++y) {
-                    for (int x = minX; x < maxX; ++x) {
-                        // 判断像素是否在三角形内
-                        if (InsideTriangle((float)x + 0.5f, (float)y + 0.5f,
-                                        frag[0].screenPos.template head<3>(),
-                                        frag[1].screenPos.template head<3>(),
-                                        frag[2].screenPos.template head<3>()
-                                    )) {
-                            //* 计算2D重心坐标
-                            auto [a, b, c] = 
-                                Barycentric((float)x + 0.5f, (float)y + 0.5f,
-                                    frag[0].screenPos.template head<2>(),
-                                    frag[1].screenPos.template head<2>(),
-                                    frag[2].screenPos.template head<2>()
-                                );
-
-                            //* 判断深度值
-                            float theZ = frag[0].screenPos.z() * a + frag[1].screenPos.z() * b + frag[2].screenPos.z() * c; //? 深度值本来就算NDC空间的，所以不用透视插值
-
-                            int idx = GetPixelIndex(x, y);
+                const auto& pd = frags[i];
+                const auto& frag = pd.fragmentData;
+                const uint32_t primitiveId = primitiveBase + (uint32_t)i;
+
+                //* 插值所需的逐三角形常量推迟到第一个通过深度测试的像素再算
+                //? 致密网格里大部分三角形不覆盖任何像素中心（光栅化时直接返回）或整个被挡住，这部分设置都省掉
+                constexpr bool hasUVGrad = requires(typename ShaderT::v2f_t& v) { v.uv; v.uvGrad; };
+                bool prepared = false;
+                float invW[3]; // 透视校正插值用的 1/w
+                Vector2f dPdx, dPdy;
+                float dQdx, dQdy;
+                auto prepare = [&]() {
+                    invW[0] = 1.0f / pd.clipW[0];
+                    invW[1] = 1.0f / pd.clipW[1];
+                    invW[2] = 1.0f / pd.clipW[2];
+
+                    //* 纹理坐标的解析导数：uv = P / Q，P = Σλ·uv/w，Q = Σλ/w，λ 对屏幕坐标的导数在三角形内是常数
+                    if constexpr (hasUVGrad) {
+                        dPdx = dPdy = Vector2f::Zero();
+                        dQdx = dQdy = 0.0f;
+                        const Vector4f& s0 = frag[0].screenPos;
+                        const Vector4f& s1 = frag[1].screenPos;
+                        const Vector4f& s2 = frag[2].screenPos;
+                        float area = (s1.x() - s0.x()) * (s2.y() - s0.y()) - (s1.y() - s0.y()) * (s2.x() - s0.x());
+                        float invArea = 1.0f / area;
+                        const float dldx[3] = {(s1.y() - s2.y()) * invArea, (s2.y() - s0.y()) * invArea, (s0.y() - s1.y()) * invArea};
+                        const float dldy[3] = {(s2.x() - s1.x()) * invArea, (s0.x() - s2.x()) * invArea, (s1.x() - s0.x()) * invArea};
+                        for (int j = 0; j < 3; ++j) {
+                            dPdx += frag[j].uv * (dldx[j] * invW[j]);
+                            dPdy += frag[j].uv * (dldy[j] * invW[j]);
+                            dQdx += dldx[j] * invW[j];
+                            dQdy += dldy[j] * invW[j];
+                        }
+                    }
+                };
 
+                typename ShaderT::v2f_t v2f;
+                RasterizeTriangle<RasterMode::Interpolated>(frag[0].screenPos, frag[1].screenPos, frag[2].screenPos, _width, _height,
+                    [&](int x, int y, float theZ, float a, float b, float c) { //? 深度值本来就算NDC空间的，所以不用透视插值
+                        int idx = GetPixelIndex(x, y);
+
+                        //* 判断深度值
+                        if constexpr (AfterPrepass) {
+                            // 预深度已确定可见图元，不是本三角形的像素直接跳过
+                            if (_primitiveBuffer[idx] != primitiveId) {
+                                return;
+                            }
+                        } else {
                             if (_zBuffer[idx] > theZ) {
                                 _zBuffer[idx] = theZ;
                             } else {
-                                continue; // 深度测试失败，跳过该像素
-                            }
-                            
-                            //!#pragma omp atomic
-                            //!++_pixelCount; // 统计着色的像素数量
-                            
-                            //* 进行插值
-                            {
-                                v2f.screenPos = Vector4f(
-                                    (float)x + 0.5f, 
-                                    (float)y + 0.5f, 
-                                    theZ, 
-                                    1.0f
-                                ); // 屏幕空间坐标，第一个字段单独插值
-
-                                
-                                // 透视校正插值
-                                float invW[3] = {
-                                    1.0f / clipW[0],
-                                    1.0f / clipW[1],
-                                    1.0f / clipW[2]
-                                };
-
-                                float interpInvW = a * invW[0] + b * invW[1] + c * invW[2];
-
-                                auto Interpolate = [a, b, c, invW, interpInvW]<typename T>(T v0, T v1, T v2) -> T {
-                                    return (v0 * a * invW[0] + 
-                                            v1 * b * invW[1] + 
-                                            v2 * c * invW[2]) / interpInvW;
-                                };
-
-                                constexpr size_t v2fSize = boost::pfr::tuple_size_v<decltype(v2f)> - 1; // 获取 v2f 余下的字段数量
-
-                                //? 这里使用了C++20的折叠表达式和索引序列来实现编译期展开
-                                //? 这样可以避免手动写每个字段的插值代码，提高可维护性
-                                [&]<size_t... Is>(std::index_sequence<Is...>) -> void {
-                                    ((
-                                        boost::pfr::get<Is + 1>(v2f) = Interpolate(
-                                            boost::pfr::get<Is + 1>(frag[0]),
-                                            boost::pfr::get<Is + 1>(frag[1]),
-                                            boost::pfr::get<Is + 1>(frag[2])
-                                        )
-                                    ), ...);
-                                } (std::make_index_sequence<v2fSize>());
+                                return; // 深度测试失败，跳过该像素
                             }
+                        }
+
+                        if (!prepared) [[unlikely]] {
+                            prepare();
+                            prepared = true;
+                        }
 
-                            //* 使用shader处理着色
-                            Vector3f pixelColor = ShaderBase<ShaderT>::FragmentShader(v2f, mats, *property);
+                        //!#pragma omp atomic
+                        //!++_pixelCount; // 统计着色的像素数量
 
-                            if (_zBuffer[idx] == theZ) [[likely]] { // 校验，防止多线程着色错误
-                                SetPixelColor(x, y, pixelColor);
+                        //* 进行插值
+                        {
+                            v2f.screenPos = Vector4f(
+                                (float)x + 0.5f, 
+                                (float)y + 0.5f, 
+                                theZ, 
+                                1.0f
+                            ); // 屏幕空间坐标，第一个字段单独插值
+
+                            // 透视校正插值
+                            float interpInvW = a * invW[0] + b * invW[1] + c * invW[2];
+
+                            auto Interpolate = [a, b, c, &invW, interpInvW]<typename T>(T v0, T v1, T v2) -> T {
+                                return (v0 * a * invW[0] + 
+                                        v1 * b * invW[1] + 
+                                        v2 * c * invW[2]) / interpInvW;
+                            };
+
+                            constexpr size_t v2fSize = boost::pfr::tuple_size_v<decltype(v2f)> - 1; // 获取 v2f 余下的字段数量
+
+                            //? 这里使用了C++20的折叠表达式和索引序列来实现编译期展开
+                            //? 这样可以避免手动写每个字段的插值代码，提高可维护性
+                            [&]<size_t... Is>(std::index_sequence<Is...>) -> void {
+                                ((
+                                    InterpolateField(
+                                        boost::pfr::get<Is + 1>(v2f),
+                                        Interpolate,
+                                        boost::pfr::get<Is + 1>(frag[0]),
+                                        boost::pfr::get<Is + 1>(frag[1]),
+                                        boost::pfr::get<Is + 1>(frag[2])
+                                    )
+                                ), ...);
+                            } (std::make_index_sequence<v2fSize>());
+
+                            if constexpr (hasUVGrad) {
+                                v2f.uvGrad.dUVdx = (dPdx - v2f.uv * dQdx) / interpInvW;
+                                v2f.uvGrad.dUVdy = (dPdy - v2f.uv * dQdy) / interpInvW;
                             }
                         }
-                    }
-                }
+
+                        //* 使用shader处理着色
+                        Vector3f pixelColor = ShaderBase<ShaderT>::FragmentShader(v2f, pd.matrixs, *pd.property);
+
+                        if (AfterPrepass || _zBuffer[idx] == theZ) [[likely]] { // 校验，防止多线程着色错误
+                            SetPixelColor(x, y, pixelColor);
+                        }
+                    });
             }
 
             //! 输出着色的像素数量
             //! std::cout << _pixelCount << '\n';
         }
 
-    private:
-        inline static bool InsideTriangle(float x, float y, Vector3f v0, Vector3f v1, Vector3f v2) {
-            v0.z() = v1.z() = v2.z() = 1.0f;
-
-            Vector3f p(x, y, 1);
-
-            // 三条边的向量
-            Vector3f side1, side2, side3;
-            side1 = v1 - v0;
-            side2 = v2 - v1;
-            side3 = v0 - v2;
-
-            // 顶点到点的向量
-            Vector3f p1, p2, p3;
-            p1 = p - v0;
-            p2 = p - v1;
-            p3 = p - v2;
-
-            // 叉乘
-            Vector3f cross1, cross2, cross3;
-            cross1 = p1.cross(side1);
-            cross2 = p2.cross(side2);
-            cross3 = p3.cross(side3);
-
-            // 判断是否同号
-            if ((cross1.z() > 0 && cross2.z() > 0 && cross3.z() > 0) ||
-                (cross1.z() < 0 && cross2.z() < 0 && cross3.z() < 0)) {
-                return true;
-            } else
-                return false;
+        // 深度映射成保持大小顺序的无符号整数：正数翻转符号位，负数按位取反
+        static inline uint32_t DepthToKey(float z) {
+            uint32_t bits = std::bit_cast<uint32_t>(z);
+            return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
         }
 
-        // 计算与近平面的交点参数 t
-        inline static float ComputeNearPlaneIntersection(const Vector4f& p1, const Vector4f& p2) {
-            // 近平面条件：z >= -w，即 z + w >= 0
-            float d1 = p1.z() + p1.w();
-            float d2 = p2.z() + p2.w();
-            
-            // 计算交点参数 t，使得 lerp(p1, p2, t) 刚好在近平面上
-            return d1 / (d1 - d2);
+        static inline float KeyToDepth(uint32_t key) {
+            return std::bit_cast<float>((key & 0x80000000u) ? (key & 0x7FFFFFFFu) : ~key);
         }
-        
+
+        // 把预深度的打包结果拆回 _zBuffer 与 _primitiveBuffer
+        void UnpackPrepass();
+
+        // 预深度（只写深度和可见图元编号，不插值属性、不着色），与阴影贴图共用深度专用光栅化
+        //? 深度与图元编号打包进一个 64 位字，用比较交换整体取最小值：多线程写同一像素时两者始终来自同一个三角形，
+        //? 深度相同时取编号较小者，结果与线程调度无关
+        template<ShaderConcept ShaderT>
+        void DepthPrepassWith(const vector<PipelineFragmentData<ShaderT>>& frags, uint32_t primitiveBase) {
+            //* 记录每个图元对应的阴影接收设置，同一形状的图元连续且共享材质
+            if constexpr (ShaderBase<ShaderT>::ReceivesShadowMask()) {
+                const typename ShaderT::property_t* lastProperty = nullptr;
+                int receiver = -1;
+                for (const auto& pd : frags) {
+                    if (pd.property != lastProperty) {
+                        lastProperty = pd.property;
+                        receiver = (int)m_shadowReceivers.size();
+                        m_shadowReceivers.push_back(ShaderBase<ShaderT>::GetShadowFilterSettings(*lastProperty));
+                    }
+                    m_primitiveReceivers.push_back(receiver);
+                }
+            } else {
+                m_primitiveReceivers.insert(m_primitiveReceivers.end(), frags.size(), -1);
+            }
+
+#pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < frags.size(); ++i) {
+                const auto& frag = frags[i].fragmentData;
+                const uint32_t primitiveId = primitiveBase + (uint32_t)i;
+                RasterizeTriangle<RasterMode::DepthOnly>(frag[0].screenPos, frag[1].screenPos, frag[2].screenPos, _width, _height,
+                    [&](int x, int y, float theZ) {
+                        const uint64_t packed = ((uint64_t)DepthToKey(theZ) << 32) | primitiveId;
+                        std::atomic_ref<uint64_t> cell(_prepassBuffer[GetPixelIndex(x, y)]);
+                        uint64_t current = cell.load(std::memory_order_relaxed);
+                        while (packed < current && !cell.compare_exchange_weak(current, packed, std::memory_order_relaxed)) {
+                        }
+                    });
+            }
+        }
+
+    private:
+        // 多实例批次每次处理的三角形数，约 24KB 的三角形数据，在各实例之间保持在缓存中
+        static constexpr size_t INSTANCE_CHUNK_TRIANGLES = 256;
+
+        // 对网格 [first, last) 范围的三角形做顶点着色、裁剪、剔除与视口变换，结果追加到 prims
+        // InsideFrustum: 形状包围盒完全在视锥内，所有顶点都在近远平面之间、投影落在视口内，省去逐三角形的裁剪检查
+        template<ShaderConcept ShaderT, bool InsideFrustum>
+        void AssembleTrianglesWith(const vector<Triangle>& mesh, size_t first, size_t last, const Matrixs& matrixs,
+                                   typename ShaderT::property_t* property, vector<PipelineFragmentData<ShaderT>>& prims) {
+            for (size_t ti = first; ti < last; ++ti) {
+                const auto& tri = mesh[ti];
+
+                a2v in[3];
+                for (int k = 0; k < 3; ++k) {
+                    in[k].position = Vector4f(tri.vertex[k].x(), tri.vertex[k].y(), tri.vertex[k].z(), 1.f);
+                    in[k].normal = tri.normal[k];
+                    in[k].uv = tri.uv[k];
+                }
+
+                // 装配到 TriangleData
+                PipelineFragmentData<ShaderT> pd;
+
+                pd.matrixs = matrixs;
+                pd.property = property;
+
+                //* 调用 Shader::VertexShader 得到 v2f
+                pd.fragmentData[0] = ShaderBase<ShaderT>::VertexShader(in[0], matrixs, *property);
+                pd.fragmentData[1] = ShaderBase<ShaderT>::VertexShader(in[1], matrixs, *property);
+                pd.fragmentData[2] = ShaderBase<ShaderT>::VertexShader(in[2], matrixs, *property);
+                // 此时已经在NDC坐标系下，但是未经透视除法处理，先做裁剪再做透视除法
+
+                if constexpr (InsideFrustum) {
+                    //* 快速路径：直接透视除法，只做背面剔除
+                    for (int j = 0; j < 3; ++j) {
+                        pd.clipW[j] = pd.fragmentData[j].screenPos.w();
+                        pd.fragmentData[j].screenPos /= pd.clipW[j];
+                    }
+                    if (IsBackFacing(pd.fragmentData[0].screenPos, pd.fragmentData[1].screenPos, pd.fragmentData[2].screenPos)) {
+                        continue;
+                    }
+                    for (int j = 0; j < 3; ++j) {
+                        pd.fragmentData[j].screenPos = _viewport * pd.fragmentData[j].screenPos; // 屏幕空间
+                    }
+                    if (!HasPixelCenterInBounds(pd.fragmentData[0].screenPos, pd.fragmentData[1].screenPos, pd.fragmentData[2].screenPos, _width, _height)) {
+                        ++m_stats.sampleCulledTriangles;
+                        continue;
+                    }
+                    prims.emplace_back(std::move(pd));
+                    continue;
+                }
+
+                //* 视锥裁剪
+                //? 为什么要先做裁剪，再做透视除法?
+                //? 1. 第一个原因，避免裁剪出来的新三角形有畸变
+                //? 2. 进行透视除法之前会进行裁剪，会把z=0的部分剔除掉，从而保证透视除法的时候不会存在z=0的顶点。
+
+                const Vector4f& c0 = pd.fragmentData[0].screenPos;
+                const Vector4f& c1 = pd.fragmentData[1].screenPos;
+                const Vector4f& c2 = pd.fragmentData[2].screenPos;
+                if (IsTriangleOutsideFrustum(c0, c1, c2)) {
+                    continue; // 丢弃该三角形
+                }
+
+                // 近远平面总是裁剪，侧面只在顶点越出保护带时裁剪，其余越出视口的部分由光栅化按屏幕范围跳过
+                //? 使用栈分配的固定大小数组替代 vector
+                typename ShaderT::v2f_t polygon[MAX_CLIP_VERTICES];
+                int vertexCount = 3;
+                if (uint32_t planes = ClipPlanesNeeded(c0, c1, c2)) [[unlikely]] {
+                    ++m_stats.clippedTriangles;
+                    vertexCount = ClipTriangle(pd.fragmentData, polygon, planes,
+                        [](const typename ShaderT::v2f_t& v) -> const Vector4f& { return v.screenPos; },
+                        [](const typename ShaderT::v2f_t& a, const typename ShaderT::v2f_t& b, float t) { return LinerInterpolateV2f<ShaderT>(a, b, t); });
+                } else [[likely]] {
+                    polygon[0] = pd.fragmentData[0];
+                    polygon[1] = pd.fragmentData[1];
+                    polygon[2] = pd.fragmentData[2];
+                }
+
+                //* 使用扇形三角剖分将裁剪后的多边形分解成三角形
+                for (int k = 1; k < vertexCount - 1; ++k) {
+                    PipelineFragmentData<ShaderT> outPd;
+                    outPd.matrixs = pd.matrixs; // 继承原始矩阵数据
+                    outPd.property = pd.property; // 继承原始属性
+                    outPd.fragmentData[0] = polygon[0];
+                    outPd.fragmentData[1] = polygon[k];
+                    outPd.fragmentData[2] = polygon[k + 1];
+
+                    //* 保存齐次坐标 w 分量，为后面透视矫正插值准备，然后做齐次除法
+                    // NDC坐标系 z ∈ [-1, 1]，靠近近平面时 z < 0，靠近远平面时 z > 0
+                    for (int j = 0; j < 3; ++j) {
+                        outPd.clipW[j] = outPd.fragmentData[j].screenPos.w();
+                        outPd.fragmentData[j].screenPos /= outPd.clipW[j];
+                    }
+
+                    const Vector4f& n0 = outPd.fragmentData[0].screenPos;
+                    const Vector4f& n1 = outPd.fragmentData[1].screenPos;
+                    const Vector4f& n2 = outPd.fragmentData[2].screenPos;
+
+                    //* 视口裁剪与背面剔除
+                    if (IsTriangleOutsideViewport(n0, n1, n2) || IsBackFacing(n0, n1, n2)) {
+                        continue;
+                    }
+
+                    //* 视口变换
+                    for (int j = 0; j < 3; ++j) {
+                        outPd.fragmentData[j].screenPos = _viewport * outPd.fragmentData[j].screenPos; // 屏幕空间
+                    }
+
+                    //* 包围盒内没有像素中心的小三角形不会覆盖任何像素，不进入片元阶段
+                    if (!HasPixelCenterInBounds(outPd.fragmentData[0].screenPos, outPd.fragmentData[1].screenPos, outPd.fragmentData[2].screenPos, _width, _height)) {
+                        ++m_stats.sampleCulledTriangles;
+                        continue;
+                    }
+
+                    // 将处理后的数据添加到片元列表
+                    prims.emplace_back(std::move(outPd));
+                }
+            }
+        }
+
         // 线性插值两个 v2f 结构体
         template<ShaderConcept ShaderT>
         inline static typename ShaderT::v2f_t LinerInterpolateV2f(const typename ShaderT::v2f_t& v1, const typename ShaderT::v2f_t& v2, float t) {
@@ -484,25 +528,33 @@ namespace aries::render {
             // 使自动插值所有字段
             constexpr size_t fieldCount = boost::pfr::tuple_size_v<typename ShaderT::v2f_t>;
             
+            auto Lerp = [t]<typename T>(const T& a, const T& b) -> T {
+                return a * (1.0f - t) + b * t;
+            };
+
             [&]<size_t... Is>(std::index_sequence<Is...>) {
-                ((boost::pfr::get<Is>(result) = 
-                    boost::pfr::get<Is>(v1) * (1.0f - t) + 
-                    boost::pfr::get<Is>(v2) * t), ...);
+                (InterpolateField(
+                    boost::pfr::get<Is>(result),
+                    Lerp,
+                    boost::pfr::get<Is>(v1),
+                    boost::pfr::get<Is>(v2)
+                ), ...);
             } (std::make_index_sequence<fieldCount>());
 
             return result;
         }
 
-        // 计算重心坐标
-        inline static std::tuple<float, float, float> Barycentric(float x, float y, Vector2f A, Vector2f B, Vector2f C) {
-            float i = (-(x - B.x()) * (C.y() - B.y()) + (y - B.y()) * (C.x() - B.x())) /
-                    (-(A.x() - B.x()) * (C.y() - B.y()) + (A.y() - B.y()) * (C.x() - B.x()));
-            float j = (-(x - C.x()) * (A.y() - C.y()) + (y - C.y()) * (A.x() - C.x())) /
-                    (-(B.x() - C.x()) * (A.y() - C.y()) + (B.y() - C.y()) * (A.x() - C.x()));
-            float k = 1 - i - j;
-            return {i, j, k};
+        // 插值单个 v2f 字段；TextureGradient 由光栅化阶段单独计算，不参与插值
+        template<typename T, typename InterpolateFn, typename... Srcs>
+        inline static void InterpolateField(T& dst, InterpolateFn&& interpolate, const Srcs&... srcs) {
+            if constexpr (!std::is_same_v<T, TextureGradient>) {
+                dst = interpolate(srcs...);
+            }
         }
 
+        // 光栅化一条屏幕空间线段在 [rowBegin, rowEnd) 行内的部分
+        void RasterizeLine(const ScreenLine& line, const Vector3f& color, const LineStyle& style, int rowBegin, int rowEnd);
+
         inline void SetPixelColor(int x,int y, const Vector3f color) { // 使颜色存入帧缓冲
             m_raster->SetPixel(x, y, color.x() * 255, color.y() * 255, color.z() * 255);
         }
@@ -513,7 +565,8 @@ namespace aries::render {
 
     public:
         // 使用目标着色器类型渲染
-        void RenderWithShader(ShaderType type, vector<sptr<Shape>>& shapeList, uint64_t& triangleCount);
+        // shapeList 中的形状都使用 type 对应的着色器
+        void RenderWithShader(ShaderType type, std::span<const VisibleShape> shapeList, uint64_t& triangleCount);
     };
 
     // 特化 - 递归处理类型列表
@@ -523,8 +576,27 @@ namespace aries::render {
         inline static void Dispatch(Renderer& self, ShaderType type, Args&&... args) {
             if (ShaderBase<First>::GetType() == type) {
                 // 类型匹配，执行渲染
+                using clock = std::chrono::steady_clock;
+                auto t0 = clock::now();
                 auto prims = self.VertexShaderWith<First>(args...);
-                self.FragmentShaderWith<First>(std::move(prims));
+                auto t1 = clock::now();
+                self.m_stats.vertexStageMs += std::chrono::duration<float, std::milli>(t1 - t0).count();
+
+                if (self.m_shadowMaskMode != shadow::ShadowMaskMode::Off) {
+                    // 先只写深度，着色推迟到阴影遮罩算完之后
+                    uint32_t primitiveBase = self.m_primitiveCount;
+                    self.m_primitiveCount += (uint32_t)prims.size();
+                    self.DepthPrepassWith<First>(prims, primitiveBase);
+                    self.m_stats.prepassMs += std::chrono::duration<float, std::milli>(clock::now() - t1).count();
+
+                    auto deferred = std::make_shared<vector<PipelineFragmentData<First>>>(std::move(prims));
+                    self.m_deferredShading.emplace_back([&self, deferred, primitiveBase]() {
+                        self.FragmentShaderWith<First, true>(std::move(*deferred), primitiveBase);
+                    });
+                } else {
+                    self.FragmentShaderWith<First>(std::move(prims));
+                    self.m_stats.fragmentStageMs += std::chrono::duration<float, std::milli>(clock::now() - t1).count();
+                }
             } else {
                 if constexpr (sizeof...(Rest) > 0) {
                     // 继续递归处理下一个类型
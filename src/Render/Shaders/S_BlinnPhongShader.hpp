@@ -16,6 +16,7 @@ namespace aries::shader {
         Vector4f viewPos;    // 视图空间坐标（V * M * pos）
         Vector3f normal;     // 世界/视图空间法线
         Vector2f uv;         // 纹理坐标
+        TextureGradient uvGrad; // 纹理坐标的屏幕空间导数（光栅化阶段计算）
     };
 
     
@@ -65,7 +66,7 @@ namespace aries::shader {
         
             Texture* texture = property.texture.get();
 
-            Vector3f color = texture ? texture->Sample(uv.x(), uv.y()) : Vector3f(1.f, 1.f, 1.f);
+            Vector3f color = texture ? texture->Sample(uv.x(), uv.y(), data.uvGrad) : Vector3f(1.f, 1.f, 1.f);
 
             if (!light || !texture) [[unlikely]] {
                 return color; // 如果没有光源，直接返回颜色
@@ -3,6 +3,7 @@
 #include "Shader.hpp"
 #include "../Texture.hpp"
 #include "../../Scene.hpp"
+#include "../Shadow/ShadowMask.hpp"
 
 namespace aries::shader {
     template<> // 特化v2f类型
@@ -12,6 +13,7 @@ namespace aries::shader {
         Vector3f worldPos;    // 世界空间坐标（用于阴影计算）
         Vector3f normal;      // 世界/视图空间法线
         Vector2f uv;          // 纹理坐标
+        TextureGradient uvGrad; // 纹理坐标的屏幕空间导数（光栅化阶段计算）
     };
 
     
@@ -34,6 +36,9 @@ namespace aries::shader {
         float shadowBias = 0.002f;    // 阴影偏移，避免阴影痤疮
         float shadowIntensity = 0.8f; // 阴影强度（0-1）
         int pcfSamples = 3;           // PCF 采样数量（1=硬阴影，3/5=软阴影）
+        aries::shadow::ShadowFilterMode shadowFilter = aries::shadow::ShadowFilterMode::PCF; // 阴影过滤模式
+        int poissonTaps = 12;         // 泊松圆盘采样数
+        float poissonRadius = 2.0f;   // 泊松圆盘采样半径（纹素）
 
         // 距离衰减参数
         float shadowDistanceAttenuation = 15.0f;  // 距离衰减系数，值越大衰减越快
@@ -42,6 +47,7 @@ namespace aries::shader {
 
     class ShadowedBlinnPhongShader : public ShaderBase<ShadowedBlinnPhongShader> {
         inline static DirectionalShadow* shadowSystem; // 阴影系统缓存
+        inline static const aries::shadow::ShadowMask* shadowMask; // 屏幕空间阴影遮罩缓存
 
     public:
         // CRTP实现 - 编译器知道确切类型，可内联优化
@@ -51,6 +57,17 @@ namespace aries::shader {
 
         inline static void BeforeShaderImpl(const payload_t& p) {
             shadowSystem = p.scene->directionalShadow.get(); // 缓存阴影系统
+            shadowMask = p.shadowMask;
+        }
+
+        inline static aries::shadow::ShadowFilterSettings GetShadowFilterSettingsImpl(const property_t& property) {
+            return {
+                .mode = property.shadowFilter,
+                .pcfSamples = property.pcfSamples,
+                .poissonTaps = property.poissonTaps,
+                .poissonRadius = property.poissonRadius,
+                .bias = property.shadowBias,
+            };
         }
         
         inline static v2f_t VertexShaderImpl(const a2v& data, const Matrixs& matrixs, const property_t&) {
@@ -70,7 +87,7 @@ namespace aries::shader {
             // 获取纹理坐标
             Vector2f uv = data.uv;
             Texture* texture = property.texture.get();
-            Vector3f color = texture ? texture->Sample(uv.x(), uv.y()) : Vector3f(1.f, 1.f, 1.f);
+            Vector3f color = texture ? texture->Sample(uv.x(), uv.y(), data.uvGrad) : Vector3f(1.f, 1.f, 1.f);
 
             if (!shadowSystem) [[unlikely]] {
                 return color;
@@ -120,13 +137,10 @@ namespace aries::shader {
                 return {0.0f, 0.0f};
             }
 
-            // 使用增强的阴影采样
-            aries::shadow::ShadowSampleResult shadowResult;
-            if (property.pcfSamples <= 1) {
-                shadowResult = shadowSystem->SampleShadowWithDistance(data.worldPos, property.shadowBias);
-            } else {
-                shadowResult = shadowSystem->SampleShadowPCFWithDistance(data.worldPos, property.pcfSamples, property.shadowBias);
-            }
+            // 启用遮罩时直接读取预先算好的结果，否则逐片元采样阴影贴图
+            aries::shadow::ShadowSampleResult shadowResult = shadowMask
+                ? shadowMask->Fetch((int)data.screenPos.x(), (int)data.screenPos.y())
+                : shadowSystem->SampleWithDistance(data.worldPos, GetShadowFilterSettingsImpl(property));
 
             if (shadowResult.shadowFactor < 0.001f) {
                 return {0.0f, 0.0f}; // 没有阴影
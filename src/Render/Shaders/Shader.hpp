@@ -15,6 +15,14 @@ namespace aries::scene {
     class Scene; // 前向声明
 }
 
+namespace aries::shadow {
+    class ShadowMask; // 前向声明
+}
+
+namespace aries::render {
+    struct FrameContext; // 前向声明
+}
+
 namespace aries::shader {
     enum class ShaderType;
 
@@ -25,6 +33,8 @@ namespace aries::shader {
     struct Payload {
         scene::Scene* scene; // 场景
         Camera* camera; // 相机
+        const render::FrameContext* frame; // 本帧的摄像机与光源常量
+        const shadow::ShadowMask* shadowMask = nullptr; // 屏幕空间阴影遮罩，未启用时为空
     };
 
     struct Matrixs {
@@ -81,6 +91,16 @@ namespace aries::shader {
                 ShaderT::BeforeShaderImpl(payload);
             }
         }
+
+        // 是否接收屏幕空间阴影遮罩（实现了 GetShadowFilterSettingsImpl 的着色器）
+        constexpr static bool ReceivesShadowMask() {
+            return requires(const property_t& property) { ShaderT::GetShadowFilterSettingsImpl(property); };
+        }
+
+        // 获取材质的阴影过滤设置，供遮罩阶段使用
+        inline static auto GetShadowFilterSettings(const property_t& property) {
+            return ShaderT::GetShadowFilterSettingsImpl(property);
+        }
     };
 
     template<typename ShaderT>
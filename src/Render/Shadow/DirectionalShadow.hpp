@@ -1,15 +1,51 @@
 #pragma once
 
 #include "ShadowMapRenderer.hpp"
+#include "../FrameContext.hpp"
+#include "../ShapeBVH.hpp"
 
 namespace aries::shadow {
+    // 阴影过滤模式
+    enum class ShadowFilterMode {
+        Hard,     // 单次采样硬阴影
+        PCF,      // 整纹素方形网格 PCF（pcfSize x pcfSize 次采样）
+        Bilinear, // 2x2 双线性加权比较（类似硬件 PCF，4 次采样）
+        Poisson,  // 旋转泊松圆盘采样（采样数可配置）
+    };
+
+    // 材质的阴影过滤设置
+    struct ShadowFilterSettings {
+        ShadowFilterMode mode = ShadowFilterMode::PCF;
+        int pcfSamples = 3;          // PCF 核大小（<=1 时退化为硬阴影）
+        int poissonTaps = 12;        // 泊松圆盘采样数
+        float poissonRadius = 2.0f;  // 泊松圆盘采样半径（纹素）
+        float bias = 0.002f;         // 深度偏移
+    };
+
     // 阴影采样结果结构
     struct ShadowSampleResult {
         float shadowFactor;      // 阴影因子 [0,1]，0=无阴影，1=完全阴影
         float occluderDistance;  // 到遮挡物的距离，用于衰减计算
+        int tapCount;            // 实际读取阴影贴图的次数，用于性能统计
         
-        ShadowSampleResult(float shadow = 0.0f, float distance = 0.0f) 
-            : shadowFactor(shadow), occluderDistance(distance) {}
+        ShadowSampleResult(float shadow = 0.0f, float distance = 0.0f, int taps = 0) 
+            : shadowFactor(shadow), occluderDistance(distance), tapCount(taps) {}
+    };
+
+    // 泊松圆盘采样点（单位圆内），按最佳候选法生成；前 4 个挪到四个象限、靠近圆周，供提前结束判断使用
+    inline constexpr int MAX_POISSON_TAPS = 32;
+    inline const Vector2f POISSON_DISK[MAX_POISSON_TAPS] = {
+        Vector2f(0.6989f, 0.6908f),   Vector2f(-0.7077f, 0.6530f),  Vector2f(-0.4678f, -0.8551f),
+        Vector2f(0.8240f, -0.5635f),  Vector2f(0.1598f, -0.0876f),  Vector2f(-0.8787f, -0.4625f),
+        Vector2f(0.3306f, 0.8975f),   Vector2f(-0.0138f, -0.8831f), Vector2f(0.9388f, 0.2750f),
+        Vector2f(-0.1045f, 0.5021f),  Vector2f(-0.5318f, -0.0020f), Vector2f(-0.3301f, -0.4676f),
+        Vector2f(0.3945f, 0.3464f),   Vector2f(-0.3064f, 0.9510f),  Vector2f(0.3448f, -0.5371f),
+        Vector2f(-0.9627f, 0.2239f),  Vector2f(0.7106f, -0.1268f),  Vector2f(-0.4627f, 0.3724f),
+        Vector2f(0.3615f, -0.9236f),  Vector2f(-0.1626f, 0.1160f),  Vector2f(-0.9060f, -0.1226f),
+        Vector2f(0.0106f, -0.4251f),  Vector2f(0.0198f, 0.8302f),   Vector2f(-0.5959f, -0.3184f),
+        Vector2f(0.2189f, 0.5897f),   Vector2f(0.9969f, -0.0257f),  Vector2f(-0.2271f, -0.1801f),
+        Vector2f(0.4354f, -0.2439f),  Vector2f(0.1069f, 0.2828f),   Vector2f(0.6159f, -0.7810f),
+        Vector2f(-0.3902f, 0.6599f),  Vector2f(0.4720f, 0.0584f),
     };
 
     class DirectionalShadow {
@@ -20,6 +56,7 @@ namespace aries::shadow {
         float m_shadowBounds = 2.0f;  // 阴影范围
         float m_nearPlane = 0.1f;
         float m_farPlane = 10.0f;
+        bool m_autoFit = true;        // 是否根据场景包围体自动适配光源投影
 
     public:
         DirectionalShadow(const Vector3f& lightDir, int shadowMapSize = 2048) 
@@ -47,86 +84,146 @@ namespace aries::shadow {
             UpdateLightMatrices();
         }
 
-        // 更新阴影映射
-        void UpdateShadowMap(vector<sptr<Shape>>& shapeList) {
-            m_shadowRenderer->RenderShadowMap(shapeList);
+        // 开关自动适配
+        void SetAutoFit(bool enable) {
+            m_autoFit = enable;
+            if (!m_autoFit) {
+                UpdateLightMatrices(); // 恢复固定范围
+            }
         }
 
-        // 简单阴影采样（带距离信息）
-        ShadowSampleResult SampleShadowWithDistance(const Vector3f& worldPos, float bias = 0.005f) const {
-            Matrix4f lightSpaceMatrix = GetLightViewProjectionMatrix();
-            Vector4f lightSpacePos = lightSpaceMatrix * Vector4f(worldPos.x(), worldPos.y(), worldPos.z(), 1.0f);
-            lightSpacePos /= lightSpacePos.w();
-
-            float u = (lightSpacePos.x() + 1.0f) * 0.5f;
-            float v = (lightSpacePos.y() + 1.0f) * 0.5f;
-            float currentDepth = lightSpacePos.z();
+        bool IsAutoFit() const {
+            return m_autoFit;
+        }
 
-            if (u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f || currentDepth > 1.0f) {
-                return ShadowSampleResult(0.0f, 0.0f); // 超出范围，无阴影
+        // 根据场景包围体适配光源正交投影
+        // 接收者：与摄像机视锥体相交的形状，决定投影的 xy 范围（再与视锥体在光源空间的范围求交）
+        // 投射者：xy 与接收者范围重叠的形状，只用于把近平面推向光源，保证遮挡物不被裁掉
+        // 两类形状都通过 BVH 查询得到，视野外的大部分形状不会被逐个访问
+        // 视野内没有接收者时保持上一帧的矩阵
+        void FitToScene(const ShapeBVH& bvh, const render::FrameContext& frame) {
+            if (!m_autoFit) return;
+
+            // 光源视图只取旋转，原点放在世界原点，近远平面由包围体决定
+            Matrix4f lightViewMatrix = BuildLightViewMatrix(Vector3f::Zero());
+
+            AABB receivers;
+            bvh.Query(frame.frustum, [&](const ShapeBVH::Node& leaf, bool) {
+                if (!leaf.hasBounds) return;
+                receivers.Expand(leaf.worldBox.Transformed(lightViewMatrix));
+            });
+
+            if (!receivers.IsValid()) return;
+
+            // 摄像机视锥体在光源空间的包围盒，用来裁掉视野外的接收者部分
+            const Matrix4f& invViewProjection = frame.invViewProjection;
+            AABB frustumBox;
+            for (int i = 0; i < 8; ++i) {
+                Vector4f corner((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+                Vector4f world = invViewProjection * corner;
+                world /= world.w();
+                frustumBox.Expand((lightViewMatrix * world).head<3>());
             }
 
-            float shadowDepth = m_shadowRenderer->SampleDepth(u, v);
-            
-            if (currentDepth > shadowDepth + bias) {
-                // 在阴影中，计算到遮挡物的距离
-                float occluderDistance = currentDepth - shadowDepth;
-                return ShadowSampleResult(1.0f, occluderDistance);
-            } else {
-                // 不在阴影中
-                return ShadowSampleResult(0.0f, 0.0f);
+            float left   = std::max(receivers.min.x(), frustumBox.min.x());
+            float right  = std::min(receivers.max.x(), frustumBox.max.x());
+            float bottom = std::max(receivers.min.y(), frustumBox.min.y());
+            float top    = std::min(receivers.max.y(), frustumBox.max.y());
+            if (left >= right || bottom >= top) return;
+
+            // 光源视图空间朝 -z 看，z 越大越靠近光源
+            float nearZ = receivers.max.z();
+            float farZ = receivers.min.z();
+
+            //? 光源空间里 xy 落在 [left,right]x[bottom,top] 的柱体，近远两侧不限；光源视图是刚体变换，平面变换到世界空间后仍是单位法线
+            Frustum column;
+            const Vector4f lightPlanes[4] = {
+                Vector4f(1, 0, 0, -left), Vector4f(-1, 0, 0, right),
+                Vector4f(0, 1, 0, -bottom), Vector4f(0, -1, 0, top),
+            };
+            for (int i = 0; i < 4; ++i) {
+                column.planes[i] = (lightPlanes[i].transpose() * lightViewMatrix).transpose();
             }
+            column.planes[4] = column.planes[5] = Vector4f(0, 0, 0, 1);
+            bvh.Query(column, [&](const ShapeBVH::Node& leaf, bool) {
+                if (!leaf.hasBounds) return;
+                nearZ = std::max(nearZ, leaf.worldBox.Transformed(lightViewMatrix).max.z());
+            });
+
+            //? 深度偏移 bias 是在 NDC 深度上比较的，深度范围越窄，同样的 bias 对应的世界距离越小，容易出现阴影痤疮
+            //? 深度用 float 存储精度足够，这里让深度范围至少保持固定模式下的长度，使材质里的 bias 含义不随适配结果变化
+            farZ = std::min(farZ, nearZ - (m_farPlane - m_nearPlane));
+
+            // 留出少量边距，避免 PCF 核在边缘处采样越界，也避免表面正好落在近远平面上
+            float marginX = (right - left) * 0.02f;
+            float marginY = (top - bottom) * 0.02f;
+            float marginZ = std::max((nearZ - farZ) * 0.01f, 0.01f);
+
+            Matrix4f lightProjectionMatrix = BuildOrthoMatrix(
+                left - marginX, right + marginX,
+                bottom - marginY, top + marginY,
+                -(nearZ + marginZ), -(farZ - marginZ));
+
+            m_shadowRenderer->SetLightMatrices(lightViewMatrix, lightProjectionMatrix);
+        }
+
+        // 设置阴影深度的存储格式与布局
+        void SetDepthStorage(ShadowDepthFormat format, ShadowDepthLayout layout) {
+            m_shadowRenderer->SetDepthStorage(format, layout);
+        }
+
+        // 更新阴影映射，rows 为投射者在 store 中的行号
+        void UpdateShadowMap(const ShapeStore& store, std::span<const uint32_t> rows) {
+            m_shadowRenderer->RenderShadowMap(store, rows);
+        }
+
+        // 简单阴影采样（带距离信息）
+        ShadowSampleResult SampleShadowWithDistance(const Vector3f& worldPos, float bias = 0.005f) const {
+            return m_shadowRenderer->VisitDepthBuffer([&](const auto& depth) {
+                return SampleHardImpl(depth, worldPos, bias);
+            });
         }
 
         // PCF 阴影采样（带距离信息）
         ShadowSampleResult SampleShadowPCFWithDistance(const Vector3f& worldPos, int pcfSize = 3, float bias = 0.005f) const {
-            Matrix4f lightSpaceMatrix = GetLightViewProjectionMatrix();
-            Vector4f lightSpacePos = lightSpaceMatrix * Vector4f(worldPos.x(), worldPos.y(), worldPos.z(), 1.0f);
-            lightSpacePos /= lightSpacePos.w();
-
-            float u = (lightSpacePos.x() + 1.0f) * 0.5f;
-            float v = (lightSpacePos.y() + 1.0f) * 0.5f;
-            float currentDepth = lightSpacePos.z();
+            return m_shadowRenderer->VisitDepthBuffer([&](const auto& depth) {
+                return SamplePCFImpl(depth, worldPos, pcfSize, bias);
+            });
+        }
 
-            if (u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f || currentDepth > 1.0f) {
-                return ShadowSampleResult(0.0f, 0.0f);
-            }
+        // 2x2 双线性加权比较采样（带距离信息）
+        // 对相邻 4 个纹素分别做深度比较，再按子纹素位置做双线性加权，4 次采样即可得到平滑过渡
+        ShadowSampleResult SampleShadowBilinearWithDistance(const Vector3f& worldPos, float bias = 0.005f) const {
+            return m_shadowRenderer->VisitDepthBuffer([&](const auto& depth) {
+                return SampleBilinearImpl(depth, worldPos, bias);
+            });
+        }
 
-            float totalShadow = 0.0f;
-            float totalDistance = 0.0f;
-            int sampleCount = 0;
-            int shadowSamples = 0;
+        // 旋转泊松圆盘采样（带距离信息）
+        // taps: 采样数 [1, MAX_POISSON_TAPS]；radius: 采样半径（单位为纹素）
+        // 每个片元按光源空间位置生成一个旋转角，把规则采样的条带噪声打散成高频噪点
+        ShadowSampleResult SampleShadowPoissonWithDistance(const Vector3f& worldPos, int taps = 12, float radius = 2.0f, float bias = 0.005f) const {
+            return m_shadowRenderer->VisitDepthBuffer([&](const auto& depth) {
+                return SamplePoissonImpl(depth, worldPos, taps, radius, bias);
+            });
+        }
 
-            float texelSize = 1.0f / m_shadowRenderer->GetWidth();
-            int halfSize = pcfSize / 2;
-            
-            for (int y = -halfSize; y <= halfSize; ++y) {
-                for (int x = -halfSize; x <= halfSize; ++x) {
-                    float sampleU = u + x * texelSize;
-                    float sampleV = v + y * texelSize;
-                    
-                    if (sampleU >= 0.0f && sampleU <= 1.0f && sampleV >= 0.0f && sampleV <= 1.0f) {
-                        float shadowDepth = m_shadowRenderer->SampleDepth(sampleU, sampleV);
-                        
-                        if (currentDepth > shadowDepth + bias) {
-                            // 在阴影中
-                            totalShadow += 1.0f;
-                            totalDistance += (currentDepth - shadowDepth);
-                            shadowSamples++;
-                        }
-                        sampleCount++;
-                    }
+        // 按过滤设置采样（带距离信息）
+        ShadowSampleResult SampleWithDistance(const Vector3f& worldPos, const ShadowFilterSettings& settings) const {
+            switch (settings.mode) {
+            case ShadowFilterMode::Bilinear:
+                return SampleShadowBilinearWithDistance(worldPos, settings.bias);
+            case ShadowFilterMode::Poisson:
+                return SampleShadowPoissonWithDistance(worldPos, settings.poissonTaps, settings.poissonRadius, settings.bias);
+            case ShadowFilterMode::PCF:
+                if (settings.pcfSamples > 1) {
+                    return SampleShadowPCFWithDistance(worldPos, settings.pcfSamples, settings.bias);
                 }
+                [[fallthrough]];
+            case ShadowFilterMode::Hard:
+            default:
+                return SampleShadowWithDistance(worldPos, settings.bias);
             }
-            
-            if (sampleCount == 0) {
-                return ShadowSampleResult(0.0f, 0.0f);
-            }
-
-            float shadowFactor = totalShadow / sampleCount;
-            float avgDistance = (shadowSamples > 0) ? (totalDistance / shadowSamples) : 0.0f;
-            
-            return ShadowSampleResult(shadowFactor, avgDistance);
         }
 
         // 在世界坐标处采样阴影
@@ -190,10 +287,13 @@ namespace aries::shadow {
         }
 
         // 获取光源视图投影矩阵
-        Matrix4f GetLightViewProjectionMatrix() const {
+        const Matrix4f& GetLightViewProjectionMatrix() const {
             return m_shadowRenderer->GetLightViewProjectionMatrix();
         }
 
+        const Matrix4f& GetLightViewMatrix() const { return m_shadowRenderer->GetLightViewMatrix(); }
+        const Matrix4f& GetLightProjectionMatrix() const { return m_shadowRenderer->GetLightProjectionMatrix(); }
+
         // 获取阴影映射渲染器
         const ShadowMapRenderer* GetShadowRenderer() const {
             return m_shadowRenderer.get();
@@ -211,10 +311,172 @@ namespace aries::shadow {
             m_shadowRenderer->SaveDepthMapAsImage(filename);
         }
     private:
-        void UpdateLightMatrices() {
-            // 构建光源位置（在场景中心前方）
-            m_lightPosition = -m_lightDirection * m_shadowBounds;
-            Vector3f target = Vector3f::Zero();
+        //* 以下采样实现以深度缓冲视图为模板参数，纹素读取不含格式与布局分支
+
+        template<typename DepthViewT>
+        ShadowSampleResult SampleHardImpl(const DepthViewT& depth, const Vector3f& worldPos, float bias) const {
+            float u, v, currentDepth;
+            if (!ProjectToShadowMap(worldPos, u, v, currentDepth)) {
+                return ShadowSampleResult(0.0f, 0.0f); // 超出范围，无阴影
+            }
+
+            float shadowDepth = depth.Fetch((int)(u * depth.width), (int)(v * depth.height));
+            
+            if (currentDepth > shadowDepth + bias) {
+                // 在阴影中，计算到遮挡物的距离
+                float occluderDistance = currentDepth - shadowDepth;
+                return ShadowSampleResult(1.0f, occluderDistance, 1);
+            } else {
+                // 不在阴影中
+                return ShadowSampleResult(0.0f, 0.0f, 1);
+            }
+        }
+
+        template<typename DepthViewT>
+        ShadowSampleResult SamplePCFImpl(const DepthViewT& depth, const Vector3f& worldPos, int pcfSize, float bias) const {
+            float u, v, currentDepth;
+            if (!ProjectToShadowMap(worldPos, u, v, currentDepth)) {
+                return ShadowSampleResult(0.0f, 0.0f);
+            }
+
+            float totalShadow = 0.0f;
+            float totalDistance = 0.0f;
+            int sampleCount = 0;
+            int shadowSamples = 0;
+
+            float tx = u * depth.width;
+            float ty = v * depth.height;
+            int halfSize = pcfSize / 2;
+            
+            for (int y = -halfSize; y <= halfSize; ++y) {
+                for (int x = -halfSize; x <= halfSize; ++x) {
+                    float sampleX = tx + x;
+                    float sampleY = ty + y;
+                    
+                    if (sampleX >= 0.0f && sampleX <= depth.width && sampleY >= 0.0f && sampleY <= depth.height) {
+                        float shadowDepth = depth.Fetch((int)sampleX, (int)sampleY);
+                        
+                        if (currentDepth > shadowDepth + bias) {
+                            // 在阴影中
+                            totalShadow += 1.0f;
+                            totalDistance += (currentDepth - shadowDepth);
+                            shadowSamples++;
+                        }
+                        sampleCount++;
+                    }
+                }
+            }
+            
+            if (sampleCount == 0) {
+                return ShadowSampleResult(0.0f, 0.0f);
+            }
+
+            float shadowFactor = totalShadow / sampleCount;
+            float avgDistance = (shadowSamples > 0) ? (totalDistance / shadowSamples) : 0.0f;
+            
+            return ShadowSampleResult(shadowFactor, avgDistance, sampleCount);
+        }
+
+        template<typename DepthViewT>
+        ShadowSampleResult SampleBilinearImpl(const DepthViewT& depth, const Vector3f& worldPos, float bias) const {
+            float u, v, currentDepth;
+            if (!ProjectToShadowMap(worldPos, u, v, currentDepth)) {
+                return ShadowSampleResult(0.0f, 0.0f);
+            }
+
+            // 转换到纹素空间，减去 0.5 使采样点对齐纹素中心
+            float tx = u * depth.width - 0.5f;
+            float ty = v * depth.height - 0.5f;
+            int x0 = (int)std::floor(tx);
+            int y0 = (int)std::floor(ty);
+            float fx = tx - x0;
+            float fy = ty - y0;
+
+            const float weights[4] = {
+                (1.0f - fx) * (1.0f - fy),
+                fx * (1.0f - fy),
+                (1.0f - fx) * fy,
+                fx * fy,
+            };
+            const float depths[4] = {
+                depth.Fetch(x0, y0),
+                depth.Fetch(x0 + 1, y0),
+                depth.Fetch(x0, y0 + 1),
+                depth.Fetch(x0 + 1, y0 + 1),
+            };
+
+            float shadowFactor = 0.0f;
+            float weightedDistance = 0.0f;
+            for (int i = 0; i < 4; ++i) {
+                if (currentDepth > depths[i] + bias) {
+                    shadowFactor += weights[i];
+                    weightedDistance += weights[i] * (currentDepth - depths[i]);
+                }
+            }
+
+            float avgDistance = (shadowFactor > 0.0f) ? (weightedDistance / shadowFactor) : 0.0f;
+            return ShadowSampleResult(shadowFactor, avgDistance, 4);
+        }
+
+        template<typename DepthViewT>
+        ShadowSampleResult SamplePoissonImpl(const DepthViewT& depth, const Vector3f& worldPos, int taps, float radius, float bias) const {
+            float u, v, currentDepth;
+            if (!ProjectToShadowMap(worldPos, u, v, currentDepth)) {
+                return ShadowSampleResult(0.0f, 0.0f);
+            }
+
+            taps = std::clamp(taps, 1, MAX_POISSON_TAPS);
+
+            float tx = u * depth.width;
+            float ty = v * depth.height;
+
+            // Interleaved Gradient Noise，以阴影贴图纹素坐标为种子，保证同一位置每帧旋转角稳定
+            float noise = 52.9829189f * std::fmod(0.06711056f * std::floor(tx) + 0.00583715f * std::floor(ty), 1.0f);
+            float angle = 2.0f * std::numbers::pi_v<float> * (noise - std::floor(noise));
+            float s = std::sin(angle) * radius;
+            float c = std::cos(angle) * radius;
+
+            float shadowFactor = 0.0f;
+            float totalDistance = 0.0f;
+            int sampleCount = 0;
+
+            for (int i = 0; i < taps; ++i) {
+                const Vector2f& p = POISSON_DISK[i];
+                float sx = tx + p.x() * c - p.y() * s;
+                float sy = ty + p.x() * s + p.y() * c;
+                float shadowDepth = depth.Fetch((int)std::floor(sx), (int)std::floor(sy));
+                ++sampleCount;
+
+                if (currentDepth > shadowDepth + bias) {
+                    shadowFactor += 1.0f;
+                    totalDistance += (currentDepth - shadowDepth);
+                }
+
+                //? 前 4 个采样点在四个象限各一个、都靠近圆周，旋转后仍朝四个方向张开；
+                //? 它们的结果一致时，圆盘内部大概率也一致，按完全受光或完全阴影处理，提前结束
+                if (i == 3 && taps > 4 && (shadowFactor == 0.0f || shadowFactor == 4.0f)) {
+                    break;
+                }
+            }
+
+            float avgDistance = (shadowFactor > 0.0f) ? (totalDistance / shadowFactor) : 0.0f;
+            return ShadowSampleResult(shadowFactor / sampleCount, avgDistance, sampleCount);
+        }
+
+        // 把世界坐标投影到阴影贴图纹理空间，超出阴影贴图范围时返回 false
+        inline bool ProjectToShadowMap(const Vector3f& worldPos, float& u, float& v, float& depth) const {
+            Vector4f lightSpacePos = m_shadowRenderer->GetLightViewProjectionMatrix() * Vector4f(worldPos.x(), worldPos.y(), worldPos.z(), 1.0f);
+            lightSpacePos /= lightSpacePos.w();
+
+            u = (lightSpacePos.x() + 1.0f) * 0.5f;
+            v = (lightSpacePos.y() + 1.0f) * 0.5f;
+            depth = lightSpacePos.z();
+
+            return !(u < 0.0f || u > 1.0f || v < 0.0f || v > 1.0f || depth > 1.0f);
+        }
+
+        // 构建位于 position、朝向光照方向的光源视图矩阵
+        Matrix4f BuildLightViewMatrix(const Vector3f& position) const {
             Vector3f up = Vector3f(0, 1, 0);
             
             // 避免up向量与光方向平行
@@ -222,26 +484,40 @@ namespace aries::shadow {
                 up = Vector3f(1, 0, 0);
             }
 
-            // 构建光源视图矩阵
-            Vector3f forward = (target - m_lightPosition).normalized();
+            Vector3f forward = m_lightDirection;
             Vector3f right = forward.cross(up).normalized();
             Vector3f camera_up = right.cross(forward);
 
             Matrix4f lightViewMatrix;
             lightViewMatrix <<
-                right.x(),    right.y(),    right.z(),    -right.dot(m_lightPosition),
-                camera_up.x(), camera_up.y(), camera_up.z(), -camera_up.dot(m_lightPosition),
-                -forward.x(), -forward.y(), -forward.z(),  forward.dot(m_lightPosition),
+                right.x(),    right.y(),    right.z(),    -right.dot(position),
+                camera_up.x(), camera_up.y(), camera_up.z(), -camera_up.dot(position),
+                -forward.x(), -forward.y(), -forward.z(),  forward.dot(position),
                 0,            0,            0,             1;
+            return lightViewMatrix;
+        }
+
+        // 构建正交投影矩阵（nearPlane/farPlane 为沿视线方向的距离）
+        static Matrix4f BuildOrthoMatrix(float left, float right, float bottom, float top, float nearPlane, float farPlane) {
+            Matrix4f ortho;
+            ortho <<
+                2.0f / (right - left), 0,                     0,                                -(right + left) / (right - left),
+                0,                     2.0f / (top - bottom), 0,                                -(top + bottom) / (top - bottom),
+                0,                     0,                     -2.0f / (farPlane - nearPlane), -(farPlane + nearPlane) / (farPlane - nearPlane),
+                0,                     0,                     0,                                1;
+            return ortho;
+        }
+
+        void UpdateLightMatrices() {
+            // 构建光源位置（在场景中心前方）
+            m_lightPosition = -m_lightDirection * m_shadowBounds;
+
+            // 构建光源视图矩阵
+            Matrix4f lightViewMatrix = BuildLightViewMatrix(m_lightPosition);
 
             // 构建正交投影矩阵
             float orthoSize = m_shadowBounds;
-            Matrix4f lightProjectionMatrix;
-            lightProjectionMatrix <<
-                2.0f / (2 * orthoSize), 0,                     0,                           0,
-                0,                      2.0f / (2 * orthoSize), 0,                           0,
-                0,                      0,                     -2.0f / (m_farPlane - m_nearPlane), -(m_farPlane + m_nearPlane) / (m_farPlane - m_nearPlane),
-                0,                      0,                     0,                           1;
+            Matrix4f lightProjectionMatrix = BuildOrthoMatrix(-orthoSize, orthoSize, -orthoSize, orthoSize, m_nearPlane, m_farPlane);
 
             // 设置到阴影映射渲染器
             m_shadowRenderer->SetLightMatrices(lightViewMatrix, lightProjectionMatrix);
@@ -0,0 +1,125 @@
+/// FileName: ShadowDepthStorage.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#pragma once
+
+#include "../CommonHeader.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace aries::shadow {
+    // 阴影深度存储格式
+    enum class ShadowDepthFormat {
+        Float32, // 32 位浮点，NDC 深度原样存储
+        Unorm16, // 16 位无符号归一化，[-1,1] 量化到 [0,65535]，带宽和缓存占用减半
+    };
+
+    // 阴影深度内存布局
+    enum class ShadowDepthLayout {
+        Linear, // 行主序
+        Tiled,  // 8x8 分块，块内 Morton 序，PCF 邻域基本落在同一块（1~2 条缓存行）内
+    };
+
+    // 深度格式的存储类型与编解码
+    template<ShadowDepthFormat F>
+    struct DepthFormatTraits;
+
+    template<>
+    struct DepthFormatTraits<ShadowDepthFormat::Float32> {
+        using storage_t = float;
+
+        inline static storage_t Encode(float depth) { return depth; }
+        inline static float Decode(storage_t value) { return value; }
+    };
+
+    template<>
+    struct DepthFormatTraits<ShadowDepthFormat::Unorm16> {
+        using storage_t = uint16_t;
+
+        inline static storage_t Encode(float depth) {
+            float n = std::clamp((depth + 1.0f) * 0.5f, 0.0f, 1.0f);
+            return (storage_t)(n * 65535.0f + 0.5f);
+        }
+        inline static float Decode(storage_t value) {
+            return value * (2.0f / 65535.0f) - 1.0f;
+        }
+    };
+
+    // 纹素坐标到存储下标的映射
+    template<ShadowDepthLayout L>
+    struct DepthLayoutTraits;
+
+    template<>
+    struct DepthLayoutTraits<ShadowDepthLayout::Linear> {
+        // 与旧版保持一致：第 0 行存放在缓冲末尾（y 轴翻转）
+        inline static size_t Index(int x, int y, int width, int height, int) {
+            return (size_t)x + (size_t)(height - y - 1) * width;
+        }
+
+        inline static size_t StorageSize(int width, int height) {
+            return (size_t)width * height;
+        }
+    };
+
+    template<>
+    struct DepthLayoutTraits<ShadowDepthLayout::Tiled> {
+        static constexpr int TILE_SHIFT = 3; // 8x8
+        static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+        static constexpr int TILE_MASK = TILE_SIZE - 1;
+
+        // 把 3 位整数的位展开到偶数位上：abc -> a0b0c
+        inline static uint32_t Spread3(uint32_t v) {
+            return (v & 1u) | ((v & 2u) << 1) | ((v & 4u) << 2);
+        }
+
+        inline static size_t Index(int x, int y, int, int, int tilesX) {
+            size_t tile = (size_t)(y >> TILE_SHIFT) * tilesX + (x >> TILE_SHIFT);
+            uint32_t morton = Spread3(x & TILE_MASK) | (Spread3(y & TILE_MASK) << 1);
+            return (tile << (2 * TILE_SHIFT)) | morton;
+        }
+
+        // 覆盖 pixels 个像素需要的分块数
+        inline static int TileCount(int pixels) {
+            return (pixels + TILE_MASK) >> TILE_SHIFT;
+        }
+
+        inline static size_t StorageSize(int width, int height) {
+            return (size_t)TileCount(width) * TileCount(height) * TILE_SIZE * TILE_SIZE;
+        }
+    };
+
+    // 特定格式与布局下的深度缓冲视图，所有分支在编译期确定
+    template<ShadowDepthFormat F, ShadowDepthLayout L>
+    struct DepthBufferView {
+        using format_t = DepthFormatTraits<F>;
+        using layout_t = DepthLayoutTraits<L>;
+        using storage_t = typename format_t::storage_t;
+
+        storage_t* data;
+        int width, height, tilesX;
+
+        inline size_t Index(int x, int y) const {
+            return layout_t::Index(x, y, width, height, tilesX);
+        }
+
+        // 读取纹素深度（越界时夹取到边缘）
+        inline float Fetch(int x, int y) const {
+            x = std::clamp(x, 0, width - 1);
+            y = std::clamp(y, 0, height - 1);
+            return format_t::Decode(data[Index(x, y)]);
+        }
+
+        // 深度测试并写入，通过返回 true
+        inline bool TestAndStore(int x, int y, float depth) const {
+            storage_t value = format_t::Encode(depth);
+            storage_t& dst = data[Index(x, y)];
+            if (value < dst) {
+                dst = value;
+                return true;
+            }
+            return false;
+        }
+    };
+}
@@ -2,6 +2,11 @@
 
 #include "../CommonHeader.hpp"
 #include "../Model.hpp"
+#include "../RasterCore.hpp"
+#include "../ShapeStore.hpp"
+#include "ShadowDepthStorage.hpp"
+
+#include <span>
 
 //! 调试用 
 // TODO: 删除
@@ -10,14 +15,29 @@
 using namespace aries::model;
 
 namespace aries::shadow {
+
+    // 阴影绘制统计
+    struct ShadowPassStats {
+        int drawnShapes = 0;           // 提交光栅化的形状数
+        int culledShapes = 0;          // 整体剔除的形状数
+        uint64_t drawnTriangles = 0;   // 提交光栅化的三角形数
+        uint64_t culledTriangles = 0;  // 随形状一起被剔除的三角形数
+    };
     
     // 独立的阴影映射渲染器
     class ShadowMapRenderer {
     private:
         int m_width, m_height;
-        vector<float> m_depthBuffer;
+        ShadowPassStats m_stats;
+
+        ShadowDepthFormat m_format = ShadowDepthFormat::Float32;
+        ShadowDepthLayout m_layout = ShadowDepthLayout::Linear;
+        vector<float> m_depthBuffer;      // Float32 格式的深度存储
+        vector<uint16_t> m_depthBuffer16; // Unorm16 格式的深度存储
+        int m_tilesX = 0;                 // Tiled 布局每行的分块数
         Matrix4f m_lightViewMatrix;
         Matrix4f m_lightProjectionMatrix;
+        Matrix4f m_lightViewProjectionMatrix; // 投影 * 视图，设置矩阵时计算一次，采样时不再重复相乘
         Matrix4f m_viewport;
 
         // 添加性能优化相关成员
@@ -27,7 +47,7 @@ namespace aries::shadow {
 
     public:
         ShadowMapRenderer(int size) : m_width(size), m_height(size) {
-            m_depthBuffer.resize(size * size, 1.0f);
+            SetDepthStorage(m_format, m_layout);
             
             // 初始化粗略深度缓冲
             m_coarseWidth = (size + COARSE_FACTOR - 1) / COARSE_FACTOR;
@@ -46,11 +66,54 @@ namespace aries::shadow {
         void SetLightMatrices(const Matrix4f& view, const Matrix4f& projection) {
             m_lightViewMatrix = view;
             m_lightProjectionMatrix = projection;
+            m_lightViewProjectionMatrix = projection * view;
+        }
+
+        // 设置深度存储格式与布局，会重新分配并清空深度缓冲
+        void SetDepthStorage(ShadowDepthFormat format, ShadowDepthLayout layout) {
+            m_format = format;
+            m_layout = layout;
+            m_tilesX = DepthLayoutTraits<ShadowDepthLayout::Tiled>::TileCount(m_width);
+
+            size_t size = (layout == ShadowDepthLayout::Tiled)
+                ? DepthLayoutTraits<ShadowDepthLayout::Tiled>::StorageSize(m_width, m_height)
+                : DepthLayoutTraits<ShadowDepthLayout::Linear>::StorageSize(m_width, m_height);
+
+            // 只保留当前格式的存储，释放另一份
+            if (format == ShadowDepthFormat::Float32) {
+                m_depthBuffer.assign(size, 1.0f);
+                vector<uint16_t>().swap(m_depthBuffer16);
+            } else {
+                m_depthBuffer16.assign(size, DepthFormatTraits<ShadowDepthFormat::Unorm16>::Encode(1.0f));
+                vector<float>().swap(m_depthBuffer);
+            }
+        }
+
+        ShadowDepthFormat GetDepthFormat() const { return m_format; }
+        ShadowDepthLayout GetDepthLayout() const { return m_layout; }
+
+        // 深度缓冲占用的字节数
+        size_t GetDepthBufferBytes() const {
+            return m_depthBuffer.size() * sizeof(float) + m_depthBuffer16.size() * sizeof(uint16_t);
+        }
+
+        // 以当前格式与布局对应的深度缓冲视图调用 fn，格式分派只发生一次，fn 内部的读写全部在编译期确定
+        template<typename Fn>
+        decltype(auto) VisitDepthBuffer(Fn&& fn) const {
+            using enum ShadowDepthFormat;
+            using enum ShadowDepthLayout;
+            if (m_format == Unorm16) {
+                if (m_layout == Tiled) return fn(MakeView<Unorm16, Tiled>());
+                return fn(MakeView<Unorm16, Linear>());
+            }
+            if (m_layout == Tiled) return fn(MakeView<Float32, Tiled>());
+            return fn(MakeView<Float32, Linear>());
         }
 
         // 清除深度缓冲
         void Clear() {
             std::fill(m_depthBuffer.begin(), m_depthBuffer.end(), 1.0f);
+            std::fill(m_depthBuffer16.begin(), m_depthBuffer16.end(), DepthFormatTraits<ShadowDepthFormat::Unorm16>::Encode(1.0f));
             std::fill(m_coarseDepthBuffer.begin(), m_coarseDepthBuffer.end(), 1.0f);
         }
 
@@ -61,11 +124,10 @@ namespace aries::shadow {
             
             for (int y = 0; y < m_height; ++y) {
                 for (int x = 0; x < m_width; ++x) {
-                    int depthIdx = x + y * m_width;
-                    int imageIdx = (x + (m_height - y - 1) * m_width) * 3; // 翻转 Y 轴
+                    int imageIdx = (x + y * m_width) * 3;
                     
                     // 将深度值 [-1,1] 映射到 [0,255]
-                    float depth = m_depthBuffer[depthIdx];
+                    float depth = FetchDepth(x, y);
                     depth = std::clamp((depth + 1.0f) / 2.0f, 0.0f, 1.0f); // 确保在 [0,1] 范围内
                     unsigned char grayValue = static_cast<unsigned char>(depth * 255);
                     
@@ -86,117 +148,135 @@ namespace aries::shadow {
             }
         }
 
-        // 渲染阴影映射
-        void RenderShadowMap(vector<sptr<Shape>>& shapeList) {
+        // 渲染阴影映射，rows 为投射者在 store 中的行号
+        void RenderShadowMap(const ShapeStore& store, std::span<const uint32_t> rows) {
             Clear();
             
-            Matrix4f lightViewProjection = m_lightProjectionMatrix * m_lightViewMatrix;
-            
-            // 处理每个形状
-            for (auto& shape : shapeList) {
-                Matrix4f modelMatrix = shape->model->GetModelMatrix();
-                Matrix4f mvp = lightViewProjection * modelMatrix;
-                
-                // 处理每个三角形
-                for (size_t i = 0; i < shape->mesh.size(); i++) {
-                    ProcessTriangle(shape->mesh[i], mvp);
-                }
-            }
+            const Matrix4f& lightViewProjection = m_lightViewProjectionMatrix;
+            m_stats = {};
+
+            // 按深度存储格式分派一次，光栅化循环内不再有格式分支
+            VisitDepthBuffer([&](const auto& depthView) {
+                RenderShapes(store, rows, lightViewProjection, depthView);
+            });
         }
 
         // 采样深度值
         float SampleDepth(float u, float v) const {
-            int x = std::clamp((int)(u * m_width), 0, m_width - 1);
-            int y = std::clamp((int)(v * m_height), 0, m_height - 1);
-            int idx = x + (m_height - y - 1) * m_width;
-            return m_depthBuffer[idx];
+            return FetchDepth((int)(u * m_width), (int)(v * m_height));
         }
 
-        // 获取阴影映射纹理
-        const vector<float>& GetDepthBuffer() const {
-            return m_depthBuffer;
+        // 按纹素坐标读取深度值（越界时夹取到边缘），y 轴与 SampleDepth 的 v 方向一致
+        float FetchDepth(int x, int y) const {
+            return VisitDepthBuffer([x, y](const auto& depthView) { return depthView.Fetch(x, y); });
         }
 
         // 获取光源视图投影矩阵
-        Matrix4f GetLightViewProjectionMatrix() const {
-            return m_lightProjectionMatrix * m_lightViewMatrix;
+        const Matrix4f& GetLightViewProjectionMatrix() const {
+            return m_lightViewProjectionMatrix;
         }
 
+        const Matrix4f& GetLightViewMatrix() const { return m_lightViewMatrix; }
+        const Matrix4f& GetLightProjectionMatrix() const { return m_lightProjectionMatrix; }
+
         int GetWidth() const { return m_width; }
         int GetHeight() const { return m_height; }
 
-    private:
-        // 处理单个三角形（添加更多优化）
-        inline void ProcessTriangle(const Triangle& triangle, const Matrix4f& mvp) {
-            // 1. 顶点变换到齐次裁剪空间
-            Vector4f v0 = mvp * Vector4f(triangle.vertex[0].x(), triangle.vertex[0].y(), triangle.vertex[0].z(), 1.0f);
-            Vector4f v1 = mvp * Vector4f(triangle.vertex[1].x(), triangle.vertex[1].y(), triangle.vertex[1].z(), 1.0f);
-            Vector4f v2 = mvp * Vector4f(triangle.vertex[2].x(), triangle.vertex[2].y(), triangle.vertex[2].z(), 1.0f);
+        // 获取上一次阴影绘制的统计信息
+        const ShadowPassStats& GetStats() const { return m_stats; }
 
-            // 2. 改进的可见性检测（添加背面剔除和边界检查）
-            if (!IsTriangleVisible(v0, v1, v2)) {
-                return;
+    private:
+        template<ShadowDepthFormat F, ShadowDepthLayout L>
+        DepthBufferView<F, L> MakeView() const {
+            using storage_t = typename DepthFormatTraits<F>::storage_t;
+            //? 视图同时用于读写，这里去掉 const；只读路径（采样）不会调用写接口
+            storage_t* data;
+            if constexpr (F == ShadowDepthFormat::Float32) {
+                data = const_cast<storage_t*>(m_depthBuffer.data());
+            } else {
+                data = const_cast<storage_t*>(m_depthBuffer16.data());
             }
+            return DepthBufferView<F, L>{data, m_width, m_height, m_tilesX};
+        }
 
-            // 3. 透视除法
-            v0 /= v0.w();
-            v1 /= v1.w();
-            v2 /= v2.w();
+        template<typename DepthViewT>
+        void RenderShapes(const ShapeStore& store, std::span<const uint32_t> rows, const Matrix4f& lightViewProjection, const DepthViewT& depthView) {
+            // 处理每个形状，模型矩阵与世界包围盒直接读 store 的列
+            for (uint32_t row : rows) {
+                Matrix4f mvp = lightViewProjection * store.GetModelMatrix(row);
+                const vector<Triangle>& mesh = store.GetShape(row)->GetRenderMesh(); // 与主视图使用同一级 LOD
+
+                //* 形状级剔除
+                //? 光源使用正交投影（仿射变换），可以直接把世界包围盒变换到 NDC 中与 [-1,1]³ 比较
+                if (store.HasBounds(row)) {
+                    AABB ndc = store.GetWorldBox(row).Transformed(lightViewProjection);
+                    if (ndc.max.x() < -1.0f || ndc.min.x() > 1.0f ||
+                        ndc.max.y() < -1.0f || ndc.min.y() > 1.0f ||
+                        ndc.max.z() < -1.0f || ndc.min.z() > 1.0f) {
+                        m_stats.culledShapes++;
+                        m_stats.culledTriangles += mesh.size();
+                        continue;
+                    }
+                }
 
-            // 4. 快速边界检查（替代精确的视口裁剪）
-            if (!IsTriangleInBounds(v0, v1, v2)) {
-                return;
+                m_stats.drawnShapes++;
+                m_stats.drawnTriangles += mesh.size();
+                
+                // 处理每个三角形
+                for (size_t i = 0; i < mesh.size(); i++) {
+                    ProcessTriangle(mesh[i], mvp, depthView);
+                }
             }
+        }
 
-            // 5. Early Z-Rejection - 检查三角形最近深度
-            // float nearestZ = std::min({v0.z(), v1.z(), v2.z()});
-            // if (!CoarseDepthTest(v0, v1, v2, nearestZ)) {
-            //     return; // 被粗略深度测试剔除
-            // }
-
-            // 6. 视口变换
-            v0 = m_viewport * v0;
-            v1 = m_viewport * v1;
-            v2 = m_viewport * v2;
+        // 处理单个三角形：裁剪、剔除与光栅化规则都与主渲染器共用 RasterCore
+        template<typename DepthViewT>
+        inline void ProcessTriangle(const Triangle& triangle, const Matrix4f& mvp, const DepthViewT& depthView) {
+            // 1. 顶点变换到齐次裁剪空间
+            Vector4f clip[3];
+            for (int k = 0; k < 3; ++k) {
+                clip[k] = mvp * Vector4f(triangle.vertex[k].x(), triangle.vertex[k].y(), triangle.vertex[k].z(), 1.0f);
+            }
 
-            // 7. 光栅化
-            RasterizeTriangle(v0, v1, v2);
-        }
+            if (render::IsTriangleOutsideFrustum(clip[0], clip[1], clip[2])) {
+                return;
+            }
 
-        // 改进的可见性检测（添加背面剔除）
-        bool IsTriangleVisible(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
-            // 检查是否完全在近/远平面外
-            bool allBehindNear = (v0.z() < -v0.w()) && (v1.z() < -v1.w()) && (v2.z() < -v2.w());
-            bool allBeyondFar = (v0.z() > v0.w()) && (v1.z() > v1.w()) && (v2.z() > v2.w());
-            
-            if (allBehindNear || allBeyondFar) {
-                return false;
+            // 2. 视锥裁剪（光源离场景很近时投射者可能越过近平面；侧面只在越出保护带时裁剪）
+            Vector4f polygon[render::MAX_CLIP_VERTICES];
+            int vertexCount = 3;
+            if (uint32_t planes = render::ClipPlanesNeeded(clip[0], clip[1], clip[2])) [[unlikely]] {
+                vertexCount = render::ClipTriangle(clip, polygon, planes,
+                    [](const Vector4f& v) -> const Vector4f& { return v; },
+                    [](const Vector4f& a, const Vector4f& b, float t) -> Vector4f { return a + (b - a) * t; });
+            } else {
+                polygon[0] = clip[0];
+                polygon[1] = clip[1];
+                polygon[2] = clip[2];
             }
 
-            // 背面剔除（在齐次空间中进行，避免除法）
-            // 计算三角形法向量的 z 分量
-            Vector3f e1(v1.x() - v0.x(), v1.y() - v0.y(), v1.z() - v0.z());
-            Vector3f e2(v2.x() - v0.x(), v2.y() - v0.y(), v2.z() - v0.z());
-            Vector3f normal = e1.cross(e2);
-            
-            // 如果法向量 z 分量为负，说明是背面（假设光源朝向 -z）
-            if (normal.z() < 0) {
-                return false;
+            // 3. 透视除法（正交投影下 w = 1，保持通用）
+            for (int k = 0; k < vertexCount; ++k) {
+                polygon[k] /= polygon[k].w();
             }
 
-            return true;
-        }
+            for (int k = 1; k < vertexCount - 1; ++k) {
+                Vector4f v0 = polygon[0], v1 = polygon[k], v2 = polygon[k + 1];
 
-        // 快速边界检查（替代精确裁剪）
-        bool IsTriangleInBounds(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
-            // 计算三角形的 AABB
-            float minX = std::min({v0.x(), v1.x(), v2.x()});
-            float maxX = std::max({v0.x(), v1.x(), v2.x()});
-            float minY = std::min({v0.y(), v1.y(), v2.y()});
-            float maxY = std::max({v0.y(), v1.y(), v2.y()});
-            
-            // 检查 AABB 是否与 NDC 立方体 [-1,1]² 相交
-            return !(maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f);
+                // 4. 视口与背面剔除
+                if (render::IsTriangleOutsideViewport(v0, v1, v2) || render::IsBackFacing(v0, v1, v2)) {
+                    continue;
+                }
+
+                // 5. 视口变换并光栅化（只写深度）
+                v0 = m_viewport * v0;
+                v1 = m_viewport * v1;
+                v2 = m_viewport * v2;
+                render::RasterizeTriangle<render::RasterMode::DepthOnly>(v0, v1, v2, m_width, m_height,
+                    [&depthView](int x, int y, float depth) {
+                        depthView.TestAndStore(x, y, depth);
+                    });
+            }
         }
 
         // 粗略深度测试 - Early Z-Rejection
@@ -224,47 +304,6 @@ namespace aries::shadow {
             return false; // 整个三角形都被遮挡
         }
 
-        // 光栅化三角形（添加粗略深度缓冲更新）
-        void RasterizeTriangle(const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
-            // 计算边界框
-            int minX = std::max(0, (int)std::floor(std::min({v0.x(), v1.x(), v2.x()})));
-            int maxX = std::min(m_width, (int)std::ceil(std::max({v0.x(), v1.x(), v2.x()})));
-            int minY = std::max(0, (int)std::floor(std::min({v0.y(), v1.y(), v2.y()})));
-            int maxY = std::min(m_height, (int)std::ceil(std::max({v0.y(), v1.y(), v2.y()})));
-
-            // 记录深度更新，用于更新粗略深度缓冲
-            bool depthUpdated = false;
-            float minDepthUpdated = 1.0f;
-
-            for (int y = minY; y < maxY; ++y) {
-                for (int x = minX; x < maxX; ++x) {
-                    if (InsideTriangle(x + 0.5f, y + 0.5f, v0, v1, v2)) {
-                        // 计算重心坐标
-                        auto [a, b, c] = Barycentric(x + 0.5f, y + 0.5f, 
-                            Vector2f(v0.x(), v0.y()),
-                            Vector2f(v1.x(), v1.y()),
-                            Vector2f(v2.x(), v2.y()));
-
-                        // 深度插值
-                        float depth = v0.z() * a + v1.z() * b + v2.z() * c;
-                        
-                        // 深度测试并更新
-                        int idx = x + (m_height - y - 1) * m_width;
-                        if (depth < m_depthBuffer[idx]) {
-                            m_depthBuffer[idx] = depth;
-                            depthUpdated = true;
-                            minDepthUpdated = std::min(minDepthUpdated, depth);
-                        }
-                    }
-                }
-            }
-
-            //! 更新粗略深度缓冲
-            // if (depthUpdated) {
-            //     UpdateCoarseDepthBuffer(minX, maxX, minY, maxY, minDepthUpdated);
-            // }
-        }
-
         // 更新粗略深度缓冲
         void UpdateCoarseDepthBuffer(int minX, int maxX, int minY, int maxY, float depth) {
             int coarseMinX = minX / COARSE_FACTOR;
@@ -279,38 +318,5 @@ namespace aries::shadow {
                 }
             }
         }
-
-        // 三角形内部测试
-        bool InsideTriangle(float x, float y, const Vector4f& v0, const Vector4f& v1, const Vector4f& v2) {
-            Vector2f p(x, y);
-            Vector2f a(v0.x(), v0.y());
-            Vector2f b(v1.x(), v1.y());
-            Vector2f c(v2.x(), v2.y());
-
-            Vector2f ab = b - a;
-            Vector2f bc = c - b;
-            Vector2f ca = a - c;
-
-            Vector2f ap = p - a;
-            Vector2f bp = p - b;
-            Vector2f cp = p - c;
-
-            float cross1 = ab.x() * ap.y() - ab.y() * ap.x();
-            float cross2 = bc.x() * bp.y() - bc.y() * bp.x();
-            float cross3 = ca.x() * cp.y() - ca.y() * cp.x();
-
-            return (cross1 >= 0 && cross2 >= 0 && cross3 >= 0) ||
-                   (cross1 <= 0 && cross2 <= 0 && cross3 <= 0);
-        }
-
-        // 重心坐标计算
-        std::tuple<float, float, float> Barycentric(float x, float y, Vector2f A, Vector2f B, Vector2f C) {
-            float i = (-(x - B.x()) * (C.y() - B.y()) + (y - B.y()) * (C.x() - B.x())) /
-                    (-(A.x() - B.x()) * (C.y() - B.y()) + (A.y() - B.y()) * (C.x() - B.x()));
-            float j = (-(x - C.x()) * (A.y() - C.y()) + (y - C.y()) * (A.x() - C.x())) /
-                    (-(B.x() - C.x()) * (A.y() - C.y()) + (B.y() - C.y()) * (A.x() - C.x()));
-            float k = 1 - i - j;
-            return {i, j, k};
-        }
     };
 }
\ No newline at end of file
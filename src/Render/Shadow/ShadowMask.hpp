@@ -0,0 +1,174 @@
+/// FileName: ShadowMask.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#pragma once
+
+#include "DirectionalShadow.hpp"
+
+#include <omp.h>
+
+namespace aries::shadow {
+    // 屏幕空间阴影遮罩模式
+    enum class ShadowMaskMode {
+        Off,  // 关闭，片元着色器自己采样阴影贴图
+        Full, // 全分辨率，每个可见像素采样一次
+        Half, // 半分辨率采样，再按深度做双边上采样
+    };
+
+    // 遮罩阶段对某个像素可见表面的描述
+    struct ShadowMaskSurface {
+        const ShadowFilterSettings* settings = nullptr; // 为空表示该像素没有阴影接收者
+        Vector3f worldPos = Vector3f::Zero();
+        float viewDepth = 0.0f; // 线性视图深度（裁剪空间 w），用于双边上采样
+    };
+
+    struct ShadowMaskStats {
+        int sampledPixels = 0;   // 实际采样阴影贴图的像素数
+        int upsampledPixels = 0; // 由低分辨率结果插值得到的像素数
+        int fallbackPixels = 0;  // 深度不连续处退回逐像素采样的像素数
+    };
+
+    // 屏幕空间阴影遮罩：在预深度之后对每个可见像素计算一次阴影，着色阶段直接读取
+    class ShadowMask {
+    private:
+        int m_width = 0, m_height = 0;
+        vector<ShadowSampleResult> m_mask;    // 全分辨率结果，行主序（y 向上）
+        vector<ShadowSampleResult> m_lowMask; // 半分辨率结果
+        vector<float> m_lowDepth;             // 半分辨率样本的视图深度，<= 0 表示无效
+        vector<Vector2f> m_lowPos;            // 半分辨率样本在全分辨率屏幕上的实际位置（像素中心坐标）
+        ShadowMaskStats m_stats;
+
+        // 双边上采样时允许的相对深度差，超过视为不同表面
+        static constexpr float DEPTH_TOLERANCE = 0.02f;
+
+    public:
+        void Resize(int width, int height) {
+            if (width == m_width && height == m_height) return;
+            m_width = width;
+            m_height = height;
+            m_mask.assign((size_t)width * height, ShadowSampleResult());
+            int lowW = (width + 1) / 2, lowH = (height + 1) / 2;
+            m_lowMask.assign((size_t)lowW * lowH, ShadowSampleResult());
+            m_lowDepth.assign((size_t)lowW * lowH, 0.0f);
+            m_lowPos.assign((size_t)lowW * lowH, Vector2f::Zero());
+        }
+
+        // 读取像素的阴影结果
+        inline const ShadowSampleResult& Fetch(int x, int y) const {
+            x = std::clamp(x, 0, m_width - 1);
+            y = std::clamp(y, 0, m_height - 1);
+            return m_mask[(size_t)x + (size_t)y * m_width];
+        }
+
+        const ShadowMaskStats& GetStats() const {
+            return m_stats;
+        }
+
+        // 计算遮罩，surfaceAt(x, y) 返回像素的可见表面
+        template<typename SurfaceFn>
+        void Resolve(ShadowMaskMode mode, const DirectionalShadow& shadow, SurfaceFn&& surfaceAt) {
+            m_stats = {};
+            if (mode == ShadowMaskMode::Half) {
+                ResolveHalf(shadow, surfaceAt);
+            } else if (mode == ShadowMaskMode::Full) {
+                ResolveFull(shadow, surfaceAt);
+            }
+        }
+
+    private:
+        template<typename SurfaceFn>
+        void ResolveFull(const DirectionalShadow& shadow, SurfaceFn& surfaceAt) {
+            int sampled = 0;
+#pragma omp parallel for schedule(static) reduction(+ : sampled)
+            for (int y = 0; y < m_height; ++y) {
+                for (int x = 0; x < m_width; ++x) {
+                    ShadowMaskSurface s = surfaceAt(x, y);
+                    ShadowSampleResult& dst = m_mask[(size_t)x + (size_t)y * m_width];
+                    if (s.settings) {
+                        dst = shadow.SampleWithDistance(s.worldPos, *s.settings);
+                        ++sampled;
+                    } else {
+                        dst = ShadowSampleResult();
+                    }
+                }
+            }
+            m_stats.sampledPixels = sampled;
+        }
+
+        template<typename SurfaceFn>
+        void ResolveHalf(const DirectionalShadow& shadow, SurfaceFn& surfaceAt) {
+            const int lowW = (m_width + 1) / 2, lowH = (m_height + 1) / 2;
+            int sampled = 0, upsampled = 0, fallback = 0;
+
+            //* 1. 每个 2x2 块取第一个有接收者的像素作为代表，采样一次，并记下它的实际位置
+            //? 代表像素通常不在块中心，上采样时按实际位置算权重，否则半分辨率结果会整体偏移约半个像素
+#pragma omp parallel for schedule(static) reduction(+ : sampled)
+            for (int ly = 0; ly < lowH; ++ly) {
+                for (int lx = 0; lx < lowW; ++lx) {
+                    size_t li = (size_t)lx + (size_t)ly * lowW;
+                    m_lowDepth[li] = 0.0f;
+                    m_lowMask[li] = ShadowSampleResult();
+                    for (int k = 0; k < 4; ++k) {
+                        int x = lx * 2 + (k & 1), y = ly * 2 + (k >> 1);
+                        if (x >= m_width || y >= m_height) continue;
+                        ShadowMaskSurface s = surfaceAt(x, y);
+                        if (!s.settings) continue;
+                        m_lowMask[li] = shadow.SampleWithDistance(s.worldPos, *s.settings);
+                        m_lowDepth[li] = s.viewDepth;
+                        m_lowPos[li] = Vector2f(x + 0.5f, y + 0.5f);
+                        ++sampled;
+                        break;
+                    }
+                }
+            }
+
+            //* 2. 双边上采样：按样本实际位置算帐篷权重（样本都在块中心时即双线性权重），只保留深度相近的样本，全部被拒绝时退回逐像素采样
+#pragma omp parallel for schedule(static) reduction(+ : sampled, upsampled, fallback)
+            for (int y = 0; y < m_height; ++y) {
+                for (int x = 0; x < m_width; ++x) {
+                    ShadowSampleResult& dst = m_mask[(size_t)x + (size_t)y * m_width];
+                    ShadowMaskSurface s = surfaceAt(x, y);
+                    if (!s.settings) {
+                        dst = ShadowSampleResult();
+                        continue;
+                    }
+
+                    const float cx = x + 0.5f, cy = y + 0.5f;
+                    int x0 = (int)std::floor(cx * 0.5f - 0.5f), y0 = (int)std::floor(cy * 0.5f - 0.5f);
+
+                    float weightSum = 0.0f, shadowSum = 0.0f, distanceSum = 0.0f;
+                    for (int k = 0; k < 4; ++k) {
+                        int lx = std::clamp(x0 + (k & 1), 0, lowW - 1);
+                        int ly = std::clamp(y0 + (k >> 1), 0, lowH - 1);
+                        size_t li = (size_t)lx + (size_t)ly * lowW;
+                        float lowDepth = m_lowDepth[li];
+                        if (lowDepth <= 0.0f || std::abs(lowDepth - s.viewDepth) > DEPTH_TOLERANCE * s.viewDepth) {
+                            continue;
+                        }
+                        //? 低分辨率样本间距为 2 个像素
+                        const Vector2f& pos = m_lowPos[li];
+                        float w = std::max(0.0f, 1.0f - std::abs(cx - pos.x()) * 0.5f) * std::max(0.0f, 1.0f - std::abs(cy - pos.y()) * 0.5f);
+                        weightSum += w;
+                        //? 未遮挡样本的距离为 0，按阴影因子加权，只让被遮挡的样本参与距离平均（与逐像素 PCF 一致）
+                        const float factor = m_lowMask[li].shadowFactor;
+                        shadowSum += w * factor;
+                        distanceSum += w * factor * m_lowMask[li].occluderDistance;
+                    }
+
+                    if (weightSum > 1e-4f) {
+                        dst = ShadowSampleResult(shadowSum / weightSum, shadowSum > 0.0f ? distanceSum / shadowSum : 0.0f);
+                        ++upsampled;
+                    } else {
+                        dst = shadow.SampleWithDistance(s.worldPos, *s.settings);
+                        ++fallback;
+                    }
+                }
+            }
+
+            m_stats.sampledPixels = sampled + fallback;
+            m_stats.upsampledPixels = upsampled;
+            m_stats.fallbackPixels = fallback;
+        }
+    };
+}
@@ -5,7 +5,7 @@
 #pragma once
 #include "CommonHeader.hpp"
 
-#include "Triangle.hpp"
+#include "Mesh.hpp"
 
 namespace aries::material {
     class IMaterial;
@@ -13,17 +13,116 @@ namespace aries::material {
 
 namespace aries::model {
     class Model; // 前向声明
+    class ShapeStore;
+
+    // 形状的哪些内容变化了，ShapeStore 据此刷新对应的列
+    enum ShapeChangeBits : uint32_t {
+        SHAPE_CHANGED_TRANSFORM = 1u << 0, // 所属模型（或其祖先）的变换
+        SHAPE_CHANGED_MESH      = 1u << 1,
+        SHAPE_CHANGED_MATERIAL  = 1u << 2,
+        SHAPE_CHANGED_ALL       = SHAPE_CHANGED_TRANSFORM | SHAPE_CHANGED_MESH | SHAPE_CHANGED_MATERIAL,
+    };
+
+    // 由 ShapeStore 持有的变化记录，形状在变化或销毁时把自己的槽位记进来，Sync 只处理这些行
+    struct ShapeChangeList {
+        vector<uint32_t> changedSlots;
+        vector<uint32_t> removedSlots;
+    };
 
     class Shape {
     public:
         Shape() = default;
 
+        //? 形状在存储中的登记不能复制
+        Shape(const Shape&) = delete;
+        Shape& operator=(const Shape&) = delete;
+
+        ~Shape() {
+            if (m_changeList) {
+                m_changeList->removedSlots.push_back(m_storeSlot);
+            }
+        }
+
         string name; // 形状名称
 
-        Model* model; // 属于的模型
+        Model* model = nullptr; // 属于的模型
+
+        int lodIndex = 0; // 本帧使用的级别，0 为原网格，i 为 mesh->lods[i - 1]，由管线按屏幕误差选择
+
+        bool occluder = false; // 指定为遮挡物：可见时总是写入遮挡深度缓冲，不受自动选择的面积与三角形数限制
+
+        // 网格资源，可被多个形状共享；为空表示还没有网格
+        const sptr<const Mesh>& GetMesh() const { return m_mesh; }
+
+        // 材质球
+        const sptr<material::IMaterial>& GetMaterial() const { return m_material; }
+
+        void SetMaterial(sptr<material::IMaterial> material) {
+            m_material = std::move(material);
+            MarkChanged(SHAPE_CHANGED_MATERIAL);
+        }
+
+        // 通知所在的 ShapeStore 这一行需要刷新；同一帧内多次变化只登记一次
+        void MarkChanged(uint32_t changes) {
+            if (!m_changeList) {
+                return;
+            }
+            if (m_pendingChanges == 0) {
+                m_changeList->changedSlots.push_back(m_storeSlot);
+            }
+            m_pendingChanges |= changes;
+        }
+
+        // 原网格的三角形
+        const vector<Triangle>& GetTriangles() const {
+            return m_mesh ? m_mesh->triangles : EmptyTriangles();
+        }
+
+        // 模型空间包围体，没有网格时无效
+        const Bounds& GetBounds() const {
+            static const Bounds empty;
+            return m_mesh ? m_mesh->bounds : empty;
+        }
+
+        const vector<MeshLod>& GetLods() const {
+            static const vector<MeshLod> empty;
+            return m_mesh ? m_mesh->lods : empty;
+        }
+
+        // 用三角形创建新的网格资源
+        void SetMesh(vector<Triangle> triangles) {
+            SetMesh(Mesh::Create(std::move(triangles)));
+        }
+
+        // 引用已有的网格资源
+        void SetMesh(sptr<const Mesh> newMesh) {
+            m_mesh = std::move(newMesh);
+            lodIndex = 0;
+            MarkChanged(SHAPE_CHANGED_MESH);
+        }
+
+        // 当前级别的网格，顶点阶段与阴影绘制使用
+        const vector<Triangle>& GetRenderMesh() const {
+            if (!m_mesh) {
+                return EmptyTriangles();
+            }
+            return lodIndex > 0 && lodIndex <= (int)m_mesh->lods.size() ? m_mesh->lods[lodIndex - 1].mesh : m_mesh->triangles;
+        }
+
+    private:
+        friend class ShapeStore;
+
+        sptr<const Mesh> m_mesh;
+        sptr<material::IMaterial> m_material;
 
-        vector<Triangle> mesh;
+        //* 所在 ShapeStore 的登记，由 ShapeStore 设置
+        ShapeChangeList* m_changeList = nullptr;
+        uint32_t m_storeSlot = 0;
+        uint32_t m_pendingChanges = 0; // 上次 Sync 以来的变化
 
-        sptr<material::IMaterial> material; // 材质球
+        static const vector<Triangle>& EmptyTriangles() {
+            static const vector<Triangle> empty;
+            return empty;
+        }
     };
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+/// FileName: ShapeBVH.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "ShapeBVH.hpp"
+
+namespace aries::model {
+    int ShapeBVH::Insert(ShapeHandle handle, const ShapeStore& store) {
+        int leaf = AllocateNode();
+        Node& node = nodes[leaf];
+        node.height = 0;
+        node.handle = handle;
+        CopyBounds(node, store, store.RowOf(handle));
+        node.box = Fatten(node.worldBox);
+        InsertLeaf(leaf);
+        ++stats.leafCount;
+        return leaf;
+    }
+
+    void ShapeBVH::Remove(int leaf) {
+        RemoveLeaf(leaf);
+        FreeNode(leaf);
+        --stats.leafCount;
+    }
+
+    void ShapeBVH::Clear() {
+        nodes.clear();
+        root = NULL_NODE;
+        freeList = NULL_NODE;
+        stats = {};
+    }
+
+    void ShapeBVH::Update(const ShapeStore& store) {
+        stats.refitLeaves = stats.reinsertLeaves = stats.removedLeaves = 0;
+        //? 重新插入会分配新的内部节点，nodes 可能扩容，这里只用下标访问
+        for (int i = 0; i < (int)nodes.size(); ++i) {
+            if (nodes[i].height != 0) {
+                continue;
+            }
+            uint32_t row = store.RowOf(nodes[i].handle);
+            if (row == ShapeStore::INVALID_ROW) {
+                Remove(i);
+                ++stats.removedLeaves;
+                continue;
+            }
+            if (store.GetBoundsVersion(row) == nodes[i].boundsVersion) {
+                continue;
+            }
+            CopyBounds(nodes[i], store, row);
+            if (nodes[i].box.Contains(nodes[i].worldBox)) {
+                ++stats.refitLeaves;
+                continue;
+            }
+            RemoveLeaf(i);
+            nodes[i].box = Fatten(nodes[i].worldBox);
+            InsertLeaf(i);
+            ++stats.reinsertLeaves;
+        }
+        stats.height = root == NULL_NODE ? 0 : nodes[root].height;
+    }
+
+    int ShapeBVH::AllocateNode() {
+        int index;
+        if (freeList != NULL_NODE) {
+            index = freeList;
+            freeList = nodes[index].parent;
+            nodes[index] = Node{};
+        } else {
+            index = (int)nodes.size();
+            nodes.emplace_back();
+        }
+        ++stats.nodeCount;
+        return index;
+    }
+
+    void ShapeBVH::FreeNode(int index) {
+        nodes[index] = Node{};
+        nodes[index].parent = freeList;
+        freeList = index;
+        --stats.nodeCount;
+    }
+
+    void ShapeBVH::InsertLeaf(int leaf) {
+        if (root == NULL_NODE) {
+            root = leaf;
+            nodes[leaf].parent = NULL_NODE;
+            return;
+        }
+
+        //* 1. 从根向下选择兄弟节点：比较"在此处新建父节点"与"继续下到某个子节点"的面积代价
+        const AABB leafBox = nodes[leaf].box;
+        int index = root;
+        while (!nodes[index].IsLeaf()) {
+            const Node& node = nodes[index];
+            float area = node.box.HalfArea();
+            float combinedArea = AABB::Union(node.box, leafBox).HalfArea();
+
+            // 在这里新建父节点的代价，以及继续下降时祖先包围盒增大的代价
+            float cost = 2.0f * combinedArea;
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](int child) {
+                const Node& c = nodes[child];
+                float unionArea = AABB::Union(c.box, leafBox).HalfArea();
+                return (c.IsLeaf() ? unionArea : unionArea - c.box.HalfArea()) + inheritanceCost;
+            };
+            float cost1 = descendCost(node.child1);
+            float cost2 = descendCost(node.child2);
+
+            if (cost < cost1 && cost < cost2) {
+                break;
+            }
+            index = cost1 < cost2 ? node.child1 : node.child2;
+        }
+        int sibling = index;
+
+        //* 2. 新建父节点，替换兄弟节点原来的位置
+        int oldParent = nodes[sibling].parent;
+        int newParent = AllocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].box = AABB::Union(leafBox, nodes[sibling].box);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent != NULL_NODE) {
+            if (nodes[oldParent].child1 == sibling) {
+                nodes[oldParent].child1 = newParent;
+            } else {
+                nodes[oldParent].child2 = newParent;
+            }
+        } else {
+            root = newParent;
+        }
+
+        //* 3. 向上更新包围盒与高度
+        RefitUpward(nodes[leaf].parent);
+    }
+
+    void ShapeBVH::RemoveLeaf(int leaf) {
+        if (leaf == root) {
+            root = NULL_NODE;
+            return;
+        }
+
+        int parent = nodes[leaf].parent;
+        int grandParent = nodes[parent].parent;
+        int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        // 兄弟节点顶替父节点的位置，父节点回收
+        if (grandParent != NULL_NODE) {
+            if (nodes[grandParent].child1 == parent) {
+                nodes[grandParent].child1 = sibling;
+            } else {
+                nodes[grandParent].child2 = sibling;
+            }
+            nodes[sibling].parent = grandParent;
+            FreeNode(parent);
+            RefitUpward(grandParent);
+        } else {
+            root = sibling;
+            nodes[sibling].parent = NULL_NODE;
+            FreeNode(parent);
+        }
+        nodes[leaf].parent = NULL_NODE;
+    }
+
+    void ShapeBVH::RefitUpward(int index) {
+        while (index != NULL_NODE) {
+            index = Balance(index);
+            Node& node = nodes[index];
+            node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+            node.box = AABB::Union(nodes[node.child1].box, nodes[node.child2].box);
+            index = node.parent;
+        }
+    }
+
+    int ShapeBVH::Balance(int iA) {
+        Node& A = nodes[iA];
+        if (A.IsLeaf() || A.height < 2) {
+            return iA;
+        }
+
+        int iB = A.child1;
+        int iC = A.child2;
+        int balance = nodes[iC].height - nodes[iB].height;
+
+        // 把较高的子节点 X 旋转到 A 的位置，X 的两个子节点中较高的留在 X 下，较低的交给 A
+        auto rotateUp = [&](int iX, bool xIsChild2) {
+            Node& X = nodes[iX];
+            int iF = X.child1;
+            int iG = X.child2;
+
+            X.child1 = iA;
+            X.parent = A.parent;
+            A.parent = iX;
+            if (X.parent != NULL_NODE) {
+                if (nodes[X.parent].child1 == iA) {
+                    nodes[X.parent].child1 = iX;
+                } else {
+                    nodes[X.parent].child2 = iX;
+                }
+            } else {
+                root = iX;
+            }
+
+            int keep = nodes[iF].height > nodes[iG].height ? iF : iG;
+            int give = keep == iF ? iG : iF;
+            X.child2 = keep;
+            (xIsChild2 ? A.child2 : A.child1) = give;
+            nodes[give].parent = iA;
+
+            A.box = AABB::Union(nodes[A.child1].box, nodes[A.child2].box);
+            A.height = 1 + std::max(nodes[A.child1].height, nodes[A.child2].height);
+            X.box = AABB::Union(A.box, nodes[keep].box);
+            X.height = 1 + std::max(A.height, nodes[keep].height);
+            return iX;
+        };
+
+        if (balance > 1) {
+            return rotateUp(iC, true);
+        }
+        if (balance < -1) {
+            return rotateUp(iB, false);
+        }
+        return iA;
+    }
+
+    void ShapeBVH::CopyBounds(Node& leaf, const ShapeStore& store, uint32_t row) {
+        leaf.worldBox = store.GetWorldBox(row);
+        leaf.hasBounds = store.HasBounds(row);
+        leaf.boundsVersion = store.GetBoundsVersion(row);
+    }
+
+    AABB ShapeBVH::Fatten(const AABB& box) {
+        Vector3f margin = (box.max - box.min) * FAT_MARGIN + Vector3f::Constant(1e-3f);
+        AABB fat;
+        fat.min = box.min - margin;
+        fat.max = box.max + margin;
+        return fat;
+    }
+}
@@ -0,0 +1,126 @@
+/// FileName: ShapeBVH.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 形状世界包围盒上的动态 BVH，世界包围盒变化时增量更新，用于摄像机与光源的视锥查询
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Bounds.hpp"
+#include "ShapeStore.hpp"
+
+namespace aries::model {
+    // BVH 统计
+    struct ShapeBVHStats {
+        int leafCount = 0;      // 叶子（形状）数
+        int nodeCount = 0;      // 使用中的节点数
+        int height = 0;         // 树高
+        int refitLeaves = 0;    // 上一次 Update 中只更新了紧包围盒的叶子数
+        int reinsertLeaves = 0; // 上一次 Update 中越出膨胀包围盒、重新插入的叶子数
+        int removedLeaves = 0;  // 上一次 Update 中因形状销毁移除的叶子数
+    };
+
+    // 动态包围盒层次（增量插入/删除 + 旋转保持平衡），每个叶子对应一个形状
+    //? 叶子在树中使用按 FAT_MARGIN 膨胀的包围盒，物体小幅移动时只更新叶子自己的紧包围盒，不改动树结构；
+    //? 查询时内部节点用膨胀包围盒，叶子用紧包围盒，节点完全在视锥内时整棵子树不再测试
+    class ShapeBVH {
+    public:
+        static constexpr int NULL_NODE = -1;
+        static constexpr float FAT_MARGIN = 0.1f; // 膨胀量占包围盒尺寸的比例
+
+        struct Node {
+            AABB box; // 叶子为膨胀包围盒，内部节点为子节点的并
+            int parent = NULL_NODE;
+            int child1 = NULL_NODE;
+            int child2 = NULL_NODE;
+            int height = -1; // 叶子为 0，空闲节点为 -1
+
+            //* 以下只对叶子有效
+            ShapeHandle handle;         // 形状在 ShapeStore 中的句柄，查询时用 RowOf 取行号
+            uint64_t boundsVersion = 0; // 复制 worldBox 时存储中的包围盒版本，Update 时比较
+            AABB worldBox;              // 紧包围盒（世界空间）
+            bool hasBounds = false;     // 形状已有网格（worldBox 不是退化的占位盒）
+
+            inline bool IsLeaf() const { return child1 == NULL_NODE; }
+        };
+
+        // 加入存储中的形状，返回叶子节点编号
+        int Insert(ShapeHandle handle, const ShapeStore& store);
+
+        // 移除叶子
+        void Remove(int leaf);
+
+        void Clear();
+
+        // 每帧在 store.Sync() 之后调用一次：移除句柄已失效的叶子，包围盒版本变化过的叶子从存储复制世界包围盒
+        //? 世界包围盒由存储计算，这里只比较版本号，没有变化的静态物体不做任何运算
+        void Update(const ShapeStore& store);
+
+        // 查询与视锥体相交的叶子，visit(const Node& leaf, bool inside)，inside 表示叶子的紧包围盒完全在视锥内
+        // 返回访问过的节点数
+        template<typename F>
+        int Query(const Frustum& frustum, F&& visit) const {
+            if (root == NULL_NODE) {
+                return 0;
+            }
+            int visited = 0;
+            struct Entry {
+                int node;
+                bool inside;
+            };
+            Entry stack[MAX_STACK];
+            int top = 0;
+            stack[top++] = {root, false};
+            while (top > 0) {
+                Entry entry = stack[--top];
+                const Node& node = nodes[entry.node];
+                ++visited;
+                Frustum::TestResult result = Frustum::TestResult::Inside;
+                if (!entry.inside) {
+                    result = frustum.Test(node.IsLeaf() ? node.worldBox : node.box);
+                    if (result == Frustum::TestResult::Outside) {
+                        continue;
+                    }
+                }
+                if (node.IsLeaf()) {
+                    visit(node, result == Frustum::TestResult::Inside);
+                    continue;
+                }
+                bool inside = result == Frustum::TestResult::Inside;
+                stack[top++] = {node.child2, inside};
+                stack[top++] = {node.child1, inside};
+            }
+            return visited;
+        }
+
+        const ShapeBVHStats& GetStats() const { return stats; }
+
+    private:
+        //? 旋转使树高保持在 O(log n)，深度优先遍历的栈深不超过树高 + 1
+        static constexpr int MAX_STACK = 128;
+
+        vector<Node> nodes;
+        int root = NULL_NODE;
+        int freeList = NULL_NODE; // 空闲节点通过 parent 串成链表
+        ShapeBVHStats stats;
+
+        int AllocateNode();
+
+        void FreeNode(int index);
+
+        void InsertLeaf(int leaf);
+
+        void RemoveLeaf(int leaf);
+
+        // 从 index 向上重新计算包围盒与高度，沿途做旋转
+        void RefitUpward(int index);
+
+        // 子树高度差超过 1 时把较高的子节点旋转上来，返回子树新的根
+        int Balance(int index);
+
+        // 从存储的第 row 行复制叶子的紧包围盒与版本
+        static void CopyBounds(Node& leaf, const ShapeStore& store, uint32_t row);
+
+        static AABB Fatten(const AABB& box);
+    };
+}
@@ -0,0 +1,161 @@
+/// FileName: ShapeStore.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "ShapeStore.hpp"
+
+namespace aries::model {
+    ShapeHandle ShapeStore::Add(const sptr<Shape>& shape) {
+        uint32_t slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        } else {
+            slot = (uint32_t)m_slots.size();
+            m_slots.emplace_back();
+        }
+        const uint32_t row = Size();
+        m_slots[slot].row = row;
+        ShapeHandle handle{slot, m_slots[slot].generation};
+
+        shape->m_changeList = &m_changes;
+        shape->m_storeSlot = slot;
+        shape->m_pendingChanges = 0;
+
+        m_shapes.push_back(shape.get());
+        m_modelMatrices.push_back(Matrix4f::Identity());
+        m_worldBoxes.emplace_back();
+        m_boundsVersions.push_back(0);
+        m_meshes.push_back(nullptr);
+        m_materials.push_back(nullptr);
+        m_handles.push_back(handle);
+        Refresh(row, SHAPE_CHANGED_ALL);
+
+        m_stats.rows = (int)Size();
+        return handle;
+    }
+
+    void ShapeStore::Remove(ShapeHandle handle) {
+        ApplyRemovals(); // 句柄对应的形状可能已经销毁，先移除这些行，剩下的行可以安全访问形状
+        uint32_t row = RowOf(handle);
+        if (row != INVALID_ROW) {
+            m_shapes[row]->m_changeList = nullptr;
+            RemoveRow(row);
+            m_stats.rows = (int)Size();
+        }
+    }
+
+    void ShapeStore::Clear() {
+        //? 先移除已销毁的形状，剩下的行都还活着，断开它们与本存储的登记
+        ApplyRemovals();
+        for (Shape* shape : m_shapes) {
+            shape->m_changeList = nullptr;
+        }
+        m_changes.changedSlots.clear();
+
+        //? 槽位保留并增加代数，清空前发出的句柄全部失效
+        m_freeSlots.clear();
+        for (uint32_t slot = 0; slot < m_slots.size(); ++slot) {
+            if (m_slots[slot].row != INVALID_ROW) {
+                m_slots[slot].row = INVALID_ROW;
+                ++m_slots[slot].generation;
+            }
+            m_freeSlots.push_back(slot);
+        }
+        m_shapes.clear();
+        m_modelMatrices.clear();
+        m_worldBoxes.clear();
+        m_boundsVersions.clear();
+        m_meshes.clear();
+        m_materials.clear();
+        m_handles.clear();
+        m_stats = {};
+        ++m_stateVersion;
+    }
+
+    void ShapeStore::Sync() {
+        m_stats.updatedRows = m_stats.removedRows = 0;
+        ApplyRemovals();
+
+        //? 已移除形状留下的槽位查不到行，直接跳过；槽位被新形状复用时，新形状没有待处理的变化，同样跳过
+        for (uint32_t slot : m_changes.changedSlots) {
+            const uint32_t row = m_slots[slot].row;
+            if (row == INVALID_ROW) {
+                continue;
+            }
+            const uint32_t changes = std::exchange(m_shapes[row]->m_pendingChanges, 0u);
+            if (changes != 0) {
+                Refresh(row, changes);
+                ++m_stats.updatedRows;
+            }
+        }
+        m_changes.changedSlots.clear();
+        m_stats.rows = (int)Size();
+    }
+
+    void ShapeStore::RemoveExpired() {
+        ApplyRemovals();
+        m_stats.rows = (int)Size();
+    }
+
+    void ShapeStore::ApplyRemovals() {
+        for (uint32_t slot : m_changes.removedSlots) {
+            const uint32_t row = m_slots[slot].row;
+            if (row != INVALID_ROW) {
+                RemoveRow(row);
+                ++m_stats.removedRows;
+            }
+        }
+        m_changes.removedSlots.clear();
+    }
+
+    void ShapeStore::Refresh(uint32_t row, uint32_t changes) {
+        const Shape& shape = *m_shapes[row];
+        if (changes & (SHAPE_CHANGED_MESH | SHAPE_CHANGED_MATERIAL)) {
+            ++m_stateVersion;
+        }
+        m_meshes[row] = shape.GetMesh().get();
+        m_materials[row] = shape.GetMaterial().get();
+        m_modelMatrices[row] = shape.model ? shape.model->GetModelMatrix() : Matrix4f::Identity();
+
+        AABB worldBox;
+        const AABB& localBox = shape.GetBounds().box;
+        if (localBox.IsValid()) {
+            worldBox = localBox.Transformed(m_modelMatrices[row]);
+        } else {
+            //? 还没有网格的形状放一个退化到原点的包围盒，之后设置网格时会移到正确位置
+            worldBox.Expand(Vector3f(m_modelMatrices[row].block<3, 1>(0, 3)));
+        }
+        if ((changes & SHAPE_CHANGED_MESH) || worldBox.min != m_worldBoxes[row].min || worldBox.max != m_worldBoxes[row].max) {
+            m_worldBoxes[row] = worldBox;
+            m_boundsVersions[row] = m_nextBoundsVersion++;
+        }
+    }
+
+    void ShapeStore::RemoveRow(uint32_t row) {
+        Slot& removed = m_slots[m_handles[row].slot];
+        removed.row = INVALID_ROW;
+        ++removed.generation;
+        m_freeSlots.push_back(m_handles[row].slot);
+        ++m_stateVersion;
+
+        const uint32_t last = Size() - 1;
+        if (row != last) {
+            m_shapes[row] = m_shapes[last];
+            m_modelMatrices[row] = m_modelMatrices[last];
+            m_worldBoxes[row] = m_worldBoxes[last];
+            m_boundsVersions[row] = m_boundsVersions[last];
+            m_meshes[row] = m_meshes[last];
+            m_materials[row] = m_materials[last];
+            m_handles[row] = m_handles[last];
+            m_slots[m_handles[row].slot].row = row;
+        }
+        m_shapes.pop_back();
+        m_modelMatrices.pop_back();
+        m_worldBoxes.pop_back();
+        m_boundsVersions.pop_back();
+        m_meshes.pop_back();
+        m_materials.pop_back();
+        m_handles.pop_back();
+    }
+}
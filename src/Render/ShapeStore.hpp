@@ -0,0 +1,124 @@
+/// FileName: ShapeStore.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 渲染用的形状存储：按列连续存放的变换、包围盒、网格与材质，用带代数的句柄寻址
+
+#pragma once
+#include "CommonHeader.hpp"
+
+#include "Bounds.hpp"
+#include "Model.hpp"
+
+namespace aries::material {
+    class IMaterial;
+}
+
+namespace aries::model {
+    // 形状句柄：槽位下标 + 代数，形状移除后槽位复用时代数加一，旧句柄随之失效
+    struct ShapeHandle {
+        static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+
+        uint32_t slot = INVALID_SLOT;
+        uint32_t generation = 0;
+
+        bool operator==(const ShapeHandle&) const = default;
+    };
+
+    // 存储统计
+    struct ShapeStoreStats {
+        int rows = 0;         // 当前行数（形状数）
+        int updatedRows = 0;  // 上一次 Sync 中重新读取的行数
+        int removedRows = 0;  // 上一次 Sync 中因形状销毁移除的行数
+    };
+
+    // 每个形状一行，各列是连续数组，按行号访问；移除时用最后一行填补空位，行始终紧凑
+    //? 每帧的遍历（剔除、LOD、着色器分组、阴影投射者）只读这些列与裸指针，不再 lock weak_ptr 或复制 shared_ptr；
+    //? 形状在网格、材质或模型变换变化、以及销毁时把自己的槽位记进变化列表，Sync 只处理列表里的行，静止的场景不访问任何形状
+    class ShapeStore {
+    public:
+        static constexpr uint32_t INVALID_ROW = std::numeric_limits<uint32_t>::max();
+
+        ShapeStore() = default;
+
+        //? 形状持有指向变化列表的指针，存储不能复制或移动
+        ShapeStore(const ShapeStore&) = delete;
+        ShapeStore& operator=(const ShapeStore&) = delete;
+
+        ~ShapeStore() { Clear(); }
+
+        // 加入形状并立即读取它的变换、网格与材质
+        ShapeHandle Add(const sptr<Shape>& shape);
+
+        // 移除句柄对应的形状，句柄已失效时忽略
+        void Remove(ShapeHandle handle);
+
+        void Clear();
+
+        // 句柄 → 当前行号，句柄失效时返回 INVALID_ROW
+        inline uint32_t RowOf(ShapeHandle handle) const {
+            if (handle.slot >= m_slots.size() || m_slots[handle.slot].generation != handle.generation) {
+                return INVALID_ROW;
+            }
+            return m_slots[handle.slot].row;
+        }
+
+        inline bool Contains(ShapeHandle handle) const { return RowOf(handle) != INVALID_ROW; }
+
+        // 每帧渲染前调用一次：移除已销毁的形状，重新读取登记过变化的行
+        void Sync();
+
+        // 只移除已销毁的形状
+        void RemoveExpired();
+
+        inline uint32_t Size() const { return (uint32_t)m_shapes.size(); }
+
+        const ShapeStoreStats& GetStats() const { return m_stats; }
+
+        // 行的增删、或任意一行的网格、材质变化时加一；按行缓存派生数据（如渲染队列的排序键）的使用者据此判断是否需要重建
+        inline uint64_t GetStateVersion() const { return m_stateVersion; }
+
+        //* 列访问，行号在两次 Add/Remove/Sync 之间保持不变
+        inline Shape* GetShape(uint32_t row) const { return m_shapes[row]; }
+        inline ShapeHandle GetHandle(uint32_t row) const { return m_handles[row]; }
+        inline const Matrix4f& GetModelMatrix(uint32_t row) const { return m_modelMatrices[row]; }
+        inline const AABB& GetWorldBox(uint32_t row) const { return m_worldBoxes[row]; }
+        inline bool HasBounds(uint32_t row) const { return m_meshes[row] && m_meshes[row]->bounds.box.IsValid(); }
+        inline const Mesh* GetMesh(uint32_t row) const { return m_meshes[row]; }
+        inline material::IMaterial* GetMaterial(uint32_t row) const { return m_materials[row]; }
+
+        // 世界包围盒每变化一次加一（全局递增，不会与移除前同一行的旧值相同），BVH 据此判断叶子是否过期
+        inline uint64_t GetBoundsVersion(uint32_t row) const { return m_boundsVersions[row]; }
+
+    private:
+        struct Slot {
+            uint32_t row = INVALID_ROW;
+            uint32_t generation = 0;
+        };
+
+        vector<Slot> m_slots;
+        vector<uint32_t> m_freeSlots;
+        ShapeChangeList m_changes;
+        ShapeStoreStats m_stats;
+        uint64_t m_nextBoundsVersion = 1;
+        uint64_t m_stateVersion = 0;
+
+        //* 每帧遍历的热数据
+        //? 网格与材质由形状持有，形状销毁后这一行在下一次 Sync 时移除，之前不会被读取
+        vector<Shape*> m_shapes;
+        vector<Matrix4f> m_modelMatrices;
+        vector<AABB> m_worldBoxes;
+        vector<uint64_t> m_boundsVersions;
+        vector<const Mesh*> m_meshes;
+        vector<material::IMaterial*> m_materials;
+        vector<ShapeHandle> m_handles;
+
+        // 按变化标记从形状重新读取一行
+        void Refresh(uint32_t row, uint32_t changes);
+
+        // 移除登记为已销毁的形状
+        void ApplyRemovals();
+
+        // 用最后一行填补 row 并回收槽位，不访问形状（它可能已经销毁）
+        void RemoveRow(uint32_t row);
+    };
+}
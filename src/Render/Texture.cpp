@@ -7,34 +7,458 @@
 #include "Texture.hpp"
 #include <cmath>
 #include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace {
+    uint16_t QuantizeTo565(const Vector3f& c) {
+        int r = std::clamp((int)std::lround(c.x() * 31.0f / 255.0f), 0, 31);
+        int g = std::clamp((int)std::lround(c.y() * 63.0f / 255.0f), 0, 63);
+        int b = std::clamp((int)std::lround(c.z() * 31.0f / 255.0f), 0, 31);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    // 编码一个 4x4 块：端点取纹素在主轴（协方差矩阵最大特征向量）上投影的两端，再为每个纹素选最近的调色板颜色
+    BC1Block EncodeBC1Block(const Texel (&texels)[16]) {
+        Vector3f colors[16];
+        Vector3f mean = Vector3f::Zero();
+        for (int i = 0; i < 16; ++i) {
+            colors[i] = Vector3f(texels[i].r, texels[i].g, texels[i].b);
+            mean += colors[i];
+        }
+        mean /= 16.0f;
+
+        Eigen::Matrix3f cov = Eigen::Matrix3f::Zero();
+        for (const auto& c : colors) {
+            Vector3f d = c - mean;
+            cov += d * d.transpose();
+        }
+
+        // 幂迭代求主轴，纯色块协方差为 0 时退回亮度方向
+        Vector3f axis(1.0f, 1.0f, 1.0f);
+        for (int iter = 0; iter < 8; ++iter) {
+            Vector3f next = cov * axis;
+            float len = next.norm();
+            if (len < 1e-6f) break;
+            axis = next / len;
+        }
+        axis.normalize();
+
+        float minT = 0.0f, maxT = 0.0f;
+        for (const auto& c : colors) {
+            float t = (c - mean).dot(axis);
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        BC1Block block{QuantizeTo565(mean + axis * maxT), QuantizeTo565(mean + axis * minT), 0};
+        if (block.color0 < block.color1) {
+            std::swap(block.color0, block.color1);
+        }
+        if (block.color0 == block.color1) {
+            return block; // 三色模式下下标 0 就是端点颜色
+        }
+
+        // 用解码器同样的调色板挑选下标，保证编码与解码一致
+        Texel palette[16];
+        TextureFormatTraits<TextureFormat::BC1>::DecodeBlock(BC1Block{block.color0, block.color1, 0xE4E4E4E4u}, palette);
+        for (int i = 0; i < 16; ++i) {
+            int best = 0;
+            float bestDist = std::numeric_limits<float>::max();
+            for (int k = 0; k < 4; ++k) {
+                float dist = (Vector3f(palette[k].r, palette[k].g, palette[k].b) - colors[i]).squaredNorm();
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = k;
+                }
+            }
+            block.indices |= (uint32_t)best << (2 * i);
+        }
+        return block;
+    }
+}
 
 bool Texture::LoadFromFile(const std::string& filename) {
+    // 要求 stbi 直接输出 4 通道，灰度/RGB 图在这里展开，采样时不再关心源通道数
     unsigned char* img = stbi_load(
-        filename.c_str(), &width, &height, &channels, 0);
+        filename.c_str(), &width, &height, &channels, 4);
     if (!img) {
         return false;
     }
-    data.assign(img, img + width * height * channels);
+    const Texel* texels = reinterpret_cast<const Texel*>(img);
+    std::vector<LinearLevel> linearLevels(1);
+    linearLevels[0] = {width, height, std::vector<Texel>(texels, texels + (size_t)width * height)};
     stbi_image_free(img);
+    Pack(linearLevels);
     return true;
 }
 
+void Texture::LoadFromTexels(int w, int h, const std::vector<Texel>& texels) {
+    width = w;
+    height = h;
+    channels = 4;
+    Pack({LinearLevel{w, h, texels}});
+}
+
+std::vector<Texel> Texture::ReadTexels() const {
+    return levels.empty() ? std::vector<Texel>() : Unpack(levels[0]).texels;
+}
+
+Texture::MipLevel Texture::MakeLevel(int levelWidth, int levelHeight) const {
+    using TiledTraits = TextureLayoutTraits<TextureLayout::Tiled>;
+    using LinearTraits = TextureLayoutTraits<TextureLayout::Linear>;
+    const size_t blockTexels = std::size(TexelBlock{}.texels);
+    const size_t bc1PerBlock = sizeof(TexelBlock) / sizeof(BC1Block);
+
+    MipLevel level;
+    level.width = levelWidth;
+    level.height = levelHeight;
+    level.tilesX = TiledTraits::TileCount(levelWidth);
+    if (format == TextureFormat::BC1) {
+        size_t bc1Blocks = (size_t)level.tilesX * TiledTraits::TileCount(levelHeight);
+        level.blockCount = (bc1Blocks + bc1PerBlock - 1) / bc1PerBlock;
+    } else {
+        size_t texelCount = (layout == TextureLayout::Tiled)
+            ? TiledTraits::StorageSize(levelWidth, levelHeight)
+            : LinearTraits::StorageSize(levelWidth, levelHeight);
+        level.blockCount = (texelCount + blockTexels - 1) / blockTexels;
+    }
+    return level;
+}
+
+void Texture::Pack(const std::vector<LinearLevel>& linearLevels) {
+    using TiledTraits = TextureLayoutTraits<TextureLayout::Tiled>;
+    using LinearTraits = TextureLayoutTraits<TextureLayout::Linear>;
+
+    //* 1. 计算每级的分块数与在连续存储中的偏移
+    levels.assign(linearLevels.size(), MipLevel{});
+    size_t totalBlocks = 0;
+    for (size_t i = 0; i < linearLevels.size(); ++i) {
+        MipLevel& level = levels[i];
+        level = MakeLevel(linearLevels[i].width, linearLevels[i].height);
+        level.blockOffset = totalBlocks;
+        totalBlocks += level.blockCount;
+    }
+
+    //* 2. 按格式与布局写入新的存储，之后不再引用映射文件
+    std::vector<TexelBlock> packed(totalBlocks, TexelBlock{});
+    for (size_t i = 0; i < linearLevels.size(); ++i) {
+        const LinearLevel& src = linearLevels[i];
+        const MipLevel& level = levels[i];
+        if (format == TextureFormat::BC1) {
+            // 逐个 4x4 块编码，越界的纹素夹取到边缘
+            BC1Block* dst = reinterpret_cast<BC1Block*>(packed[level.blockOffset].texels);
+            int tilesY = TiledTraits::TileCount(src.height);
+            for (int by = 0; by < tilesY; ++by) {
+                for (int bx = 0; bx < level.tilesX; ++bx) {
+                    Texel block[16];
+                    for (int k = 0; k < 16; ++k) {
+                        int x = std::min(bx * 4 + (k & 3), src.width - 1);
+                        int y = std::min(by * 4 + (k >> 2), src.height - 1);
+                        block[k] = src.texels[(size_t)y * src.width + x];
+                    }
+                    dst[(size_t)by * level.tilesX + bx] = EncodeBC1Block(block);
+                }
+            }
+            continue;
+        }
+        Texel* dst = packed[level.blockOffset].texels;
+        for (int y = 0; y < src.height; ++y) {
+            for (int x = 0; x < src.width; ++x) {
+                size_t idx = (layout == TextureLayout::Tiled)
+                    ? TiledTraits::RowOffset(y, src.width, level.tilesX) + TiledTraits::ColumnOffset(x)
+                    : LinearTraits::RowOffset(y, src.width, level.tilesX) + LinearTraits::ColumnOffset(x);
+                dst[idx] = src.texels[(size_t)y * src.width + x];
+            }
+        }
+    }
+
+    ownedBlocks = std::move(packed);
+    blocks = ownedBlocks.data();
+    mapping.reset();
+    storageId = NextTextureStorageId();
+    if (virtualTexture) {
+        RebuildVirtual();
+    }
+}
+
+Texture::LinearLevel Texture::Unpack(const MipLevel& level) const {
+    LinearLevel linear{level.width, level.height, std::vector<Texel>((size_t)level.width * level.height)};
+    if (format == TextureFormat::BC1) {
+        const auto view = MakeView<TextureFormat::BC1, TextureLayout::Tiled>(level);
+        int tilesY = TextureLayoutTraits<TextureLayout::Tiled>::TileCount(level.height);
+        for (int by = 0; by < tilesY; ++by) {
+            for (int bx = 0; bx < level.tilesX; ++bx) {
+                Texel block[16];
+                TextureFormatTraits<TextureFormat::BC1>::DecodeBlock(view.data[(size_t)by * level.tilesX + bx], block);
+                for (int k = 0; k < 16; ++k) {
+                    int x = bx * 4 + (k & 3), y = by * 4 + (k >> 2);
+                    if (x < level.width && y < level.height) {
+                        linear.texels[(size_t)y * level.width + x] = block[k];
+                    }
+                }
+            }
+        }
+        return linear;
+    }
+
+    auto read = [&](const auto& view) {
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                linear.texels[(size_t)y * level.width + x] = view.data[view.Index(x, y)];
+            }
+        }
+    };
+    if (layout == TextureLayout::Tiled) {
+        read(MakeView<TextureFormat::RGBA8, TextureLayout::Tiled>(level));
+    } else {
+        read(MakeView<TextureFormat::RGBA8, TextureLayout::Linear>(level));
+    }
+    return linear;
+}
+
+void Texture::SetLayout(TextureLayout newLayout) {
+    if (newLayout == layout) {
+        return;
+    }
+    if (format == TextureFormat::BC1) {
+        layout = newLayout; // 压缩块的排列与布局无关，避免无意义的重新编码
+        return;
+    }
+    std::vector<LinearLevel> linearLevels;
+    linearLevels.reserve(levels.size());
+    for (const auto& level : levels) {
+        linearLevels.push_back(Unpack(level));
+    }
+    layout = newLayout;
+    Pack(linearLevels);
+}
+
+void Texture::SetFormat(TextureFormat newFormat) {
+    if (newFormat == format || levels.empty()) {
+        return;
+    }
+    std::vector<LinearLevel> linearLevels;
+    linearLevels.reserve(levels.size());
+    for (const auto& level : levels) {
+        linearLevels.push_back(Unpack(level));
+    }
+    format = newFormat;
+    Pack(linearLevels);
+}
+
+void Texture::GenerateMipmaps() {
+    if (levels.empty()) {
+        return;
+    }
+
+    std::vector<LinearLevel> linearLevels;
+    linearLevels.push_back(Unpack(levels[0]));
+    while (linearLevels.back().width > 1 || linearLevels.back().height > 1) {
+        const LinearLevel& src = linearLevels.back();
+        LinearLevel dst;
+        dst.width = std::max(1, src.width / 2);
+        dst.height = std::max(1, src.height / 2);
+        dst.texels.resize((size_t)dst.width * dst.height);
+
+        for (int y = 0; y < dst.height; ++y) {
+            // 奇数尺寸时最后一行/列夹取到边缘
+            int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+                const Texel& a = src.texels[(size_t)y0 * src.width + x0];
+                const Texel& b = src.texels[(size_t)y0 * src.width + x1];
+                const Texel& c = src.texels[(size_t)y1 * src.width + x0];
+                const Texel& d = src.texels[(size_t)y1 * src.width + x1];
+                auto avg = [](int p, int q, int r, int s) { return (uint8_t)((p + q + r + s + 2) / 4); };
+                dst.texels[(size_t)y * dst.width + x] = Texel{
+                    avg(a.r, b.r, c.r, d.r),
+                    avg(a.g, b.g, c.g, d.g),
+                    avg(a.b, b.b, c.b, d.b),
+                    avg(a.a, b.a, c.a, d.a),
+                };
+            }
+        }
+        linearLevels.push_back(std::move(dst));
+    }
+    Pack(linearLevels);
+}
+
+Texture Texture::Clone() const {
+    Texture copy;
+    copy.width = width;
+    copy.height = height;
+    copy.channels = channels;
+    copy.levels = levels;
+    copy.filter = filter;
+    copy.layout = layout;
+    copy.format = format;
+    size_t totalBlocks = levels.empty() ? 0 : levels.back().blockOffset + levels.back().blockCount;
+    copy.ownedBlocks.assign(blocks, blocks + totalBlocks);
+    copy.blocks = copy.ownedBlocks.data();
+    copy.storageId = NextTextureStorageId();
+    if (virtualTexture) {
+        copy.RebuildVirtual(); // 副本从只有常驻级别的空页表开始
+    }
+    return copy;
+}
+
+size_t Texture::GetMemoryBytes() const {
+    size_t bytes = 0;
+    //? 虚拟纹理的后备存储是映射时只在调页时读取，由系统按需换入换出，不计入占用
+    if (!virtualTexture || !mapping) {
+        for (const auto& level : levels) {
+            bytes += level.blockCount * sizeof(TexelBlock);
+        }
+    }
+    if (virtualTexture) {
+        bytes += virtualTexture->GetMemoryBytes();
+    }
+    return bytes;
+}
+
+void Texture::SetVirtual(bool enable) {
+    if (enable == IsVirtual()) {
+        return;
+    }
+    if (enable) {
+        RebuildVirtual();
+    } else {
+        virtualTexture.reset();
+    }
+}
+
+void Texture::RebuildVirtual() {
+    std::vector<std::pair<int, int>> levelSizes;
+    levelSizes.reserve(levels.size());
+    for (const auto& level : levels) {
+        levelSizes.emplace_back(level.width, level.height);
+    }
+    //? 加载函数每次调用时传入而不是存进 VirtualTexture，纹理被移动之后不会留下悬空的 this
+    virtualTexture.reset();
+    if (!levels.empty()) {
+        virtualTexture = std::make_unique<VirtualTexture>(levelSizes, [this](int level, int x0, int y0, int w, int h, Texel* out) {
+            LoadRegion(level, x0, y0, w, h, out);
+        });
+    }
+}
+
+void Texture::UpdateVirtualPages(size_t maxResidentPages, int maxUploads) {
+    if (!virtualTexture) {
+        return;
+    }
+    virtualTexture->Update(maxResidentPages, maxUploads, [this](int level, int x0, int y0, int w, int h, Texel* out) {
+        LoadRegion(level, x0, y0, w, h, out);
+    });
+}
+
+VirtualTextureStats Texture::GetVirtualStats() const {
+    return virtualTexture ? virtualTexture->GetStats() : VirtualTextureStats{};
+}
+
+void Texture::LoadRegion(int level, int x0, int y0, int w, int h, Texel* out) const {
+    if (format == TextureFormat::BC1) {
+        LoadRegionWith<TextureFormat::BC1, TextureLayout::Tiled>(level, x0, y0, w, h, out);
+    } else if (layout == TextureLayout::Tiled) {
+        LoadRegionWith<TextureFormat::RGBA8, TextureLayout::Tiled>(level, x0, y0, w, h, out);
+    } else {
+        LoadRegionWith<TextureFormat::RGBA8, TextureLayout::Linear>(level, x0, y0, w, h, out);
+    }
+}
+
+template<TextureFormat F, TextureLayout L>
+void Texture::LoadRegionWith(int level, int x0, int y0, int w, int h, Texel* out) const {
+    const auto view = MakeView<F, L>(levels[level]);
+    for (int y = 0; y < h; ++y) {
+        size_t row = view.RowOffset((y0 + y) % view.height);
+        for (int x = 0; x < w; ++x) {
+            // 逐纹素读取，BC1 经过解码块缓存，一行页宽只涉及几十个块，基本都能命中
+            Vector4f c = view.Fetch(row, view.ColumnOffset((x0 + x) % view.width));
+            out[(size_t)y * w + x] = Texel{(uint8_t)c.x(), (uint8_t)c.y(), (uint8_t)c.z(), (uint8_t)c.w()};
+        }
+    }
+}
+
 Vector3f Texture::Sample(float u, float v) const {
-    if (data.empty() || width <= 0 || height <= 0) {
+    return SampleLod(u, v, 0.0f);
+}
+
+Vector3f Texture::Sample(float u, float v, const TextureGradient& grad) const {
+    if (filter == TextureFilter::Nearest) {
+        return SampleLod(u, v, 0.0f);
+    }
+    return SampleLod(u, v, ComputeLod(grad));
+}
+
+float Texture::ComputeLod(const TextureGradient& grad) const {
+    Vector2f size((float)width, (float)height);
+    float lenX = grad.dUVdx.cwiseProduct(size).squaredNorm();
+    float lenY = grad.dUVdy.cwiseProduct(size).squaredNorm();
+    float rho2 = std::max(lenX, lenY);
+    if (!(rho2 > 1.0f)) {
+        return 0.0f; // 放大或导数无效（NaN）时使用第 0 级
+    }
+    return 0.5f * std::log2(rho2);
+}
+
+Vector3f Texture::SampleLod(float u, float v, float lod) const {
+    if (levels.empty() || width <= 0 || height <= 0) {
         return Vector3f(1.0f, 1.0f, 1.0f);
     }
-    // 循环 UV
+    if (virtualTexture) {
+        return SampleVirtual(u, v, lod);
+    }
+    // 格式与布局只在这里分派一次，之后的读取全部在编译期确定
+    if (format == TextureFormat::BC1) {
+        return SampleLodWith<TextureFormat::BC1, TextureLayout::Tiled>(u, v, lod);
+    }
+    if (layout == TextureLayout::Tiled) {
+        return SampleLodWith<TextureFormat::RGBA8, TextureLayout::Tiled>(u, v, lod);
+    }
+    return SampleLodWith<TextureFormat::RGBA8, TextureLayout::Linear>(u, v, lod);
+}
+
+template<TextureFormat F, TextureLayout L>
+Vector3f Texture::SampleLodWith(float u, float v, float lod) const {
+    using Sampler = TextureSampler<F, L>;
+
+    int maxLevel = (int)levels.size() - 1;
+    lod = std::clamp(lod, 0.0f, (float)maxLevel);
+
+    switch (filter) {
+    case TextureFilter::Nearest:
+        return Sampler::Nearest(MakeView<F, L>(levels[0]), u, v);
+    case TextureFilter::Bilinear:
+        return Sampler::Bilinear(MakeView<F, L>(levels[std::min((int)(lod + 0.5f), maxLevel)]), u, v);
+    case TextureFilter::Trilinear:
+    default: {
+        int l0 = (int)lod;
+        int l1 = std::min(l0 + 1, maxLevel);
+        float t = (l0 == l1) ? 0.0f : lod - l0;
+        return Sampler::Trilinear(MakeView<F, L>(levels[l0]), MakeView<F, L>(levels[l1]), u, v, t);
+    }
+    }
+}
+
+Vector3f Texture::SampleVirtual(float u, float v, float lod) const {
+    // 循环 UV 并翻转 v 轴，与 TextureSampler 的约定一致
     u = u - std::floor(u);
-    v = v - std::floor(v);
-    // 翻转 v 轴（stbi 原点在左上）
-    v = 1.0f - v;
-
-    int x = std::clamp(int(u * width), 0, width - 1);
-    int y = std::clamp(int(v * height), 0, height - 1);
-    int idx = (y * width + x) * channels;
-
-    float r = data[idx + 0] / 255.0f;
-    float g = (channels >= 2 ? data[idx + 1] : data[idx + 0]) / 255.0f;
-    float b = (channels >= 3 ? data[idx + 2] : data[idx + 0]) / 255.0f;
-    return Vector3f(r, g, b);
-}
\ No newline at end of file
+    v = 1.0f - (v - std::floor(v));
+
+    int maxLevel = (int)levels.size() - 1;
+    lod = std::clamp(lod, 0.0f, (float)maxLevel);
+
+    switch (filter) {
+    case TextureFilter::Nearest:
+        return virtualTexture->Nearest(u, v);
+    case TextureFilter::Bilinear:
+        return virtualTexture->Bilinear(u, v, std::min((int)(lod + 0.5f), maxLevel));
+    case TextureFilter::Trilinear:
+    default: {
+        int l0 = (int)lod;
+        int l1 = std::min(l0 + 1, maxLevel);
+        float t = (l0 == l1) ? 0.0f : lod - l0;
+        return virtualTexture->Trilinear(u, v, l0, l1, t);
+    }
+    }
+}
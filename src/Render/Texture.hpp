@@ -3,26 +3,156 @@
 /// Author: ChaomengOrion
 
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include <Core>
+#include "TextureStorage.hpp"
+#include "MappedFile.hpp"
+#include "VirtualTexture.hpp"
 
+using Eigen::Vector2f;
 using Eigen::Vector3f;
 
+// 纹理过滤模式
+enum class TextureFilter {
+    Nearest,   // 最近邻，只读第 0 级（不使用 mipmap）
+    Bilinear,  // 在最接近的 mip 级别上双线性过滤
+    Trilinear, // 在相邻两个 mip 级别上双线性过滤后再按 LOD 小数部分混合
+};
+
+// 屏幕空间 UV 导数（每移动一个像素 UV 的变化量），由光栅化阶段按三角形解析计算，不参与插值
+struct TextureGradient {
+    Vector2f dUVdx = Vector2f::Zero();
+    Vector2f dUVdy = Vector2f::Zero();
+};
+
 class Texture {
 public:
-    // 从文件加载 PNG（或其他 stbi 支持格式）
+    // 从文件加载 PNG（或其他 stbi 支持格式），统一转换为 RGBA8
     // 返回 true 表示加载成功
     bool LoadFromFile(const std::string& filename);
 
+    // 用行主序的 RGBA8 纹素创建纹理（只有第 0 级），供程序生成的纹理（如图集）使用
+    void LoadFromTexels(int w, int h, const std::vector<Texel>& texels);
+
+    // 按行主序读出第 0 级的 RGBA8 纹素（BC1 会解码）
+    std::vector<Texel> ReadTexels() const;
+
+    // 用 2x2 盒式滤波生成完整的 mip 链（直到 1x1）
+    void GenerateMipmaps();
+
     // 根据 UV 坐标获取颜色，u,v 在 [0,1] 区间循环
     // 返回 Vector3f(r,g,b)，范围 [0,1]
     Vector3f Sample(float u, float v) const;
 
+    // 按屏幕空间 UV 导数选择 mip 级别后采样
+    Vector3f Sample(float u, float v, const TextureGradient& grad) const;
+
+    // 在指定 LOD 处采样
+    Vector3f SampleLod(float u, float v, float lod) const;
+
+    // 由 UV 导数计算 LOD（log2 of 每像素覆盖的纹素数）
+    float ComputeLod(const TextureGradient& grad) const;
+
     inline int GetWidth() const { return width; }
     
     inline int GetHeight() const { return height; }
+
+    inline int GetMipLevelCount() const { return (int)levels.size(); }
+
+    inline TextureFilter GetFilter() const { return filter; }
+
+    inline void SetFilter(TextureFilter f) { filter = f; }
+
+    // 源图像的通道数（内部存储是 RGBA8 或 BC1）
+    inline int GetSourceChannels() const { return channels; }
+
+    inline TextureLayout GetLayout() const { return layout; }
+
+    // 切换内存布局，会重排所有 mip 级别；BC1 纹理总是按 4x4 块存放，只记录设置，转回 RGBA8 时生效
+    void SetLayout(TextureLayout newLayout);
+
+    inline TextureFormat GetFormat() const { return format; }
+
+    // 切换存储格式，会重新编码所有 mip 级别（BC1 有损，转回 RGBA8 得到的是解码后的结果）
+    void SetFormat(TextureFormat newFormat);
+
+    // 所有 mip 级别占用的字节数
+    size_t GetMemoryBytes() const;
+
+    // 深拷贝一份（映射的纹理会拷贝到堆上），用于在副本上做有损转换
+    Texture Clone() const;
+
+    // 纹素数据是否直接映射自磁盘缓存文件（未拷贝到堆上）
+    inline bool IsMapped() const { return mapping != nullptr; }
+
+    // 切换虚拟纹理模式：开启后采样只读驻留的页，原有存储（最好是磁盘缓存的映射）只作为解码页的后备
+    void SetVirtual(bool enable);
+
+    inline bool IsVirtual() const { return virtualTexture != nullptr; }
+
+    // 按上一帧的采样反馈调入/淘汰虚拟页，不能与采样并发
+    void UpdateVirtualPages(size_t maxResidentPages, int maxUploads);
+
+    // 虚拟纹理的驻留统计，非虚拟纹理返回全零
+    VirtualTextureStats GetVirtualStats() const;
 private:
+    friend class TextureCache;
+
+    struct MipLevel {
+        int width = 0, height = 0, tilesX = 0;
+        size_t blockOffset = 0, blockCount = 0; // 在 blocks 中的位置
+    };
+
+    // 一个 mip 级别的行主序纹素，生成 mip 链和重排布局时使用
+    struct LinearLevel {
+        int width = 0, height = 0;
+        std::vector<Texel> texels;
+    };
+
     int width = 0, height = 0, channels = 0;
-    std::vector<uint8_t> data;  // 原始像素数据（行主序）
-};
\ No newline at end of file
+    std::vector<MipLevel> levels; // 第 0 级为原图
+    TextureFilter filter = TextureFilter::Trilinear;
+    TextureLayout layout = TextureLayout::Tiled;
+    TextureFormat format = TextureFormat::RGBA8;
+    uint64_t storageId = 0; // 存储被替换时更新，作为 BC1 解码缓存键的一部分
+
+    //? 所有 mip 级别连续存放在同一段按缓存行对齐的内存里：
+    //? 要么是自己持有的 ownedBlocks，要么是磁盘缓存的只读映射（零拷贝），blocks 指向其中之一
+    const TexelBlock* blocks = nullptr;
+    std::vector<TexelBlock> ownedBlocks;
+    std::unique_ptr<MappedFile> mapping;
+    std::unique_ptr<VirtualTexture> virtualTexture; // 非空时为虚拟纹理模式
+
+    // 按当前格式与布局计算一个 mip 级别的分块数与纹素块数（blockOffset 留空）
+    MipLevel MakeLevel(int levelWidth, int levelHeight) const;
+
+    // 按当前格式与布局把各级行主序纹素打包进 ownedBlocks，替换原有存储
+    void Pack(const std::vector<LinearLevel>& linearLevels);
+
+    // 把 mip 级别按行主序读出（BC1 会解码）
+    LinearLevel Unpack(const MipLevel& level) const;
+
+    template<TextureFormat F, TextureLayout L>
+    TextureView<F, L> MakeView(const MipLevel& level) const {
+        using storage_t = typename TextureFormatTraits<F>::storage_t;
+        const auto* data = reinterpret_cast<const storage_t*>(blocks[level.blockOffset].texels);
+        uint64_t levelKey = (storageId << 8) | (uint64_t)(&level - levels.data());
+        return TextureView<F, L>{data, level.width, level.height, level.tilesX, levelKey};
+    }
+
+    template<TextureFormat F, TextureLayout L>
+    Vector3f SampleLodWith(float u, float v, float lod) const;
+
+    Vector3f SampleVirtual(float u, float v, float lod) const;
+
+    // 虚拟页的后备读取：从当前存储读出一块区域（坐标循环）并解码成 RGBA8
+    void LoadRegion(int level, int x0, int y0, int w, int h, Texel* out) const;
+
+    template<TextureFormat F, TextureLayout L>
+    void LoadRegionWith(int level, int x0, int y0, int w, int h, Texel* out) const;
+
+    // 按当前 mip 链重建页表（存储被替换后旧的页全部作废）
+    void RebuildVirtual();
+};
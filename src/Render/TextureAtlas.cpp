@@ -0,0 +1,107 @@
+/// FileName: TextureAtlas.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "TextureAtlas.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+TextureAtlasResult TextureAtlas::Pack(const std::vector<std::shared_ptr<Texture>>& textures, int maxSize, int padding) {
+    struct Cell {
+        size_t index;  // 输入纹理下标
+        int w, h;      // 含边距、按 ALIGN 取整后的占用尺寸
+        int atlas = -1;
+        int x = 0, y = 0;
+    };
+    auto alignUp = [](int v) { return (v + ALIGN - 1) / ALIGN * ALIGN; };
+
+    TextureAtlasResult result;
+    result.regions.resize(textures.size());
+
+    //* 1. 计算每张纹理占用的格子，放不进一张图集的跳过
+    std::vector<Cell> cells;
+    size_t totalArea = 0;
+    int widest = 0;
+    for (size_t i = 0; i < textures.size(); ++i) {
+        const auto& texture = textures[i];
+        if (!texture || texture->GetWidth() <= 0 || texture->GetHeight() <= 0) {
+            continue;
+        }
+        Cell cell{i, alignUp(texture->GetWidth() + 2 * padding), alignUp(texture->GetHeight() + 2 * padding)};
+        if (cell.w > maxSize || cell.h > maxSize) {
+            continue;
+        }
+        totalArea += (size_t)cell.w * cell.h;
+        widest = std::max(widest, cell.w);
+        cells.push_back(cell);
+    }
+    if (cells.empty()) {
+        return result;
+    }
+
+    //* 2. 货架排布：按高度从高到低，一行放满换下一行，超过 maxSize 开新图集
+    //? 宽度取能放下总面积的最小 2 的幂，少量纹理不会铺出一张大部分空白的图集
+    std::sort(cells.begin(), cells.end(), [](const Cell& a, const Cell& b) {
+        return a.h != b.h ? a.h > b.h : a.w > b.w;
+    });
+    int atlasWidth = (int)std::bit_ceil((unsigned)std::ceil(std::sqrt((double)totalArea)));
+    atlasWidth = std::min(std::max(atlasWidth, widest), maxSize);
+
+    std::vector<int> atlasHeights;
+    int shelfX = 0, shelfY = 0, shelfHeight = 0;
+    atlasHeights.push_back(0);
+    for (auto& cell : cells) {
+        if (shelfX + cell.w > atlasWidth) {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        if (shelfY + cell.h > maxSize) {
+            atlasHeights.push_back(0);
+            shelfX = shelfY = shelfHeight = 0;
+        }
+        cell.atlas = (int)atlasHeights.size() - 1;
+        cell.x = shelfX;
+        cell.y = shelfY;
+        shelfX += cell.w;
+        shelfHeight = std::max(shelfHeight, cell.h);
+        atlasHeights.back() = std::max(atlasHeights.back(), shelfY + shelfHeight);
+    }
+
+    //* 3. 拷贝纹素，边距与取整多出的部分按子纹理循环填充
+    std::vector<std::vector<Texel>> pixels(atlasHeights.size());
+    for (size_t a = 0; a < atlasHeights.size(); ++a) {
+        pixels[a].assign((size_t)atlasWidth * atlasHeights[a], Texel{0, 0, 0, 255});
+    }
+    for (const auto& cell : cells) {
+        const Texture& texture = *textures[cell.index];
+        std::vector<Texel> src = texture.ReadTexels();
+        int w = texture.GetWidth(), h = texture.GetHeight();
+        std::vector<Texel>& dst = pixels[cell.atlas];
+        for (int y = 0; y < cell.h; ++y) {
+            int sy = ((y - padding) % h + h) % h;
+            for (int x = 0; x < cell.w; ++x) {
+                int sx = ((x - padding) % w + w) % w;
+                dst[(size_t)(cell.y + y) * atlasWidth + cell.x + x] = src[(size_t)sy * w + sx];
+            }
+        }
+
+        // 纹理的 v 轴向上、纹素行从上往下存，子纹理左上角纹素在 (x0, y0)
+        float W = (float)atlasWidth, H = (float)atlasHeights[cell.atlas];
+        int x0 = cell.x + padding, y0 = cell.y + padding;
+        AtlasRegion& region = result.regions[cell.index];
+        region.atlas = cell.atlas;
+        region.scale = Vector2f(w / W, h / H);
+        region.offset = Vector2f(x0 / W, 1.0f - (y0 + h) / H);
+    }
+
+    //* 4. 生成图集纹理与 mip 链
+    for (size_t a = 0; a < atlasHeights.size(); ++a) {
+        auto atlas = std::make_shared<Texture>();
+        atlas->LoadFromTexels(atlasWidth, atlasHeights[a], pixels[a]);
+        atlas->GenerateMipmaps();
+        result.atlases.push_back(std::move(atlas));
+    }
+    return result;
+}
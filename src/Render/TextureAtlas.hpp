@@ -0,0 +1,37 @@
+/// FileName: TextureAtlas.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 把多张小纹理打包进共享图集（按行货架排布，带循环填充的边距）
+
+#pragma once
+#include "Texture.hpp"
+#include <memory>
+#include <vector>
+
+// 子纹理在图集中的位置，Remap 把子纹理的 UV 换算成图集 UV
+struct AtlasRegion {
+    int atlas = -1; // 所在图集的下标，-1 表示没有放入图集（尺寸超限）
+    Vector2f offset = Vector2f::Zero();
+    Vector2f scale = Vector2f::Ones();
+
+    // 只对 [0,1] 内的 UV 有效，图集里的子纹理不能循环
+    inline Vector2f Remap(const Vector2f& uv) const {
+        return offset + uv.cwiseProduct(scale);
+    }
+};
+
+struct TextureAtlasResult {
+    std::vector<std::shared_ptr<Texture>> atlases; // 已生成 mip 链的图集纹理
+    std::vector<AtlasRegion> regions;              // 与输入纹理一一对应
+};
+
+class TextureAtlas {
+public:
+    // 子纹理的起点按 ALIGN 对齐，前 log2(ALIGN) 级 mipmap 的盒式滤波不会跨越子纹理边界
+    static constexpr int ALIGN = 4;
+
+    // 把 textures 打包进边长不超过 maxSize 的图集，每张子纹理四周留 padding 个纹素
+    //? 边距用子纹理自身循环填充，第 0 级双线性在边缘采到的与原纹理循环寻址完全一致；
+    //? 更粗的级别只要过滤足迹不超过边距就不会混入相邻子纹理
+    static TextureAtlasResult Pack(const std::vector<std::shared_ptr<Texture>>& textures, int maxSize, int padding);
+};
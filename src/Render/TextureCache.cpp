@@ -0,0 +1,224 @@
+/// FileName: TextureCache.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "TextureCache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr char CACHE_MAGIC[8] = {'A', 'R', 'T', 'E', 'X', 'C', '\0', '\0'};
+    constexpr uint32_t CACHE_VERSION = 2; // 2: 增加存储格式
+
+    // 文件头，紧跟 levelCount 个 CacheLevel、源路径字符串，再填充到 dataOffset 处开始存放纹素块
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t pathLength;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        int32_t width, height, channels, layout;
+        uint32_t levelCount;
+        int32_t format;
+        uint64_t dataOffset; // 按 TexelBlock 对齐，映射基址按页对齐，所以映射后的纹素块仍然对齐
+        uint64_t blockCount;
+    };
+
+    struct CacheLevel {
+        int32_t width, height, tilesX, reserved;
+        uint64_t blockOffset, blockCount;
+    };
+
+    std::string& CacheDirectory() {
+        static std::string directory = "cache/textures";
+        return directory;
+    }
+
+    bool& CacheEnabled() {
+        static bool enabled = true;
+        return enabled;
+    }
+
+    // FNV-1a 64 位哈希，用于生成缓存文件名
+    uint64_t HashPath(const std::string& path) {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c : path) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+void TextureCache::SetDirectory(const std::string& directory) {
+    CacheDirectory() = directory;
+}
+
+const std::string& TextureCache::GetDirectory() {
+    return CacheDirectory();
+}
+
+void TextureCache::SetEnabled(bool enabled) {
+    CacheEnabled() = enabled;
+}
+
+bool TextureCache::IsEnabled() {
+    return CacheEnabled();
+}
+
+bool TextureCache::MakeSourceKey(const std::string& sourcePath, SourceKey& key) {
+    std::error_code ec;
+    fs::path path = fs::absolute(sourcePath, ec).lexically_normal();
+    if (ec) return false;
+    key.size = (uint64_t)fs::file_size(path, ec);
+    if (ec) return false;
+    key.mtime = (int64_t)fs::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) return false;
+    key.path = path.generic_string();
+    return true;
+}
+
+std::string TextureCache::CacheFilePath(const SourceKey& key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.atex", (unsigned long long)HashPath(key.path));
+    return (fs::path(CacheDirectory()) / name).string();
+}
+
+std::shared_ptr<Texture> TextureCache::Load(const std::string& sourcePath) {
+    SourceKey key;
+    if (!CacheEnabled() || !MakeSourceKey(sourcePath, key)) {
+        return nullptr;
+    }
+
+    auto mapped = MappedFile::Open(CacheFilePath(key));
+    if (!mapped || mapped->Size() < sizeof(CacheHeader)) {
+        return nullptr;
+    }
+
+    //* 1. 校验文件头与缓存键，源文件改过（大小或修改时间不同）就视为过期
+    const uint8_t* base = mapped->Data();
+    const size_t fileSize = mapped->Size();
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+        header.sourceSize != key.size || header.sourceMtime != key.mtime || header.pathLength != key.path.size() ||
+        header.levelCount == 0 || header.dataOffset % alignof(TexelBlock) != 0 ||
+        header.layout < 0 || header.layout > (int32_t)TextureLayout::Tiled ||
+        header.format < 0 || header.format > (int32_t)TextureFormat::BC1) {
+        return nullptr;
+    }
+    size_t tableEnd = sizeof(CacheHeader) + (size_t)header.levelCount * sizeof(CacheLevel);
+    if (tableEnd + header.pathLength > header.dataOffset || header.dataOffset > fileSize ||
+        (fileSize - header.dataOffset) / sizeof(TexelBlock) != header.blockCount ||
+        std::memcmp(base + tableEnd, key.path.data(), key.path.size()) != 0) {
+        return nullptr; // 文件被截断，或是哈希碰撞到了别的路径
+    }
+
+    //* 2. 读取 mip 级别表，每级的分块数、纹素块数与偏移都按打包时的算法重新计算并核对
+    //? 损坏或手工改过的缓存在这里被拒绝，回退为重新解码源图，而不是让采样读出映射范围
+    auto texture = std::make_shared<Texture>();
+    texture->width = header.width;
+    texture->height = header.height;
+    texture->channels = header.channels;
+    texture->layout = (TextureLayout)header.layout;
+    texture->format = (TextureFormat)header.format;
+    texture->levels.resize(header.levelCount);
+    uint64_t expectedOffset = 0;
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        CacheLevel level;
+        std::memcpy(&level, base + sizeof(CacheHeader) + (size_t)i * sizeof(CacheLevel), sizeof(level));
+        if (level.width <= 0 || level.height <= 0) {
+            return nullptr;
+        }
+        Texture::MipLevel expected = texture->MakeLevel(level.width, level.height);
+        if (level.tilesX != expected.tilesX || level.blockCount != expected.blockCount || level.blockOffset != expectedOffset) {
+            return nullptr;
+        }
+        expected.blockOffset = (size_t)expectedOffset;
+        expectedOffset += expected.blockCount;
+        texture->levels[i] = expected;
+    }
+    if (expectedOffset != header.blockCount ||
+        texture->levels[0].width != header.width || texture->levels[0].height != header.height) {
+        return nullptr;
+    }
+
+    //* 3. 纹素块直接指向映射内存，不拷贝
+    texture->blocks = reinterpret_cast<const TexelBlock*>(base + header.dataOffset);
+    texture->mapping = std::move(mapped);
+    texture->storageId = NextTextureStorageId();
+    return texture;
+}
+
+bool TextureCache::Store(const std::string& sourcePath, const Texture& texture) {
+    SourceKey key;
+    if (!CacheEnabled() || texture.levels.empty() || !MakeSourceKey(sourcePath, key)) {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(CacheDirectory(), ec);
+    if (ec) {
+        std::cout << "[TextureCache] 无法创建缓存目录: " << CacheDirectory() << std::endl;
+        return false;
+    }
+
+    //* 1. 填写文件头与 mip 级别表
+    uint64_t blockCount = 0;
+    std::vector<CacheLevel> levels;
+    levels.reserve(texture.levels.size());
+    for (const auto& level : texture.levels) {
+        levels.push_back({level.width, level.height, level.tilesX, 0, (uint64_t)level.blockOffset, (uint64_t)level.blockCount});
+        blockCount = std::max<uint64_t>(blockCount, level.blockOffset + level.blockCount);
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.pathLength = (uint32_t)key.path.size();
+    header.sourceSize = key.size;
+    header.sourceMtime = key.mtime;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.channels = texture.channels;
+    header.layout = (int32_t)texture.layout;
+    header.format = (int32_t)texture.format;
+    header.levelCount = (uint32_t)levels.size();
+    size_t tableEnd = sizeof(CacheHeader) + levels.size() * sizeof(CacheLevel) + key.path.size();
+    header.dataOffset = (tableEnd + alignof(TexelBlock) - 1) / alignof(TexelBlock) * alignof(TexelBlock);
+    header.blockCount = blockCount;
+
+    //* 2. 写临时文件，成功后替换正式文件
+    std::string cachePath = CacheFilePath(key);
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        const char padding[alignof(TexelBlock)] = {};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(CacheLevel));
+        out.write(key.path.data(), key.path.size());
+        out.write(padding, header.dataOffset - tableEnd);
+        out.write(reinterpret_cast<const char*>(texture.blocks), blockCount * sizeof(TexelBlock));
+        if (!out) {
+            out.close();
+            fs::remove(tempPath, ec);
+            return false;
+        }
+    }
+    fs::rename(tempPath, cachePath, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,39 @@
+/// FileName: TextureCache.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 解码后纹理（含 mip 链，按存储格式与内存布局排好）的磁盘缓存，命中时直接映射为纹理存储
+
+#pragma once
+#include "Texture.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class TextureCache {
+public:
+    // 缓存文件所在目录，默认 "cache/textures"（相对工作目录）
+    static void SetDirectory(const std::string& directory);
+    static const std::string& GetDirectory();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // 按源文件路径、大小和修改时间查找缓存，命中时返回零拷贝映射的纹理
+    // 未命中、已过期或文件损坏时返回 nullptr
+    static std::shared_ptr<Texture> Load(const std::string& sourcePath);
+
+    // 把纹理当前的 mip 链、格式和布局写入缓存，写临时文件后再替换，中途失败不会留下半个文件
+    static bool Store(const std::string& sourcePath, const Texture& texture);
+
+private:
+    // 缓存键：源文件的规范化绝对路径、大小与修改时间
+    struct SourceKey {
+        std::string path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    };
+
+    static bool MakeSourceKey(const std::string& sourcePath, SourceKey& key);
+
+    static std::string CacheFilePath(const SourceKey& key);
+};
@@ -2,13 +2,46 @@
 /// Date: 2025/05/29
 /// Author: ChaomengOrion
 
+#pragma once
 #include "Texture.hpp"
+#include "TextureCache.hpp"
+#include <chrono>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <omp.h>
 
 class TextureManager {
+public:
+    // 纹理占用情况的快照，供 UI 显示
+    struct TextureInfo {
+        std::string path;
+        std::shared_ptr<Texture> texture;
+        size_t memoryBytes = 0;
+        bool inUse = false; // 除管理器外是否还有别处（材质）引用
+    };
+
 private:
-    std::unordered_map<std::string, std::shared_ptr<Texture>> textures;
+    struct Entry {
+        std::shared_ptr<Texture> texture;
+        std::list<std::string>::iterator lruIt; // 在 lru 中的位置
+        size_t memoryBytes = 0;
+    };
+
+    //? 所有成员都由 mutex 保护；解码在锁外进行，多个线程可以同时解码不同的纹理
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> textures;
+    std::list<std::string> lru;              // 最近使用的在前面
+    size_t memoryUsage = 0;                  // 所有已加载纹理的字节数
+    size_t memoryBudget = size_t(1) << 30;   // 默认 1 GB
+    size_t evictedCount = 0;
+    TextureFormat defaultFormat = TextureFormat::RGBA8; // 新加载纹理的存储格式
+    size_t virtualThreshold = size_t(64) << 20;         // 原图按 RGBA8 超过这个字节数（大于 4096x4096）时使用虚拟纹理
+    size_t virtualBudget = size_t(256) << 20;           // 所有虚拟纹理驻留页的总预算
+    int virtualUploadsPerFrame = 64;                    // 每个虚拟纹理每帧最多载入的页数
 
 public:
     TextureManager() = default;
@@ -23,31 +56,320 @@ public:
         return instance;
     }
 
-    // 加载纹理
+    // 加载纹理，线程安全
     std::shared_ptr<Texture> LoadTexture(const std::string& path) {
+        {
+            std::lock_guard lock(mutex);
+            auto it = textures.find(path);
+            if (it != textures.end()) {
+                Touch(it->second);
+                return it->second.texture; // 如果已存在，返回现有纹理
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        // 优先映射磁盘缓存，未命中时再解码源文件、生成 mip 链并写回缓存
+        auto texture = TextureCache::Load(path);
+        bool fromCache = texture != nullptr;
+        if (!fromCache) {
+            texture = std::make_shared<Texture>();
+            if (!texture->LoadFromFile(path)) {
+                throw std::runtime_error("Failed to load texture from " + path);
+            }
+            texture->GenerateMipmaps(); // 加载时生成 mip 链，远处表面读取小尺寸级别
+        }
+        // 缓存里是别的格式时在这里转换（BC1 在此编码），并用新格式覆盖缓存
+        TextureFormat format = GetDefaultFormat();
+        bool converted = texture->GetFormat() != format;
+        texture->SetFormat(format);
+        if (!fromCache || converted) {
+            TextureCache::Store(path, *texture);
+        }
+        if (IsVirtualCandidate(*texture)) {
+            // 虚拟纹理以磁盘缓存为后备：刚解码的完整数据换成缓存文件的只读映射，堆上只留驻留页
+            if (!texture->IsMapped()) {
+                if (auto mapped = TextureCache::Load(path)) {
+                    mapped->SetFilter(texture->GetFilter());
+                    texture = mapped;
+                } else {
+                    std::cerr << "[TextureManager] 磁盘缓存不可用，虚拟纹理的后备数据留在堆上: " << path << std::endl;
+                }
+            }
+            texture->SetVirtual(true);
+        }
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard lock(mutex);
         auto it = textures.find(path);
         if (it != textures.end()) {
-            return it->second; // 如果已存在，返回现有纹理
+            // 其他线程同时加载了同一张纹理，使用先放进来的那份
+            Touch(it->second);
+            return it->second.texture;
+        }
+        Insert(path, texture); // 存储新加载的纹理
+        std::cout << "[TextureManager] 纹理加载成功: " << path << "（" << texture->GetMipLevelCount() << " 级 mipmap，"
+                  << (fromCache ? "缓存映射" : "解码") << " " << elapsed.count() << " ms" << (texture->IsVirtual() ? "，虚拟纹理" : "") << "）" << std::endl;
+        EnforceBudget();
+        return texture;
+    }
+
+    // 并行加载一组纹理，返回与 paths 一一对应的结果，加载失败的位置为 nullptr（错误只打印不抛出）
+    std::vector<std::shared_ptr<Texture>> LoadTextures(const std::vector<std::string>& paths) {
+        // 去重后再分给线程，同一路径只解码一次
+        std::vector<std::string> unique;
+        std::unordered_set<std::string> seen;
+        for (const auto& path : paths) {
+            if (seen.insert(path).second) {
+                unique.push_back(path);
+            }
+        }
+
+        std::vector<std::shared_ptr<Texture>> loaded(unique.size());
+        const int count = (int)unique.size();
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < count; ++i) {
+            try {
+                loaded[i] = LoadTexture(unique[i]);
+            } catch (const std::exception& e) {
+                std::lock_guard lock(mutex);
+                std::cerr << "[TextureManager] 加载纹理失败: " << e.what() << std::endl;
+            }
+        }
+
+        std::unordered_map<std::string, std::shared_ptr<Texture>> byPath;
+        for (int i = 0; i < count; ++i) {
+            byPath[unique[i]] = loaded[i];
+        }
+        std::vector<std::shared_ptr<Texture>> results;
+        results.reserve(paths.size());
+        for (const auto& path : paths) {
+            results.push_back(byPath[path]);
+        }
+        return results;
+    }
+
+    // 登记程序生成的纹理（如图集），参与内存统计与预算；同名的旧纹理被替换
+    void AddTexture(const std::string& key, const std::shared_ptr<Texture>& texture) {
+        std::lock_guard lock(mutex);
+        auto it = textures.find(key);
+        if (it != textures.end()) {
+            memoryUsage -= it->second.memoryBytes;
+            lru.erase(it->second.lruIt);
+            textures.erase(it);
+        }
+        Insert(key, texture);
+        EnforceBudget();
+    }
+
+    // 新加载纹理使用的存储格式
+    void SetDefaultFormat(TextureFormat format) {
+        std::lock_guard lock(mutex);
+        defaultFormat = format;
+    }
+
+    TextureFormat GetDefaultFormat() const {
+        std::lock_guard lock(mutex);
+        return defaultFormat;
+    }
+
+    // 把所有已加载纹理转换为指定格式（并行编码），并更新内存统计
+    void ConvertAll(TextureFormat format) {
+        std::vector<std::shared_ptr<Texture>> all;
+        {
+            std::lock_guard lock(mutex);
+            for (const auto& [path, entry] : textures) {
+                all.push_back(entry.texture);
+            }
         }
 
-        auto texture = std::make_shared<Texture>();
-        if (texture->LoadFromFile(path)) {
-            textures[path] = texture; // 存储新加载的纹理
-            std::cout << "[TextureManager] 纹理加载成功: " << path << std::endl;
-            return texture;
-        } else {
-            throw std::runtime_error("Failed to load texture from " + path);
+        const int count = (int)all.size();
+#pragma omp parallel for schedule(dynamic, 1)
+        for (int i = 0; i < count; ++i) {
+            all[i]->SetFormat(format);
         }
+
+        RefreshMemoryUsage();
+    }
+
+    // 原图按 RGBA8 超过 bytes 字节的纹理在加载时切换为虚拟纹理
+    void SetVirtualThreshold(size_t bytes) {
+        std::lock_guard lock(mutex);
+        virtualThreshold = bytes;
+    }
+
+    size_t GetVirtualThreshold() const {
+        std::lock_guard lock(mutex);
+        return virtualThreshold;
+    }
+
+    // 纹理的原图是否超过虚拟纹理阈值
+    bool IsVirtualCandidate(const Texture& texture) const {
+        std::lock_guard lock(mutex);
+        return (size_t)texture.GetWidth() * texture.GetHeight() * sizeof(Texel) > virtualThreshold;
+    }
+
+    // 所有虚拟纹理驻留页的总预算（字节），平均分给各张虚拟纹理
+    void SetVirtualBudget(size_t bytes) {
+        std::lock_guard lock(mutex);
+        virtualBudget = bytes;
+    }
+
+    size_t GetVirtualBudget() const {
+        std::lock_guard lock(mutex);
+        return virtualBudget;
+    }
+
+    void SetVirtualUploadsPerFrame(int pages) {
+        std::lock_guard lock(mutex);
+        virtualUploadsPerFrame = pages;
+    }
+
+    int GetVirtualUploadsPerFrame() const {
+        std::lock_guard lock(mutex);
+        return virtualUploadsPerFrame;
+    }
+
+    // 一帧渲染结束后调用：按采样反馈为各虚拟纹理调入缺失的页、淘汰久未使用的页
+    //? 调页不持有锁，期间不能有线程采样这些纹理（Pipeline::Render 末尾满足这一点）
+    void UpdateVirtualTextures() {
+        std::vector<std::shared_ptr<Texture>> virtuals;
+        size_t budget;
+        int uploads;
+        {
+            std::lock_guard lock(mutex);
+            for (const auto& [path, entry] : textures) {
+                if (entry.texture->IsVirtual()) {
+                    virtuals.push_back(entry.texture);
+                }
+            }
+            budget = virtualBudget;
+            uploads = virtualUploadsPerFrame;
+        }
+        if (virtuals.empty()) {
+            return;
+        }
+
+        size_t pagesPerTexture = budget / VirtualTexture::PAGE_BYTES / virtuals.size();
+        for (const auto& texture : virtuals) {
+            texture->UpdateVirtualPages(pagesPerTexture, uploads);
+        }
+        RefreshMemoryUsage();
+    }
+
+    // 所有虚拟纹理上一帧的驻留统计之和
+    VirtualTextureStats GetVirtualStats() const {
+        std::lock_guard lock(mutex);
+        VirtualTextureStats total;
+        for (const auto& [path, entry] : textures) {
+            VirtualTextureStats s = entry.texture->GetVirtualStats();
+            total.totalPages += s.totalPages;
+            total.residentPages += s.residentPages;
+            total.residentBytes += s.residentBytes;
+            total.requestedPages += s.requestedPages;
+            total.missingPages += s.missingPages;
+            total.loadedPages += s.loadedPages;
+            total.evictedPages += s.evictedPages;
+        }
+        return total;
+    }
+
+    // 纹理被外部修改（转换格式、重排布局）之后重新统计内存占用
+    void RefreshMemoryUsage() {
+        std::lock_guard lock(mutex);
+        memoryUsage = 0;
+        for (auto& [path, entry] : textures) {
+            entry.memoryBytes = entry.texture->GetMemoryBytes();
+            memoryUsage += entry.memoryBytes;
+        }
+        EnforceBudget();
+    }
+
+    // 设置纹理内存预算（字节），超出时按最近最少使用的顺序淘汰空闲纹理
+    void SetMemoryBudget(size_t bytes) {
+        std::lock_guard lock(mutex);
+        memoryBudget = bytes;
+        EnforceBudget();
+    }
+
+    size_t GetMemoryBudget() const {
+        std::lock_guard lock(mutex);
+        return memoryBudget;
+    }
+
+    size_t GetMemoryUsage() const {
+        std::lock_guard lock(mutex);
+        return memoryUsage;
+    }
+
+    // 累计因超出预算而淘汰的纹理数
+    size_t GetEvictedCount() const {
+        std::lock_guard lock(mutex);
+        return evictedCount;
+    }
+
+    // 重新检查预算：材质释放纹理之后调用，让空闲纹理有机会被淘汰
+    void Trim() {
+        std::lock_guard lock(mutex);
+        EnforceBudget();
+    }
+
+    // 已加载纹理的快照，按最近使用排序
+    std::vector<TextureInfo> GetTextureInfos() const {
+        std::lock_guard lock(mutex);
+        std::vector<TextureInfo> infos;
+        infos.reserve(lru.size());
+        for (const auto& path : lru) {
+            const Entry& entry = textures.at(path);
+            bool inUse = entry.texture.use_count() > 1; // 先判断，拷贝进快照之后计数会变
+            infos.push_back({path, entry.texture, entry.memoryBytes, inUse});
+        }
+        return infos;
     }
 
     // 清除未使用的纹理
     void ClearUnusedTextures() {
+        std::lock_guard lock(mutex);
         for (auto it = textures.begin(); it != textures.end();) {
-            if (it->second.use_count() == 1) { // 如果没有其他引用，删除
+            if (it->second.texture.use_count() == 1) { // 如果没有其他引用，删除
+                memoryUsage -= it->second.memoryBytes;
+                lru.erase(it->second.lruIt);
                 it = textures.erase(it);
             } else {
                 ++it;
             }
         }
     }
-};
\ No newline at end of file
+
+private:
+    // 以下函数要求调用方已持有 mutex
+
+    void Touch(Entry& entry) {
+        lru.splice(lru.begin(), lru, entry.lruIt);
+    }
+
+    void Insert(const std::string& path, const std::shared_ptr<Texture>& texture) {
+        lru.push_front(path);
+        Entry entry{texture, lru.begin(), texture->GetMemoryBytes()};
+        memoryUsage += entry.memoryBytes;
+        textures.emplace(path, std::move(entry));
+    }
+
+    // 从最久未使用的一端开始淘汰空闲纹理（只有管理器自己持有引用），直到回到预算以内
+    //? 仍被材质引用的纹理即使超出预算也不会淘汰，否则下次加载会得到另一份拷贝
+    void EnforceBudget() {
+        for (auto it = lru.end(); memoryUsage > memoryBudget && it != lru.begin();) {
+            --it;
+            auto entryIt = textures.find(*it);
+            if (entryIt->second.texture.use_count() > 1) {
+                continue;
+            }
+            std::cout << "[TextureManager] 超出内存预算，淘汰纹理: " << *it << std::endl;
+            memoryUsage -= entryIt->second.memoryBytes;
+            textures.erase(entryIt);
+            it = lru.erase(it);
+            ++evictedCount;
+        }
+    }
+};
@@ -0,0 +1,259 @@
+/// FileName: TextureStorage.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 纹理的内部存储格式、内存布局与按格式/布局特化的采样器
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <Core>
+
+using Eigen::Vector3f;
+using Eigen::Vector4f;
+
+// RGBA8 纹素，加载时所有纹理统一转换成这个格式，采样时不再按通道数分支
+struct Texel {
+    uint8_t r, g, b, a;
+};
+
+// 一条缓存行大小的纹素块：4x4 个 RGBA8 纹素，64 字节对齐
+struct alignas(64) TexelBlock {
+    Texel texels[16];
+};
+
+// BC1 压缩块：4x4 纹素共 8 字节，两个 RGB565 端点加 16 个 2 位调色板下标（第 i 个纹素占第 2i、2i+1 位）
+struct BC1Block {
+    uint16_t color0, color1;
+    uint32_t indices;
+};
+
+// 纹理内部存储格式
+enum class TextureFormat {
+    RGBA8, // 每纹素 4 字节
+    BC1,   // 每纹素 0.5 字节，采样时解码，只保留 RGB（alpha 固定为 255）
+};
+
+// 纹理内存布局
+enum class TextureLayout {
+    Linear, // 行主序
+    Tiled,  // 4x4 分块，一个块正好一条缓存行，双线性的 2x2 邻域大多落在同一块内
+};
+
+// 每个线程私有的 BC1 解码块缓存（直接映射），双线性的 4 次读取和相邻像素大多命中同一个块
+struct DecodedBlockCache {
+    static constexpr int SIZE = 64;
+
+    struct Entry {
+        uint64_t levelKey = 0; // 0 表示空
+        size_t block = 0;
+        Texel texels[16];
+    };
+    Entry entries[SIZE];
+    uint64_t hits = 0, misses = 0;
+
+    static DecodedBlockCache& Get() {
+        thread_local DecodedBlockCache cache;
+        return cache;
+    }
+};
+
+// 为每次纹理存储（重新打包或映射）分配的唯一标识，用作解码缓存键的一部分，存储被替换后旧的缓存项自然失效
+inline uint64_t NextTextureStorageId() {
+    static std::atomic<uint64_t> nextId{1};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 存储格式的存储单元与纹素读取，offset = 行偏移 + 列偏移
+template<TextureFormat F>
+struct TextureFormatTraits;
+
+template<>
+struct TextureFormatTraits<TextureFormat::RGBA8> {
+    using storage_t = Texel;
+
+    inline static Vector4f Fetch(const storage_t* data, size_t offset, uint64_t) {
+        const Texel& t = data[offset];
+        return Vector4f(t.r, t.g, t.b, t.a);
+    }
+};
+
+template<>
+struct TextureFormatTraits<TextureFormat::BC1> {
+    using storage_t = BC1Block;
+
+    inline static Texel Expand565(uint16_t c) {
+        uint8_t r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+        return Texel{(uint8_t)((r << 3) | (r >> 2)), (uint8_t)((g << 2) | (g >> 4)), (uint8_t)((b << 3) | (b >> 2)), 255};
+    }
+
+    // 解码一整块，纹素按块内行主序输出
+    inline static void DecodeBlock(const BC1Block& block, Texel (&out)[16]) {
+        Texel palette[4];
+        palette[0] = Expand565(block.color0);
+        palette[1] = Expand565(block.color1);
+        auto mix = [&](int w0, int w1, int d) {
+            const Texel& a = palette[0];
+            const Texel& b = palette[1];
+            return Texel{(uint8_t)((a.r * w0 + b.r * w1) / d), (uint8_t)((a.g * w0 + b.g * w1) / d), (uint8_t)((a.b * w0 + b.b * w1) / d), 255};
+        };
+        if (block.color0 > block.color1) {
+            palette[2] = mix(2, 1, 3);
+            palette[3] = mix(1, 2, 3);
+        } else {
+            palette[2] = mix(1, 1, 2);
+            palette[3] = Texel{0, 0, 0, 255}; //? 三色模式的第 4 色本应透明，这里只关心 RGB
+        }
+        for (int i = 0; i < 16; ++i) {
+            out[i] = palette[(block.indices >> (2 * i)) & 3];
+        }
+    }
+
+    // 偏移的高位是块号，低 4 位是块内下标（与 Tiled 布局的偏移计算方式相同）
+    inline static Vector4f Fetch(const storage_t* data, size_t offset, uint64_t levelKey) {
+        size_t block = offset >> 4;
+        DecodedBlockCache& cache = DecodedBlockCache::Get();
+        DecodedBlockCache::Entry& entry = cache.entries[(block ^ (levelKey * 0x9E3779B97F4A7C15ull >> 58)) & (DecodedBlockCache::SIZE - 1)];
+        if (entry.levelKey != levelKey || entry.block != block) {
+            DecodeBlock(data[block], entry.texels);
+            entry.levelKey = levelKey;
+            entry.block = block;
+            ++cache.misses;
+        } else {
+            ++cache.hits;
+        }
+        const Texel& t = entry.texels[offset & 15];
+        return Vector4f(t.r, t.g, t.b, t.a);
+    }
+};
+
+// 纹素坐标到存储下标的映射：下标 = 行偏移(y) + 列偏移(x)
+template<TextureLayout L>
+struct TextureLayoutTraits;
+
+template<>
+struct TextureLayoutTraits<TextureLayout::Linear> {
+    inline static size_t RowOffset(int y, int width, int) {
+        return (size_t)y * width;
+    }
+
+    inline static size_t ColumnOffset(int x) {
+        return (size_t)x;
+    }
+
+    inline static size_t StorageSize(int width, int height) {
+        return (size_t)width * height;
+    }
+};
+
+template<>
+struct TextureLayoutTraits<TextureLayout::Tiled> {
+    static constexpr int TILE_SHIFT = 2; // 4x4
+    static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+    static constexpr int TILE_MASK = TILE_SIZE - 1;
+
+    //? 块内用行主序而不是 Morton 序：整块只占一条缓存行，块内顺序不影响命中，
+    //? 而行主序让下标可以拆成只依赖 y 的行偏移加只依赖 x 的列偏移，双线性四次读取只需各算两次
+    inline static size_t RowOffset(int y, int, int tilesX) {
+        return ((size_t)(y >> TILE_SHIFT) * tilesX << (2 * TILE_SHIFT)) + ((size_t)(y & TILE_MASK) << TILE_SHIFT);
+    }
+
+    inline static size_t ColumnOffset(int x) {
+        return ((size_t)(x >> TILE_SHIFT) << (2 * TILE_SHIFT)) + (size_t)(x & TILE_MASK);
+    }
+
+    // 覆盖 pixels 个纹素需要的分块数
+    inline static int TileCount(int pixels) {
+        return (pixels + TILE_MASK) >> TILE_SHIFT;
+    }
+
+    inline static size_t StorageSize(int width, int height) {
+        return (size_t)TileCount(width) * TileCount(height) * TILE_SIZE * TILE_SIZE;
+    }
+};
+
+// 特定格式与布局下某一 mip 级别的只读视图，所有分支在编译期确定
+template<TextureFormat F, TextureLayout L>
+struct TextureView {
+    static_assert(F == TextureFormat::RGBA8 || L == TextureLayout::Tiled, "块压缩格式只能按 4x4 分块存放");
+
+    using format_t = TextureFormatTraits<F>;
+    using layout_t = TextureLayoutTraits<L>;
+    using storage_t = typename format_t::storage_t;
+
+    const storage_t* data;
+    int width, height, tilesX;
+    uint64_t levelKey; // 解码缓存键：存储标识与 mip 级别
+
+    inline size_t RowOffset(int y) const {
+        return layout_t::RowOffset(y, width, tilesX);
+    }
+
+    inline size_t ColumnOffset(int x) const {
+        return layout_t::ColumnOffset(x);
+    }
+
+    inline size_t Index(int x, int y) const {
+        return RowOffset(y) + ColumnOffset(x);
+    }
+
+    // 按预先算好的偏移读取纹素，返回 [0,255] 范围的 RGBA，归一化留到过滤之后统一做一次
+    inline Vector4f Fetch(size_t rowOffset, size_t columnOffset) const {
+        return format_t::Fetch(data, rowOffset + columnOffset, levelKey);
+    }
+
+    inline Vector4f Fetch(int x, int y) const {
+        return Fetch(RowOffset(y), ColumnOffset(x));
+    }
+};
+
+// 按格式与布局特化的采样器，u,v 在 [0,1] 区间循环
+template<TextureFormat F, TextureLayout L>
+struct TextureSampler {
+    using view_t = TextureView<F, L>;
+
+    static constexpr float INV_255 = 1.0f / 255.0f;
+
+    inline static Vector3f Nearest(const view_t& view, float u, float v) {
+        // 循环 UV 并翻转 v 轴（stbi 原点在左上）
+        u = u - std::floor(u);
+        v = 1.0f - (v - std::floor(v));
+
+        int x = std::clamp(int(u * view.width), 0, view.width - 1);
+        int y = std::clamp(int(v * view.height), 0, view.height - 1);
+        return view.Fetch(x, y).template head<3>() * INV_255;
+    }
+
+    // 返回未归一化的结果，三线性混合两级之后再统一缩放
+    inline static Vector4f BilinearRaw(const view_t& view, float u, float v) {
+        u = u - std::floor(u);
+        v = 1.0f - (v - std::floor(v));
+
+        // 纹素中心在 (i + 0.5) / size，UV 循环所以邻居也循环取
+        float fx = u * view.width - 0.5f;
+        float fy = v * view.height - 0.5f;
+        int x0 = (int)std::floor(fx), y0 = (int)std::floor(fy);
+        float tx = fx - x0, ty = fy - y0;
+
+        auto wrap = [](int i, int size) { return i < 0 ? i + size : (i >= size ? i - size : i); };
+        size_t c0 = view.ColumnOffset(wrap(x0, view.width)), c1 = view.ColumnOffset(wrap(x0 + 1, view.width));
+        size_t r0 = view.RowOffset(wrap(y0, view.height)), r1 = view.RowOffset(wrap(y0 + 1, view.height));
+
+        Vector4f top = view.Fetch(r0, c0) * (1.0f - tx) + view.Fetch(r0, c1) * tx;
+        Vector4f bottom = view.Fetch(r1, c0) * (1.0f - tx) + view.Fetch(r1, c1) * tx;
+        return top * (1.0f - ty) + bottom * ty;
+    }
+
+    inline static Vector3f Bilinear(const view_t& view, float u, float v) {
+        return BilinearRaw(view, u, v).template head<3>() * INV_255;
+    }
+
+    inline static Vector3f Trilinear(const view_t& fine, const view_t& coarse, float u, float v, float t) {
+        Vector4f c = BilinearRaw(fine, u, v);
+        if (t > 0.0f) {
+            c = c * (1.0f - t) + BilinearRaw(coarse, u, v) * t;
+        }
+        return c.template head<3>() * INV_255;
+    }
+};
@@ -0,0 +1,191 @@
+/// FileName: VirtualTexture.cpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+
+#include "VirtualTexture.hpp"
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+namespace {
+    constexpr float INV_255 = 1.0f / 255.0f;
+
+    inline Vector4f ToVector(const Texel& t) {
+        return Vector4f(t.r, t.g, t.b, t.a);
+    }
+}
+
+VirtualTexture::VirtualTexture(const std::vector<std::pair<int, int>>& levelSizes, const PageLoader& load) {
+    levels.resize(levelSizes.size());
+    for (size_t i = 0; i < levelSizes.size(); ++i) {
+        Level& level = levels[i];
+        level.width = levelSizes[i].first;
+        level.height = levelSizes[i].second;
+        level.pagesX = (level.width + PAGE_MASK) >> PAGE_SHIFT;
+        level.pagesY = (level.height + PAGE_MASK) >> PAGE_SHIFT;
+        level.pinned = level.pagesX * level.pagesY == 1;
+        level.pages = std::make_unique<Page[]>((size_t)level.pagesX * level.pagesY);
+        if (level.pinned) {
+            LoadPage((int)i, 0, load);
+        } else {
+            stats.totalPages += (size_t)level.pagesX * level.pagesY;
+        }
+    }
+    stats.residentBytes = residentBytes;
+}
+
+void VirtualTexture::LoadPage(int levelIndex, size_t pageIndex, const PageLoader& load) {
+    Level& level = levels[levelIndex];
+    int x0 = (int)(pageIndex % level.pagesX) << PAGE_SHIFT;
+    int y0 = (int)(pageIndex / level.pagesX) << PAGE_SHIFT;
+    int w = level.PageWidth(x0) + 1, h = level.PageHeight(y0) + 1;
+    auto texels = std::make_unique<Texel[]>((size_t)w * h);
+    load(levelIndex, x0, y0, w, h, texels.get());
+    level.pages[pageIndex].texels = std::move(texels);
+    residentBytes += (size_t)w * h * sizeof(Texel);
+}
+
+void VirtualTexture::Update(size_t maxResidentPages, int maxUploads, const PageLoader& load) {
+    struct PageRef {
+        int level;
+        size_t index;
+        uint32_t touched;
+    };
+
+    //* 1. 读取反馈：本帧请求但未驻留的页，以及本帧没有用到、可以淘汰的驻留页
+    std::vector<PageRef> missing, evictable;
+    size_t requested = 0;
+    for (int l = 0; l < (int)levels.size(); ++l) {
+        const Level& level = levels[l];
+        if (level.pinned) {
+            continue;
+        }
+        size_t count = (size_t)level.pagesX * level.pagesY;
+        for (size_t i = 0; i < count; ++i) {
+            const Page& page = level.pages[i];
+            uint32_t touched = page.touchedFrame.load(std::memory_order_relaxed);
+            if (touched == frame) {
+                ++requested;
+            }
+            if (!page.texels) {
+                if (touched == frame) {
+                    missing.push_back({l, i, touched});
+                }
+            } else if (touched != frame) {
+                evictable.push_back({l, i, touched});
+            }
+        }
+    }
+
+    //* 2. 粗级别优先：缺页时先退回它们，且一页覆盖的屏幕面积更大
+    std::stable_sort(missing.begin(), missing.end(), [](const PageRef& a, const PageRef& b) { return a.level > b.level; });
+    size_t uploads = std::min(missing.size(), (size_t)std::max(maxUploads, 0));
+
+    //* 3. 超出上限时从最久未使用的页开始淘汰，本帧用到的页不动，腾不出位置就少载入一些
+    size_t evicted = 0;
+    if (residentPages + uploads > maxResidentPages) {
+        std::sort(evictable.begin(), evictable.end(), [](const PageRef& a, const PageRef& b) { return a.touched < b.touched; });
+        size_t overflow = residentPages + uploads - maxResidentPages;
+        evicted = std::min(overflow, evictable.size());
+        for (size_t i = 0; i < evicted; ++i) {
+            const Level& level = levels[evictable[i].level];
+            Page& page = level.pages[evictable[i].index];
+            int x0 = (int)(evictable[i].index % level.pagesX) << PAGE_SHIFT;
+            int y0 = (int)(evictable[i].index / level.pagesX) << PAGE_SHIFT;
+            residentBytes -= (size_t)(level.PageWidth(x0) + 1) * (level.PageHeight(y0) + 1) * sizeof(Texel);
+            page.texels.reset();
+        }
+        residentPages -= evicted;
+        uploads = std::min(uploads, maxResidentPages > residentPages ? maxResidentPages - residentPages : 0);
+    }
+
+    //* 4. 并行解码缺失的页，每页写入各自的缓冲区
+    std::vector<std::unique_ptr<Texel[]>> loaded(uploads);
+    std::vector<size_t> loadedBytes(uploads);
+    const int count = (int)uploads;
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int i = 0; i < count; ++i) {
+        const Level& level = levels[missing[i].level];
+        int x0 = (int)(missing[i].index % level.pagesX) << PAGE_SHIFT;
+        int y0 = (int)(missing[i].index / level.pagesX) << PAGE_SHIFT;
+        int w = level.PageWidth(x0) + 1, h = level.PageHeight(y0) + 1;
+        loaded[i] = std::make_unique<Texel[]>((size_t)w * h);
+        load(missing[i].level, x0, y0, w, h, loaded[i].get());
+        loadedBytes[i] = (size_t)w * h * sizeof(Texel);
+    }
+    for (size_t i = 0; i < uploads; ++i) {
+        levels[missing[i].level].pages[missing[i].index].texels = std::move(loaded[i]);
+        residentBytes += loadedBytes[i];
+    }
+    residentPages += uploads;
+
+    stats.residentPages = residentPages;
+    stats.residentBytes = residentBytes;
+    stats.requestedPages = requested;
+    stats.missingPages = missing.size() - uploads;
+    stats.loadedPages = uploads;
+    stats.evictedPages = evicted;
+
+    ++frame;
+}
+
+size_t VirtualTexture::GetMemoryBytes() const {
+    size_t bytes = residentBytes;
+    for (const auto& level : levels) {
+        bytes += (size_t)level.pagesX * level.pagesY * sizeof(Page);
+    }
+    return bytes;
+}
+
+Vector4f VirtualTexture::BilinearRaw(float u, float v, int levelIndex) const {
+    for (int l = levelIndex; l < (int)levels.size(); ++l) {
+        const Level& level = levels[l];
+        // 与 TextureSampler::BilinearRaw 相同的纹素中心约定，x0 落在 [-1, width-1]，循环到 [0, width-1]
+        float fx = u * level.width - 0.5f;
+        float fy = v * level.height - 0.5f;
+        int x0 = (int)std::floor(fx), y0 = (int)std::floor(fy);
+        float tx = fx - x0, ty = fy - y0;
+        x0 = x0 < 0 ? x0 + level.width : std::min(x0, level.width - 1);
+        y0 = y0 < 0 ? y0 + level.height : std::min(y0, level.height - 1);
+
+        const Page& page = level.PageAt(x0, y0);
+        Touch(page); //? 退回路径上经过的每一级都记入反馈，缺页按从粗到细的顺序逐级补齐
+        if (!page.texels) {
+            continue;
+        }
+
+        int stride = level.PageWidth(x0) + 1;
+        const Texel* t = page.texels.get() + (size_t)(y0 & PAGE_MASK) * stride + (x0 & PAGE_MASK);
+        Vector4f top = ToVector(t[0]) * (1.0f - tx) + ToVector(t[1]) * tx;
+        Vector4f bottom = ToVector(t[stride]) * (1.0f - tx) + ToVector(t[stride + 1]) * tx;
+        return top * (1.0f - ty) + bottom * ty;
+    }
+    return Vector4f(255.0f, 255.0f, 255.0f, 255.0f); // 末尾级别常驻，不会走到这里
+}
+
+Vector3f VirtualTexture::Nearest(float u, float v) const {
+    for (const Level& level : levels) {
+        int x = std::clamp(int(u * level.width), 0, level.width - 1);
+        int y = std::clamp(int(v * level.height), 0, level.height - 1);
+        const Page& page = level.PageAt(x, y);
+        Touch(page);
+        if (!page.texels) {
+            continue;
+        }
+        int stride = level.PageWidth(x) + 1;
+        return ToVector(page.texels[(size_t)(y & PAGE_MASK) * stride + (x & PAGE_MASK)]).head<3>() * INV_255;
+    }
+    return Vector3f(1.0f, 1.0f, 1.0f);
+}
+
+Vector3f VirtualTexture::Bilinear(float u, float v, int level) const {
+    return BilinearRaw(u, v, level).head<3>() * INV_255;
+}
+
+Vector3f VirtualTexture::Trilinear(float u, float v, int fine, int coarse, float t) const {
+    Vector4f c = BilinearRaw(u, v, fine);
+    if (t > 0.0f) {
+        c = c * (1.0f - t) + BilinearRaw(u, v, coarse) * t;
+    }
+    return c.head<3>() * INV_255;
+}
@@ -0,0 +1,102 @@
+/// FileName: VirtualTexture.hpp
+/// Date: 2026/10/19
+/// Author: ChaomengOrion
+/// Description: 稀疏虚拟纹理：按页切分的页表、采样反馈与按需驻留
+
+#pragma once
+#include "TextureStorage.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// 虚拟纹理的驻留统计
+struct VirtualTextureStats {
+    size_t totalPages = 0;     // 可调入调出的页数（不含常驻的末尾级别）
+    size_t residentPages = 0;  // 当前驻留的页数
+    size_t residentBytes = 0;  // 驻留页（含常驻级别）占用的字节数
+    size_t requestedPages = 0; // 上一帧采样请求到的页数
+    size_t missingPages = 0;   // 上一帧请求但更新后仍未驻留的页数，这些位置继续退回更粗的级别
+    size_t loadedPages = 0;    // 上一次更新载入的页数
+    size_t evictedPages = 0;   // 上一次更新淘汰的页数
+};
+
+// 虚拟纹理：每个 mip 级别切成 PAGE_SIZE² 的页，只有被采样请求过的页才从后备存储解码成 RGBA8 驻留内存
+//? 采样时直接把用到的页记入反馈（页上的帧号），不需要单独的反馈渲染；
+//? 缺页时退回更粗的级别，只有一页的末尾级别创建时就载入并常驻，保证总能采到东西
+class VirtualTexture {
+public:
+    static constexpr int PAGE_SHIFT = 7; // 128x128 纹素一页
+    static constexpr int PAGE_SIZE = 1 << PAGE_SHIFT;
+    static constexpr int PAGE_MASK = PAGE_SIZE - 1;
+    // 一个完整页驻留时占用的字节数（含边框）
+    static constexpr size_t PAGE_BYTES = (size_t)(PAGE_SIZE + 1) * (PAGE_SIZE + 1) * sizeof(Texel);
+
+    // 从后备存储读出 level 级别中以 (x0, y0) 为左上角的 width x height 纹素，坐标按纹理尺寸循环，行主序写入 out
+    using PageLoader = std::function<void(int level, int x0, int y0, int width, int height, Texel* out)>;
+
+    // levelSizes 为各 mip 级别的宽高，第 0 级为原图
+    VirtualTexture(const std::vector<std::pair<int, int>>& levelSizes, const PageLoader& load);
+
+    // 一帧采样结束后调用：载入本帧请求但缺失的页（粗级别优先，最多 maxUploads 页），
+    // 驻留页数超过 maxResidentPages 时按最久未使用淘汰本帧没有用到的页
+    //? 不能与采样并发
+    void Update(size_t maxResidentPages, int maxUploads, const PageLoader& load);
+
+    const VirtualTextureStats& GetStats() const { return stats; }
+
+    // 驻留页与页表占用的字节数
+    size_t GetMemoryBytes() const;
+
+    // u,v 在 [0,1) 内（已循环，v 已翻转），与 TextureSampler 的约定一致
+    Vector3f Nearest(float u, float v) const;
+
+    Vector3f Bilinear(float u, float v, int level) const;
+
+    Vector3f Trilinear(float u, float v, int fine, int coarse, float t) const;
+
+private:
+    struct Page {
+        //? (宽+1) x (高+1) 个纹素：多出的右侧一列与下方一行是循环相邻的纹素，双线性的 2x2 邻域不会跨页
+        std::unique_ptr<Texel[]> texels; // 为空表示未驻留
+        mutable std::atomic<uint32_t> touchedFrame{0}; // 最近一次被采样用到的帧号（反馈）
+    };
+
+    struct Level {
+        int width = 0, height = 0, pagesX = 0, pagesY = 0;
+        bool pinned = false; // 只有一页的末尾级别，常驻
+        std::unique_ptr<Page[]> pages;
+
+        inline Page& PageAt(int x, int y) const {
+            return pages[(size_t)(y >> PAGE_SHIFT) * pagesX + (x >> PAGE_SHIFT)];
+        }
+
+        // 页内实际纹素宽度（最右一列页可能不满）
+        inline int PageWidth(int x) const {
+            return std::min(PAGE_SIZE, width - (x & ~PAGE_MASK));
+        }
+
+        inline int PageHeight(int y) const {
+            return std::min(PAGE_SIZE, height - (y & ~PAGE_MASK));
+        }
+    };
+
+    std::vector<Level> levels;
+    uint32_t frame = 1; // 当前帧号，采样时写入页的 touchedFrame
+    size_t residentPages = 0;
+    size_t residentBytes = 0;
+    VirtualTextureStats stats;
+
+    void LoadPage(int levelIndex, size_t pageIndex, const PageLoader& load);
+
+    inline void Touch(const Page& page) const {
+        // 先读后写，同一页被反复采样时不会在线程间来回争抢缓存行
+        if (page.touchedFrame.load(std::memory_order_relaxed) != frame) {
+            page.touchedFrame.store(frame, std::memory_order_relaxed);
+        }
+    }
+
+    // 从 level 开始向更粗的级别查找驻留页做双线性过滤，返回未归一化的结果
+    Vector4f BilinearRaw(float u, float v, int level) const;
+};
@@ -29,7 +29,8 @@ namespace aries::scene {
         std::cout << "[Scene] 清空场景中的所有模型和形状。" << std::endl;
         //pipeline->shapeListMutex.lock();
         models.clear();
-        pipeline->shapeList.clear(); // 清空管线中的形状列表
+        pipeline->shapeStore.Clear(); // 清空管线中的形状存储
+        pipeline->shapeBVH.Clear();
         //pipeline->shapeListMutex.unlock();
     }
 
@@ -58,15 +59,16 @@ namespace aries::scene {
             for (const auto& shape : model->shapes) {
                 auto newShape = std::make_shared<Shape>(); // 深拷贝形状
                 newShape->name = shape->name + "_copy"; // 修改新形状的名称
-                newShape->mesh = shape->mesh; // 直接引用原始网格数据
+                newShape->SetMesh(shape->GetMesh()); // 共享只读网格资源（含包围体与 LOD），不复制三角形
                 // TODO: 深拷贝材质
-                newShape->material = shape->material; // 直接引用原始材质
+                newShape->SetMaterial(shape->GetMaterial()); // 直接引用原始材质
                 newShape->model = newModel.get(); // 设置新模型的引用
                 newModel->shapes.push_back(newShape);
             }
-            newModel->position = model->position + Vector3f(1.f, 0.f, 0.f); // 避免与原模型重叠
-            newModel->rotation = model->rotation; // 复制旋转
-            newModel->scale = model->scale; // 复制缩放
+            newModel->SetParent(model->GetParent()); // 挂在同一个父模型下
+            newModel->SetPosition(model->GetPosition() + Vector3f(1.f, 0.f, 0.f)); // 避免与原模型重叠
+            newModel->SetRotation(model->GetRotation()); // 复制旋转
+            newModel->SetScale(model->GetScale()); // 复制缩放
             AddModel(newModel); // 添加到场景
             std::cout << "[Scene] 复制模型：" << name << " 为 " << newName << std::endl;
         } else {